@@ -1,6 +1,7 @@
 /*
   ESP32WebServer.cpp - Dead simple web-server.
-  Supports only one simultaneous client, knows how to handle GET and POST.
+  Serves up to HTTP_MAX_CLIENTS clients at the same time, knows how to handle
+  GET and POST. Nothing in here waits for the network.
 
   Copyright (c) 2014 Ivan Grokhotkov. All rights reserved.
 
@@ -22,6 +23,7 @@
 
 
 #include <Arduino.h>
+#include <lwip/sockets.h>
 #include <libb64/cencode.h>
 #include "WiFiServer.h"
 #include "WiFiClient.h"
@@ -40,38 +42,58 @@ const char * AUTHORIZATION_HEADER = "Authorization";
 
 ESP32WebServer::ESP32WebServer(IPAddress addr, int port)
 : _server(addr, port)
+, _pool(0)
+, _currentConn(0)
+, _currentStart(0)
 , _currentMethod(HTTP_ANY)
+, _currentUri("")
 , _currentVersion(0)
-, _currentStatus(HC_NONE)
-, _statusChange(0)
 , _currentHandler(0)
 , _firstHandler(0)
 , _lastHandler(0)
+, _pathArgCount(0)
 , _currentArgCount(0)
-, _currentArgs(0)
 , _headerKeysCount(0)
 , _currentHeaders(0)
 , _contentLength(0)
+, _hostHeader("")
 , _chunked(false)
 {
+  memset(&_routes, 0, sizeof(_routes));
+  for (int i = 0; i < HTTP_MAX_CLIENTS; i++) {
+    _conn[i].status = HC_NONE;
+    _conn[i].out = 0;
+    _conn[i].spare = 0;
+  }
+  memset(&_stats, 0, sizeof(_stats));
 }
 
 ESP32WebServer::ESP32WebServer(int port)
 : _server(port)
+, _pool(0)
+, _currentConn(0)
+, _currentStart(0)
 , _currentMethod(HTTP_ANY)
+, _currentUri("")
 , _currentVersion(0)
-, _currentStatus(HC_NONE)
-, _statusChange(0)
 , _currentHandler(0)
 , _firstHandler(0)
 , _lastHandler(0)
+, _pathArgCount(0)
 , _currentArgCount(0)
-, _currentArgs(0)
 , _headerKeysCount(0)
 , _currentHeaders(0)
 , _contentLength(0)
+, _hostHeader("")
 , _chunked(false)
 {
+  memset(&_routes, 0, sizeof(_routes));
+  for (int i = 0; i < HTTP_MAX_CLIENTS; i++) {
+    _conn[i].status = HC_NONE;
+    _conn[i].out = 0;
+    _conn[i].spare = 0;
+  }
+  memset(&_stats, 0, sizeof(_stats));
 }
 
 ESP32WebServer::~ESP32WebServer() {
@@ -84,11 +106,21 @@ ESP32WebServer::~ESP32WebServer() {
     delete handler;
     handler = next;
   }
+  _routeFree(_routes.child);
   close();
+  free(_pool);
 }
 
 void ESP32WebServer::begin() {
-  _currentStatus = HC_NONE;
+  // One allocation for all request buffers, done once so the heap does not
+  // fragment with every request
+  if (!_pool)
+    _pool = (char *) malloc(HTTP_MAX_CLIENTS * HTTP_CONN_BUFLEN);
+  for (int i = 0; i < HTTP_MAX_CLIENTS; i++) {
+    _closeConn(_conn[i]);
+    _conn[i].buf = _pool ? _pool + i * HTTP_CONN_BUFLEN : 0;
+  }
+  memset(&_stats, 0, sizeof(_stats));
   _server.begin();
   if(!_headerKeysCount)
     collectHeaders(0, 0);
@@ -141,7 +173,9 @@ void ESP32WebServer::on(const String &uri, HTTPMethod method, ESP32WebServer::TH
 }
 
 void ESP32WebServer::on(const String &uri, HTTPMethod method, ESP32WebServer::THandlerFunction fn, ESP32WebServer::THandlerFunction ufn) {
-  _addRequestHandler(new FunctionRequestHandler(fn, ufn, uri, method));
+  RequestHandler* handler = new FunctionRequestHandler(fn, ufn, method);
+  if (!_routeAdd(uri.c_str(), handler))
+    delete handler;
 }
 
 void ESP32WebServer::addHandler(RequestHandler* handler) {
@@ -163,71 +197,355 @@ void ESP32WebServer::serveStatic(const char* uri, FS& fs, const char* path, cons
     _addRequestHandler(new StaticRequestHandler(fs, path, uri, cache_header));
 }
 
+// Accept new connections, read what has arrived on the open ones, run the
+// handler of at most one complete request and send as much of the queued
+// responses as the sockets take without blocking.
 void ESP32WebServer::handleClient() {
-  if (_currentStatus == HC_NONE) {
+  if (!_pool)
+    return;
+  unsigned long start = micros();
+
+  _acceptClients();
+
+  bool handled = false;
+  for (int i = 0; i < HTTP_MAX_CLIENTS; i++) {
+    HTTPConn& conn = _conn[i];
+    if (conn.status == HC_NONE)
+      continue;
+    if (conn.status == HC_SEND) {
+      _sendConn(conn);
+      continue;
+    }
+    if (!_readConn(conn))
+      continue;
+    if (!handled) {
+      _dispatch(conn);
+      handled = true;
+    }
+  }
+
+  unsigned long us = micros() - start;
+  if (us > _stats.maxUs)
+    _stats.maxUs = us;
+}
+
+void ESP32WebServer::_acceptClients() {
+  for (int n = 0; n < HTTP_MAX_CLIENTS; n++) {
     WiFiClient client = _server.available();
-    if (!client) {
+    if (!client)
       return;
+
+    int i;
+    for (i = 0; i < HTTP_MAX_CLIENTS; i++) {
+      if (_conn[i].status == HC_NONE)
+        break;
+    }
+    if (i == HTTP_MAX_CLIENTS) {
+      _stats.rejected++;
+      _reject(client, 503);
+      continue;
     }
 
 #ifdef DEBUG_ESP_HTTP_SERVER
-    log_e("New client");
+    DEBUG_OUTPUT.print("New client, slot ");
+    DEBUG_OUTPUT.println(i);
 #endif
-
-    _currentClient = client;
-    _currentStatus = HC_WAIT_READ;
-    _statusChange = millis();
+    HTTPConn& conn = _conn[i];
+    conn.client = client;
+    conn.status = HC_WAIT_READ;
+    conn.since = millis();
+    conn.len = 0;
+    conn.head = 0;
+    conn.body = 0;
+    conn.outLen = 0;
+    conn.failed = false;
+    _stats.accepted++;
   }
+}
 
-  if (!_currentClient.connected()) {
-    _currentClient = WiFiClient();
-    _currentStatus = HC_NONE;
-    return;
+// Move the bytes that arrived into the connection buffer and advance the
+// state. Returns true once the request (headers and body) is complete.
+bool ESP32WebServer::_readConn(HTTPConn& conn) {
+  size_t avail = conn.client.available();
+  if (avail) {
+    size_t space = HTTP_CONN_BUFLEN - 1 - conn.len;   // keep room for the terminator
+    if (avail > space)
+      avail = space;
+    int got = conn.client.read((uint8_t *)conn.buf + conn.len, avail);
+    if (got > 0)
+      conn.len += got;
   }
-
-  // Wait for data from client to become available
-  if (_currentStatus == HC_WAIT_READ) {
-    if (!_currentClient.available()) {
-      if (millis() - _statusChange > HTTP_MAX_DATA_WAIT) {
-        _currentClient = WiFiClient();
-        _currentStatus = HC_NONE;
+  else if (!conn.client.connected()) {
+    _closeConn(conn);
+    return false;
+  }
+  conn.buf[conn.len] = '\0';
+
+  if (conn.status == HC_WAIT_READ) {
+    char *end = strstr(conn.buf, "\r\n\r\n");
+    if (!end) {
+      if (conn.len >= HTTP_CONN_BUFLEN - 1) {
+        _stats.errors++;
+        _reject(conn.client, 413);
+        _closeConn(conn);
       }
-      yield();
-      return;
+      else if (millis() - conn.since > HTTP_MAX_DATA_WAIT) {
+        _stats.timeouts++;
+        _closeConn(conn);
+      }
+      return false;
     }
-
-    if (!_parseRequest(_currentClient)) {
-      _currentClient = WiFiClient();
-      _currentStatus = HC_NONE;
-      return;
+    conn.head = end + 4 - conn.buf;
+
+    // Only the body length is needed here, the rest is parsed on dispatch
+    conn.body = 0;
+    for (char *line = strstr(conn.buf, "\r\n"); line && line < end; line = strstr(line + 2, "\r\n")) {
+      if (strncasecmp(line + 2, "Content-Length:", 15) == 0) {
+        conn.body = strtoul(line + 17, NULL, 10);
+        break;
+      }
     }
-    _currentClient.setTimeout(HTTP_MAX_SEND_WAIT);
-    _contentLength = CONTENT_LENGTH_NOT_SET;
+    if (conn.head + conn.body > HTTP_CONN_BUFLEN - 1) {
+      _stats.errors++;
+      _reject(conn.client, 413);
+      _closeConn(conn);
+      return false;
+    }
+    conn.status = HC_WAIT_BODY;
+  }
+
+  if (conn.len >= conn.head + conn.body)
+    return true;
+  if (millis() - conn.since > HTTP_MAX_DATA_WAIT + HTTP_MAX_POST_WAIT) {
+    _stats.timeouts++;
+    _closeConn(conn);
+  }
+  return false;
+}
+
+// Run the handler. Everything it sends goes to the queue of the connection,
+// which _sendConn() empties in the following handleClient() calls. When the
+// queue is full the handler waits in _write() until the socket took more, so
+// a large page never sits in RAM as a whole.
+void ESP32WebServer::_dispatch(HTTPConn& conn) {
+  _currentConn = &conn;
+  _currentStart = millis();
+  conn.since = _currentStart;
+  _currentClient = conn.client;
+  _contentLength = CONTENT_LENGTH_NOT_SET;
+  if (_parseRequest(conn)) {
     _handleRequest();
+    _stats.served++;
+  }
+  else {
+    _stats.errors++;
+    _reject(_currentClient, 400);
+  }
+  _currentClient = WiFiClient();
+  _currentConn = 0;
 
-    if (!_currentClient.connected()) {
-      _currentClient = WiFiClient();
-      _currentStatus = HC_NONE;
-      return;
-    } else {
-      _currentStatus = HC_WAIT_CLOSE;
-      _statusChange = millis();
-      return;
+  if (conn.failed) {
+    _closeConn(conn);
+  }
+  else if (conn.out) {
+    conn.status = HC_SEND;
+    conn.since = millis();
+    _sendConn(conn);
+  }
+  else {
+    _closeConn(conn);
+  }
+}
+
+// Hand the queued response to the socket as far as it takes it without
+// blocking. The connection is closed once everything is sent, or when the
+// client is gone.
+void ESP32WebServer::_sendConn(HTTPConn& conn) {
+  if (!_sendOut(conn) || !conn.out)
+    _closeConn(conn);
+}
+
+// Send what the socket takes without blocking. Returns false when the
+// client is gone or did not take anything for HTTP_MAX_SEND_WAIT ms.
+bool ESP32WebServer::_sendOut(HTTPConn& conn) {
+  while (conn.out) {
+    HTTPOut* seg = conn.out;
+    if (seg->len) {
+      int sent = lwip_send(conn.client.fd(), seg->data, seg->len, MSG_DONTWAIT);
+      if (sent < 0) {
+        if ((errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+          _stats.errors++;
+          return false;
+        }
+        break;
+      }
+      if (sent == 0)
+        break;
+      seg->data += sent;
+      seg->len -= sent;
+      if (seg->cap)
+        conn.outLen -= sent;
+      conn.since = millis();
+      if (seg->len)
+        break;
     }
+    conn.out = seg->next;
+    if (seg->cap && !conn.spare)
+      conn.spare = seg;
+    else
+      free(seg);
+  }
+  if (!conn.out)
+    conn.outTail = 0;
+  else if (millis() - conn.since > HTTP_MAX_SEND_WAIT) {
+    _stats.timeouts++;
+    return false;
   }
+  return true;
+}
+
+// Pause the handler until the socket took enough of the queue to make room
+// for more. The idle handler keeps the rest of the program going meanwhile,
+// other connections wait. Returns false when the client is gone or the
+// handler waited HTTP_MAX_PAGE_WAIT ms in total, the rest of the response is
+// then dropped and the connection closed.
+bool ESP32WebServer::_waitOut(HTTPConn& conn) {
+  _stats.waits++;
+  conn.since = millis();
+  while (conn.outLen >= HTTP_MAX_OUT) {
+    if (!_sendOut(conn)) {
+      conn.failed = true;
+      return false;
+    }
+    if (millis() - _currentStart > HTTP_MAX_PAGE_WAIT) {
+      _stats.timeouts++;
+      conn.failed = true;
+      return false;
+    }
+    if (conn.outLen < HTTP_MAX_OUT)
+      break;
+    if (_idleHandler)
+      _idleHandler();
+    delay(1);
+  }
+  return true;
+}
 
-  if (_currentStatus == HC_WAIT_CLOSE) {
-    if (millis() - _statusChange > HTTP_MAX_CLOSE_WAIT) {
-      _currentClient = WiFiClient();
-      _currentStatus = HC_NONE;
-    } else {
-      yield();
+// Append a copy of data to the response queue of the current connection.
+// At most HTTP_MAX_OUT bytes are queued, the rest waits for the socket.
+void ESP32WebServer::_write(const char* data, size_t len) {
+  HTTPConn* conn = _currentConn;
+  if (!conn || conn->failed)
+    return;
+
+  HTTPOut* seg = conn->outTail;
+  while (len) {
+    if ((conn->outLen >= HTTP_MAX_OUT) && !_waitOut(*conn))
       return;
+    seg = conn->outTail;
+    size_t room = 0;
+    if (seg && seg->cap)
+      room = seg->cap - (seg->data - (const char *)(seg + 1)) - seg->len;
+    if (!room) {
+      if (conn->spare) {
+        seg = conn->spare;
+        conn->spare = 0;
+      }
+      else if (psramFound())
+        seg = (HTTPOut *) ps_malloc(sizeof(HTTPOut) + HTTP_OUT_SEGLEN);
+      else
+        seg = (HTTPOut *) malloc(sizeof(HTTPOut) + HTTP_OUT_SEGLEN);
+      if (!seg) {
+        _stats.errors++;
+        conn->failed = true;
+        return;
+      }
+      seg->next = 0;
+      seg->data = (const char *)(seg + 1);
+      seg->len = 0;
+      seg->cap = HTTP_OUT_SEGLEN;
+      if (conn->out)
+        conn->outTail->next = seg;
+      else
+        conn->out = seg;
+      conn->outTail = seg;
+      room = HTTP_OUT_SEGLEN;
     }
+    size_t n = len < room ? len : room;
+    if (n > HTTP_MAX_OUT - conn->outLen)
+      n = HTTP_MAX_OUT - conn->outLen;
+    memcpy((char *)seg->data + seg->len, data, n);
+    seg->len += n;
+    conn->outLen += n;
+    if (conn->outLen > _stats.outMax)
+      _stats.outMax = conn->outLen;
+    data += n;
+    len -= n;
+  }
+}
+
+// Queue data that stays valid until it is sent (in flash) without a copy
+void ESP32WebServer::_writeRef(const char* data, size_t len) {
+  HTTPConn* conn = _currentConn;
+  if (!conn || conn->failed || !len)
+    return;
+  HTTPOut* seg = (HTTPOut *) malloc(sizeof(HTTPOut));
+  if (!seg) {
+    _stats.errors++;
+    conn->failed = true;
+    return;
   }
+  seg->next = 0;
+  seg->data = data;
+  seg->len = len;
+  seg->cap = 0;
+  if (conn->out)
+    conn->outTail->next = seg;
+  else
+    conn->out = seg;
+  conn->outTail = seg;
+}
+
+// Drop our reference to the connection. The socket is closed when no one
+// else holds it, a handler may keep a copy of client() to stream to it.
+void ESP32WebServer::_closeConn(HTTPConn& conn) {
+  while (conn.out) {
+    HTTPOut* next = conn.out->next;
+    free(conn.out);
+    conn.out = next;
+  }
+  free(conn.spare);
+  conn.spare = 0;
+  conn.outTail = 0;
+  conn.outLen = 0;
+  conn.failed = false;
+  conn.client = WiFiClient();
+  conn.status = HC_NONE;
+  conn.len = 0;
+  conn.head = 0;
+}
+
+// Best effort, the connection is closed right after anyway
+void ESP32WebServer::_reject(WiFiClient& client, int code) {
+  String response = "HTTP/1.1 " + String(code) + " " + _responseCodeToString(code) +
+                    "\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+  lwip_send(client.fd(), response.c_str(), response.length(), MSG_DONTWAIT);
+}
+
+int ESP32WebServer::activeClients() {
+  int n = 0;
+  for (int i = 0; i < HTTP_MAX_CLIENTS; i++) {
+    if (_conn[i].status != HC_NONE)
+      n++;
+  }
+  return n;
 }
 
 void ESP32WebServer::close() {
+  for (int i = 0; i < HTTP_MAX_CLIENTS; i++) {
+    if (_conn[i].status != HC_NONE)
+      _closeConn(_conn[i]);
+  }
   _server.end();
 }
 
@@ -287,7 +605,7 @@ void ESP32WebServer::send(int code, const char* content_type, const String& cont
     //if(code == 200 && content.length() == 0 && _contentLength == CONTENT_LENGTH_NOT_SET)
     //  _contentLength = CONTENT_LENGTH_UNKNOWN;
     _prepareHeader(header, code, content_type, content.length());
-    _currentClient.write(header.c_str(), header.length());
+    _write(header.c_str(), header.length());
     if(content.length())
       sendContent(content);
 }
@@ -303,7 +621,7 @@ void ESP32WebServer::send_P(int code, PGM_P content_type, PGM_P content) {
     char type[64];
     memccpy_P((void*)type, (PGM_VOID_P)content_type, 0, sizeof(type));
     _prepareHeader(header, code, (const char* )type, contentLength);
-    _currentClient.write(header.c_str(), header.length());
+    _write(header.c_str(), header.length());
     sendContent_P(content);
 }
 
@@ -312,8 +630,9 @@ void ESP32WebServer::send_P(int code, PGM_P content_type, PGM_P content, size_t
     char type[64];
     memccpy_P((void*)type, (PGM_VOID_P)content_type, 0, sizeof(type));
     _prepareHeader(header, code, (const char* )type, contentLength);
-    sendContent(header);
-    sendContent_P(content, contentLength);
+    _write(header.c_str(), header.length());
+    // The content is in flash and stays there, it is sent without a copy
+    _writeRef(content, contentLength);
 }
 
 void ESP32WebServer::send(int code, char* content_type, const String& content) {
@@ -328,16 +647,13 @@ void ESP32WebServer::sendContent(const String& content) {
   const char * footer = "\r\n";
   size_t len = content.length();
   if(_chunked) {
-    char * chunkSize = (char *)malloc(11);
-    if(chunkSize){
-      sprintf(chunkSize, "%x%s", len, footer);
-      _currentClient.write(chunkSize, strlen(chunkSize));
-      free(chunkSize);
-    }
+    char chunkSize[11];
+    sprintf(chunkSize, "%x%s", len, footer);
+    _write(chunkSize, strlen(chunkSize));
   }
-  _currentClient.write(content.c_str(), len);
+  _write(content.c_str(), len);
   if(_chunked){
-    _currentClient.write(footer, 2);
+    _write(footer, 2);
   }
 }
 
@@ -348,50 +664,48 @@ void ESP32WebServer::sendContent_P(PGM_P content) {
 void ESP32WebServer::sendContent_P(PGM_P content, size_t size) {
   const char * footer = "\r\n";
   if(_chunked) {
-    char * chunkSize = (char *)malloc(11);
-    if(chunkSize){
-      sprintf(chunkSize, "%x%s", size, footer);
-      _currentClient.write(chunkSize, strlen(chunkSize));
-      free(chunkSize);
-    }
-  }
-  size_t chunkSize = 20;
-  int idx = 0;
-  while(size != 0){
-      if(size < chunkSize){
-        _currentClient.write(&content[idx], size);
-        size = 0;
-      } else {
-        _currentClient.write(&content[idx], chunkSize);
-        size -= chunkSize;
-        idx += chunkSize;
-      }
-    yield();
+    char chunkSize[11];
+    sprintf(chunkSize, "%x%s", size, footer);
+    _write(chunkSize, strlen(chunkSize));
   }
+  // Flash is memory mapped on the ESP32, so copy the content in one go
+  _write(content, size);
   if(_chunked){
-    _currentClient.write(footer, 2);
+    _write(footer, 2);
   }
 }
 
 
 String ESP32WebServer::arg(String name) {
+  return String(argView(name.c_str()));
+}
+
+String ESP32WebServer::arg(int i) {
+  return String(argView(i));
+}
+
+String ESP32WebServer::argName(int i) {
+  return String(argNameView(i));
+}
+
+const char* ESP32WebServer::argView(const char* name) {
   for (int i = 0; i < _currentArgCount; ++i) {
-    if ( _currentArgs[i].key == name )
+    if (strcmp(_currentArgs[i].key, name) == 0)
       return _currentArgs[i].value;
   }
-  return String();
+  return "";
 }
 
-String ESP32WebServer::arg(int i) {
-  if (i < _currentArgCount)
+const char* ESP32WebServer::argView(int i) {
+  if (i >= 0 && i < _currentArgCount)
     return _currentArgs[i].value;
-  return String();
+  return "";
 }
 
-String ESP32WebServer::argName(int i) {
-  if (i < _currentArgCount)
+const char* ESP32WebServer::argNameView(int i) {
+  if (i >= 0 && i < _currentArgCount)
     return _currentArgs[i].key;
-  return String();
+  return "";
 }
 
 int ESP32WebServer::args() {
@@ -400,7 +714,7 @@ int ESP32WebServer::args() {
 
 bool ESP32WebServer::hasArg(String  name) {
   for (int i = 0; i < _currentArgCount; ++i) {
-    if (_currentArgs[i].key == name)
+    if (strcmp(_currentArgs[i].key, name.c_str()) == 0)
       return true;
   }
   return false;
@@ -408,33 +722,40 @@ bool ESP32WebServer::hasArg(String  name) {
 
 
 String ESP32WebServer::header(String name) {
+  return String(headerView(name.c_str()));
+}
+
+const char* ESP32WebServer::headerView(const char* name) {
   for (int i = 0; i < _headerKeysCount; ++i) {
-    if (_currentHeaders[i].key.equalsIgnoreCase(name))
+    if (strcasecmp(_currentHeaders[i].key, name) == 0)
       return _currentHeaders[i].value;
   }
-  return String();
+  return "";
 }
 
+// The keys are not copied, they must stay valid (string literals)
 void ESP32WebServer::collectHeaders(const char* headerKeys[], const size_t headerKeysCount) {
   _headerKeysCount = headerKeysCount + 1;
   if (_currentHeaders)
      delete[]_currentHeaders;
   _currentHeaders = new RequestArgument[_headerKeysCount];
   _currentHeaders[0].key = AUTHORIZATION_HEADER;
+  _currentHeaders[0].value = "";
   for (int i = 1; i < _headerKeysCount; i++){
     _currentHeaders[i].key = headerKeys[i-1];
+    _currentHeaders[i].value = "";
   }
 }
 
 String ESP32WebServer::header(int i) {
   if (i < _headerKeysCount)
-    return _currentHeaders[i].value;
+    return String(_currentHeaders[i].value);
   return String();
 }
 
 String ESP32WebServer::headerName(int i) {
   if (i < _headerKeysCount)
-    return _currentHeaders[i].key;
+    return String(_currentHeaders[i].key);
   return String();
 }
 
@@ -443,21 +764,43 @@ int ESP32WebServer::headers() {
 }
 
 bool ESP32WebServer::hasHeader(String name) {
-  for (int i = 0; i < _headerKeysCount; ++i) {
-    if ((_currentHeaders[i].key.equalsIgnoreCase(name)) &&  (_currentHeaders[i].value.length() > 0))
-      return true;
-  }
-  return false;
+  return headerView(name.c_str())[0] != '\0';
 }
 
 String ESP32WebServer::hostHeader() {
-  return _hostHeader;
+  return String(_hostHeader);
+}
+
+String ESP32WebServer::pathArg(int i) {
+  if (i < 0 || i >= _pathArgCount)
+    return String();
+  String value;
+  value.reserve(_pathArgs[i].len);
+  for (int j = 0; j < _pathArgs[i].len; j++)
+    value += _pathArgs[i].value[j];
+  return value;
+}
+
+long ESP32WebServer::pathArgInt(int i) {
+  if (i < 0 || i >= _pathArgCount)
+    return 0;
+  return strtol(_pathArgs[i].value, NULL, 10);  // stops at the character after the parameter
+}
+
+int ESP32WebServer::pathArgIndex(int i) {
+  if (i < 0 || i >= _pathArgCount)
+    return -1;
+  return _pathArgs[i].index;
 }
 
 void ESP32WebServer::onFileUpload(THandlerFunction fn) {
   _fileUploadHandler = fn;
 }
 
+void ESP32WebServer::onIdle(THandlerFunction fn) {
+  _idleHandler = fn;
+}
+
 void ESP32WebServer::onNotFound(THandlerFunction fn) {
   _notFoundHandler = fn;
 }
@@ -487,7 +830,9 @@ void ESP32WebServer::_handleRequest() {
     }
   }
 
-  _currentUri = String();
+  _currentUri = "";
+  _currentArgCount = 0;
+  _pathArgCount = 0;
 }
 
 String ESP32WebServer::_responseCodeToString(int code) {
@@ -1,6 +1,16 @@
 /*
   ESP32WebServer.h - Dead simple web-server.
-  Supports only one simultaneous client, knows how to handle GET and POST.
+  Serves up to HTTP_MAX_CLIENTS clients at the same time, knows how to handle
+  GET and POST. Requests are collected without blocking in a buffer per
+  connection and only handed to the handler when they are complete. The
+  response is queued per connection and sent by later handleClient() calls
+  as fast as the client takes it, so a slow client never stalls the caller
+  of handleClient().
+  The request is tokenized in place: uri, arguments and headers are views
+  into the connection buffer, nothing is allocated while parsing.
+  Routes registered with on() live in a prefix tree and may contain typed
+  parameters, e.g. "/SF={-1|1}", "/node/{int}" or "/file/{str}", which the
+  handler reads with pathArg(), pathArgInt() or pathArgIndex().
 
   Copyright (c) 2014 Ivan Grokhotkov. All rights reserved.
 
@@ -30,14 +40,20 @@
 enum HTTPMethod { HTTP_ANY, HTTP_GET, HTTP_POST, HTTP_PUT, HTTP_PATCH, HTTP_DELETE, HTTP_OPTIONS };
 enum HTTPUploadStatus { UPLOAD_FILE_START, UPLOAD_FILE_WRITE, UPLOAD_FILE_END,
                         UPLOAD_FILE_ABORTED };
-enum HTTPClientStatus { HC_NONE, HC_WAIT_READ, HC_WAIT_CLOSE };
+enum HTTPClientStatus { HC_NONE, HC_WAIT_READ, HC_WAIT_BODY, HC_SEND };
 
 #define HTTP_DOWNLOAD_UNIT_SIZE 1460
 #define HTTP_UPLOAD_BUFLEN 2048
 #define HTTP_MAX_DATA_WAIT 1000 //ms to wait for the client to send the request
 #define HTTP_MAX_POST_WAIT 1000 //ms to wait for POST data to arrive
-#define HTTP_MAX_SEND_WAIT 5000 //ms to wait for data chunk to be ACKed
-#define HTTP_MAX_CLOSE_WAIT 2000 //ms to wait for the client to close the connection
+#define HTTP_MAX_SEND_WAIT 5000 //ms without progress before a response is dropped
+#define HTTP_MAX_PAGE_WAIT 5000 //ms a handler may wait in total for a slow client
+#define HTTP_MAX_CLIENTS 4 //connections served at the same time
+#define HTTP_CONN_BUFLEN 1536 //request buffer per connection, request line + headers + body
+#define HTTP_MAX_ARGS 16 //query and form arguments kept per request
+#define HTTP_MAX_PATH_ARGS 4 //typed parameters in one route
+#define HTTP_OUT_SEGLEN 2048 //response queue grows in segments of this size
+#define HTTP_MAX_OUT 4096 //response bytes queued in RAM per connection, more waits for the socket
 
 #define CONTENT_LENGTH_UNKNOWN ((size_t) -1)
 #define CONTENT_LENGTH_NOT_SET ((size_t) -2)
@@ -54,6 +70,65 @@ typedef struct {
   uint8_t buf[HTTP_UPLOAD_BUFLEN];
 } HTTPUpload;
 
+// Part of a queued response. data points into the segment itself or, for
+// content passed to send_P() with a length, to the content in flash.
+typedef struct HTTPOut {
+  struct HTTPOut* next;
+  const char* data;     // next byte to send
+  size_t len;           // bytes left to send
+  size_t cap;           // room after the header, 0 for content in flash
+} HTTPOut;
+
+// One connection of the pool. buf is a slice of the server's buffer pool.
+typedef struct {
+  WiFiClient client;
+  HTTPClientStatus status;
+  unsigned long since;  // millis() when the connection was accepted
+  char* buf;
+  uint16_t len;         // bytes in buf
+  uint16_t head;        // size of request line + headers, 0 while incomplete
+  uint32_t body;        // Content-Length of the request
+  HTTPOut* out;         // queued response, oldest first
+  HTTPOut* outTail;
+  HTTPOut* spare;       // sent segment kept for reuse
+  uint32_t outLen;      // response bytes queued in RAM
+  bool failed;          // client gone or no memory, the rest of the response is dropped
+} HTTPConn;
+
+typedef struct {
+  uint32_t accepted;    // connections accepted
+  uint32_t served;      // requests handed to a handler
+  uint32_t rejected;    // refused because the pool was full
+  uint32_t timeouts;    // request not complete in time
+  uint32_t errors;      // malformed or too large requests
+  uint32_t maxUs;       // longest handleClient() call
+  uint32_t parseUs;     // parse + route of the last request
+  uint32_t outMax;      // most response bytes queued in RAM at once
+  uint32_t waits;       // handler paused until the socket took more
+} HTTPStats;
+
+// Node of the route tree. The edge to a node is either literal text or a
+// typed parameter: {int}, {str} or an enumeration like {SCAN|CAD|RX}.
+enum HTTPUriType { URI_LITERAL, URI_ENUM, URI_INT, URI_STR };
+
+class RequestHandler;
+
+typedef struct UriNode {
+  char* label;          // literal text or the parameter spec without braces
+  uint8_t len;
+  uint8_t type;         // HTTPUriType
+  struct UriNode* child;
+  struct UriNode* sibling;
+  RequestHandler* handler;  // routes ending here, chained with nextRoute()
+} UriNode;
+
+// A typed parameter matched in the uri, a view into the request buffer
+typedef struct {
+  const char* value;
+  uint8_t len;
+  uint8_t index;        // which alternative of an enumeration matched
+} HTTPPathArg;
+
 #include "detail/RequestHandler.h"
 
 namespace fs {
@@ -84,19 +159,27 @@ public:
   void serveStatic(const char* uri, fs::FS& fs, const char* path, const char* cache_header = NULL );
   void onNotFound(THandlerFunction fn);  //called when handler is not assigned
   void onFileUpload(THandlerFunction fn); //handle file uploads
+  void onIdle(THandlerFunction fn);  //called while a handler waits for a slow client, must not call handleClient()
 
-  String uri() { return _currentUri; }
+  String uri() { return String(_currentUri); }
+  const char* uriView() { return _currentUri; }
   HTTPMethod method() { return _currentMethod; }
   WiFiClient client() { return _currentClient; }
   HTTPUpload& upload() { return _currentUpload; }
+  const HTTPStats& stats() { return _stats; }
+  int activeClients();            // connections in the pool
 
   String arg(String name);        // get request argument value by name
   String arg(int i);              // get request argument value by number
   String argName(int i);          // get request argument name by number
+  const char* argView(int i);     // same without a copy, valid until the handler returns
+  const char* argNameView(int i);
+  const char* argView(const char* name);
   int args();                     // get arguments count
   bool hasArg(String name);       // check if argument exists
   void collectHeaders(const char* headerKeys[], const size_t headerKeysCount); // set the request headers to collect
   String header(String name);      // get request header value by name
+  const char* headerView(const char* name); // "" when the header was not sent
   String header(int i);              // get request header value by number
   String headerName(int i);          // get request header name by number
   int headers();                     // get header count
@@ -104,6 +187,11 @@ public:
 
   String hostHeader();            // get request host header if available or empty String if not
 
+  String pathArg(int i);          // typed parameter i of the matched route
+  long pathArgInt(int i);         // the same converted to a number
+  int pathArgIndex(int i);        // alternative of an enumeration that matched
+  int pathArgs() { return _pathArgCount; }
+
   // send response to the client
   // code - HTTP response code, can be 200 or 404
   // content_type - HTTP content type, like "text/plain" or "image/png"
@@ -134,7 +222,7 @@ template<typename T> size_t streamFile(T &file, const String& contentType){
   size_t fsize = 0;
   while(file.available()){
       int got = file.read(buf, 20);
-      _currentClient.write(buf, got);
+      _write((const char *)buf, got);
       fsize += got;
       yield();
   }
@@ -144,38 +232,57 @@ template<typename T> size_t streamFile(T &file, const String& contentType){
 protected:
   void _addRequestHandler(RequestHandler* handler);
   void _handleRequest();
-  bool _parseRequest(WiFiClient& client);
-  void _parseArguments(String data);
+  bool _parseRequest(HTTPConn& conn);
+  void _parseArguments(char* data);
+  static char* _urlDecode(char* text);
+  bool _routeAdd(const char* pattern, RequestHandler* handler);
+  UriNode* _routeChild(UriNode* node, const char* label, uint8_t len, uint8_t type);
+  RequestHandler* _routeMatch(UriNode* node, const char* uri);
+  void _routeFree(UriNode* node);
   static String _responseCodeToString(int code);
-  bool _parseForm(WiFiClient& client, String boundary, uint32_t len);
-  bool _parseFormUploadAborted();
-  void _uploadWriteByte(uint8_t b);
-  uint8_t _uploadReadByte(WiFiClient& client);
+  void _acceptClients();
+  bool _readConn(HTTPConn& conn);
+  void _dispatch(HTTPConn& conn);
+  void _sendConn(HTTPConn& conn);
+  bool _sendOut(HTTPConn& conn);
+  bool _waitOut(HTTPConn& conn);
+  void _write(const char* data, size_t len);
+  void _writeRef(const char* data, size_t len);
+  void _closeConn(HTTPConn& conn);
+  void _reject(WiFiClient& client, int code);
   void _prepareHeader(String& response, int code, const char* content_type, size_t contentLength);
   bool _collectHeader(const char* headerName, const char* headerValue);
 
   struct RequestArgument {
-    String key;
-    String value;
+    const char* key;
+    const char* value;
   };
 
   WiFiServer  _server;
 
+  HTTPConn    _conn[HTTP_MAX_CLIENTS];
+  char*       _pool;
+  HTTPStats   _stats;
+
   WiFiClient  _currentClient;
+  HTTPConn*   _currentConn;
+  unsigned long _currentStart;  // millis() when the handler was called
   HTTPMethod  _currentMethod;
-  String      _currentUri;
+  const char* _currentUri;
   uint8_t     _currentVersion;
-  HTTPClientStatus _currentStatus;
-  unsigned long _statusChange;
 
   RequestHandler*  _currentHandler;
   RequestHandler*  _firstHandler;
   RequestHandler*  _lastHandler;
+  UriNode          _routes;
+  HTTPPathArg      _pathArgs[HTTP_MAX_PATH_ARGS];
+  int              _pathArgCount;
   THandlerFunction _notFoundHandler;
   THandlerFunction _fileUploadHandler;
+  THandlerFunction _idleHandler;
 
   int              _currentArgCount;
-  RequestArgument* _currentArgs;
+  RequestArgument  _currentArgs[HTTP_MAX_ARGS];
   HTTPUpload       _currentUpload;
 
   int              _headerKeysCount;
@@ -183,7 +290,7 @@ protected:
   size_t           _contentLength;
   String           _responseHeaders;
 
-  String           _hostHeader;
+  const char*      _hostHeader;
   bool             _chunked;
 
 };
@@ -31,82 +31,64 @@
 #define DEBUG_OUTPUT Serial
 #endif
 
-static char* readBytesWithTimeout(WiFiClient& client, size_t maxLength, size_t& dataLength, int timeout_ms)
-{
-  char *buf = nullptr;
-  dataLength = 0;
-  while (dataLength < maxLength) {
-    int tries = timeout_ms;
-    size_t newLength;
-    while (!(newLength = client.available()) && tries--) delay(1);
-    if (!newLength) {
-      break;
-    }
-    if (!buf) {
-      buf = (char *) malloc(newLength + 1);
-      if (!buf) {
-        return nullptr;
-      }
-    }
-    else {
-      char* newBuf = (char *) realloc(buf, dataLength + newLength + 1);
-      if (!newBuf) {
-        free(buf);
-        return nullptr;
-      }
-      buf = newBuf;
-    }
-    client.readBytes(buf + dataLength, newLength);
-    dataLength += newLength;
-    buf[dataLength] = '\0';
-  }
-  return buf;
-}
+// Parse the complete request collected in conn.buf. The buffer holds the
+// request line, the headers, the empty line and conn.body bytes of body and
+// is terminated with a '\0'. It is tokenized in place: uri, arguments and
+// header values end up as views into it, nothing is copied or allocated.
+bool ESP32WebServer::_parseRequest(HTTPConn& conn) {
+  unsigned long start = micros();
+  char *buf = conn.buf;
+  char *body = buf + conn.head;
+  buf[conn.head - 2] = '\0';        // cut off the empty line after the headers
 
-bool ESP32WebServer::_parseRequest(WiFiClient& client) {
-  // Read the first line of HTTP request
-  String req = client.readStringUntil('\r');
-  client.readStringUntil('\n');
   //reset header value
   for (int i = 0; i < _headerKeysCount; ++i) {
-    _currentHeaders[i].value =String();
-   }
+    _currentHeaders[i].value = "";
+  }
+  _hostHeader = "";
+  _currentArgCount = 0;
+  _pathArgCount = 0;
 
   // First line of HTTP request looks like "GET /path HTTP/1.1"
   // Retrieve the "/path" part by finding the spaces
-  int addr_start = req.indexOf(' ');
-  int addr_end = req.indexOf(' ', addr_start + 1);
-  if (addr_start == -1 || addr_end == -1) {
+  char *line = buf;
+  char *next = strstr(line, "\r\n");
+  if (next) {
+    *next = '\0';
+    next += 2;
+  }
+  char *addr_start = strchr(line, ' ');
+  char *addr_end = addr_start ? strchr(addr_start + 1, ' ') : NULL;
+  if (!addr_start || !addr_end) {
 #ifdef DEBUG_ESP_HTTP_SERVER
     DEBUG_OUTPUT.print("Invalid request: ");
-    DEBUG_OUTPUT.println(req);
+    DEBUG_OUTPUT.println(line);
 #endif
     return false;
   }
-
-  String methodStr = req.substring(0, addr_start);
-  String url = req.substring(addr_start + 1, addr_end);
-  String versionEnd = req.substring(addr_end + 8);
-  _currentVersion = atoi(versionEnd.c_str());
-  String searchStr = "";
-  int hasSearch = url.indexOf('?');
-  if (hasSearch != -1){
-    searchStr = urlDecode(url.substring(hasSearch + 1));
-    url = url.substring(0, hasSearch);
+  *addr_start = '\0';
+  *addr_end = '\0';
+
+  const char *methodStr = line;
+  char *url = addr_start + 1;
+  _currentVersion = (strlen(addr_end + 1) > 7) ? atoi(addr_end + 8) : 0;
+  char *search = strchr(url, '?');
+  if (search) {
+    *search++ = '\0';
   }
   _currentUri = url;
   _chunked = false;
 
   HTTPMethod method = HTTP_GET;
-  if (methodStr == "POST") {
+  if (strcmp(methodStr, "POST") == 0) {
     method = HTTP_POST;
-  } else if (methodStr == "DELETE") {
+  } else if (strcmp(methodStr, "DELETE") == 0) {
     method = HTTP_DELETE;
-  } else if (methodStr == "OPTIONS") {
+  } else if (strcmp(methodStr, "OPTIONS") == 0) {
     method = HTTP_OPTIONS;
-  } else if (methodStr == "PUT") {
+  } else if (strcmp(methodStr, "PUT") == 0) {
     method = HTTP_PUT;
-  } else if (methodStr == "PATCH") {
+  } else if (strcmp(methodStr, "PATCH") == 0) {
     method = HTTP_PATCH;
   }
   _currentMethod = method;
@@ -115,457 +97,139 @@ bool ESP32WebServer::_parseRequest(WiFiClient& client) {
   DEBUG_OUTPUT.print("method: ");
   DEBUG_OUTPUT.print(methodStr);
   DEBUG_OUTPUT.print(" url: ");
-  DEBUG_OUTPUT.print(url);
-  DEBUG_OUTPUT.print(" search: ");
-  DEBUG_OUTPUT.println(searchStr);
+  DEBUG_OUTPUT.println(url);
 #endif
 
-  //attach handler
-  RequestHandler* handler;
-  for (handler = _firstHandler; handler; handler = handler->next()) {
-    if (handler->canHandle(_currentMethod, _currentUri))
-      break;
+  //attach handler, the route tree first, then the handlers added with addHandler()
+  RequestHandler* handler = _routeMatch(&_routes, _currentUri);
+  if (!handler) {
+    _pathArgCount = 0;
+    for (handler = _firstHandler; handler; handler = handler->next()) {
+      if (handler->canHandle(_currentMethod, _currentUri))
+        break;
+    }
   }
   _currentHandler = handler;
 
-  String formData;
-  // below is needed only when POST type request
-  if (method == HTTP_POST || method == HTTP_PUT || method == HTTP_PATCH || method == HTTP_DELETE){
-    String boundaryStr;
-    String headerName;
-    String headerValue;
-    bool isForm = false;
-    bool isEncoded = false;
-    uint32_t contentLength = 0;
-    //parse headers
-    while(1){
-      req = client.readStringUntil('\r');
-      client.readStringUntil('\n');
-      if (req == "") break;//no moar headers
-      int headerDiv = req.indexOf(':');
-      if (headerDiv == -1){
-        break;
-      }
-      headerName = req.substring(0, headerDiv);
-      headerValue = req.substring(headerDiv + 1);
-      headerValue.trim();
-       _collectHeader(headerName.c_str(),headerValue.c_str());
-
-      #ifdef DEBUG_ESP_HTTP_SERVER
-      DEBUG_OUTPUT.print("headerName: ");
-      DEBUG_OUTPUT.println(headerName);
-      DEBUG_OUTPUT.print("headerValue: ");
-      DEBUG_OUTPUT.println(headerValue);
-      #endif
-
-      if (headerName.equalsIgnoreCase("Content-Type")){
-        if (headerValue.startsWith("text/plain")){
-          isForm = false;
-        } else if (headerValue.startsWith("application/x-www-form-urlencoded")){
-          isForm = false;
-          isEncoded = true;
-        } else if (headerValue.startsWith("multipart/")){
-          boundaryStr = headerValue.substring(headerValue.indexOf('=')+1);
-          isForm = true;
-        }
-      } else if (headerName.equalsIgnoreCase("Content-Length")){
-        contentLength = headerValue.toInt();
-      } else if (headerName.equalsIgnoreCase("Host")){
-        _hostHeader = headerValue;
-      }
+  //parse headers
+  bool isEncoded = false;
+  bool isPlain = true;
+  for (line = next; line && *line; line = next) {
+    next = strstr(line, "\r\n");
+    if (next) {
+      *next = '\0';
+      next += 2;
     }
-
-    if (!isForm){
-      size_t plainLength;
-      char* plainBuf = readBytesWithTimeout(client, contentLength, plainLength, HTTP_MAX_POST_WAIT);
-      if (plainLength < contentLength) {
-      	free(plainBuf);
-      	return false;
-      }
-      if (contentLength > 0) {
-        if (searchStr != "") searchStr += '&';
-        if(isEncoded){
-          //url encoded form
-          String decoded = urlDecode(plainBuf);
-          size_t decodedLen = decoded.length();
-          memcpy(plainBuf, decoded.c_str(), decodedLen);
-          plainBuf[decodedLen] = 0;
-          searchStr += plainBuf;
-        }
-        _parseArguments(searchStr);
-        if(!isEncoded){
-          //plain post json or other data
-          RequestArgument& arg = _currentArgs[_currentArgCount++];
-          arg.key = "plain";
-          arg.value = String(plainBuf);
-        }
-
-  #ifdef DEBUG_ESP_HTTP_SERVER
-        DEBUG_OUTPUT.print("Plain: ");
-        DEBUG_OUTPUT.println(plainBuf);
-  #endif
-        free(plainBuf);
-      }
+    char *headerDiv = strchr(line, ':');
+    if (!headerDiv) {
+      break;
     }
+    *headerDiv = '\0';
+    char *headerValue = headerDiv + 1;
+    while (*headerValue == ' ' || *headerValue == '\t')
+      headerValue++;
+    _collectHeader(line, headerValue);
+
+#ifdef DEBUG_ESP_HTTP_SERVER
+    DEBUG_OUTPUT.print("headerName: ");
+    DEBUG_OUTPUT.println(line);
+    DEBUG_OUTPUT.print("headerValue: ");
+    DEBUG_OUTPUT.println(headerValue);
+#endif
 
-    if (isForm){
-      _parseArguments(searchStr);
-      if (!_parseForm(client, boundaryStr, contentLength)) {
+    if (strcasecmp(line, "Content-Type") == 0) {
+      if (strncmp(headerValue, "application/x-www-form-urlencoded", 33) == 0) {
+        isEncoded = true;
+        isPlain = false;
+      } else if (strncmp(headerValue, "multipart/", 10) == 0) {
+        // File uploads would need the whole body in memory, not supported
         return false;
       }
+    } else if (strcasecmp(line, "Host") == 0) {
+      _hostHeader = headerValue;
     }
-  } else {
-    String headerName;
-    String headerValue;
-    //parse headers
-    while(1){
-      req = client.readStringUntil('\r');
-      client.readStringUntil('\n');
-      if (req == "") break;//no moar headers
-      int headerDiv = req.indexOf(':');
-      if (headerDiv == -1){
-        break;
-      }
-      headerName = req.substring(0, headerDiv);
-      headerValue = req.substring(headerDiv + 2);
-      _collectHeader(headerName.c_str(),headerValue.c_str());
+  }
 
-	  #ifdef DEBUG_ESP_HTTP_SERVER
-	  DEBUG_OUTPUT.print("headerName: ");
-	  DEBUG_OUTPUT.println(headerName);
-	  DEBUG_OUTPUT.print("headerValue: ");
-	  DEBUG_OUTPUT.println(headerValue);
-	  #endif
+  if (search)
+    _parseArguments(search);
 
-	  if (headerName.equalsIgnoreCase("Host")){
-        _hostHeader = headerValue;
-      }
+  // below is needed only when the request has a body
+  if (conn.body > 0) {
+    if (isEncoded) {
+      //url encoded form
+      _parseArguments(body);
+    }
+    else if (isPlain && _currentArgCount < HTTP_MAX_ARGS) {
+      //plain post json or other data
+      RequestArgument& arg = _currentArgs[_currentArgCount++];
+      arg.key = "plain";
+      arg.value = body;
     }
-    _parseArguments(searchStr);
-  }
-  client.flush();
 
 #ifdef DEBUG_ESP_HTTP_SERVER
-  DEBUG_OUTPUT.print("Request: ");
-  DEBUG_OUTPUT.println(url);
-  DEBUG_OUTPUT.print(" Arguments: ");
-  DEBUG_OUTPUT.println(searchStr);
+    DEBUG_OUTPUT.print("Body: ");
+    DEBUG_OUTPUT.println(body);
 #endif
+  }
 
+  _stats.parseUs = micros() - start;
   return true;
 }
 
 bool ESP32WebServer::_collectHeader(const char* headerName, const char* headerValue) {
   for (int i = 0; i < _headerKeysCount; i++) {
-    if (_currentHeaders[i].key.equalsIgnoreCase(headerName)) {
-            _currentHeaders[i].value=headerValue;
-            return true;
-        }
+    if (strcasecmp(_currentHeaders[i].key, headerName) == 0) {
+      _currentHeaders[i].value = headerValue;
+      return true;
+    }
   }
   return false;
 }
 
-void ESP32WebServer::_parseArguments(String data) {
+// Split "a=1&b=2" in place into _currentArgs and decode key and value.
+// Arguments without '=' and those beyond HTTP_MAX_ARGS are skipped.
+void ESP32WebServer::_parseArguments(char* data) {
 #ifdef DEBUG_ESP_HTTP_SERVER
   DEBUG_OUTPUT.print("args: ");
   DEBUG_OUTPUT.println(data);
 #endif
-  if (_currentArgs)
-    delete[] _currentArgs;
-  _currentArgs = 0;
-  if (data.length() == 0) {
-    _currentArgCount = 0;
-    _currentArgs = new RequestArgument[1];
-    return;
-  }
-  _currentArgCount = 1;
-
-  for (int i = 0; i < (int)data.length(); ) {
-    i = data.indexOf('&', i);
-    if (i == -1)
-      break;
-    ++i;
-    ++_currentArgCount;
-  }
-#ifdef DEBUG_ESP_HTTP_SERVER
-  DEBUG_OUTPUT.print("args count: ");
-  DEBUG_OUTPUT.println(_currentArgCount);
-#endif
-
-  _currentArgs = new RequestArgument[_currentArgCount+1];
-  int pos = 0;
-  int iarg;
-  for (iarg = 0; iarg < _currentArgCount;) {
-    int equal_sign_index = data.indexOf('=', pos);
-    int next_arg_index = data.indexOf('&', pos);
-#ifdef DEBUG_ESP_HTTP_SERVER
-    DEBUG_OUTPUT.print("pos ");
-    DEBUG_OUTPUT.print(pos);
-    DEBUG_OUTPUT.print("=@ ");
-    DEBUG_OUTPUT.print(equal_sign_index);
-    DEBUG_OUTPUT.print(" &@ ");
-    DEBUG_OUTPUT.println(next_arg_index);
-#endif
-    if ((equal_sign_index == -1) || ((equal_sign_index > next_arg_index) && (next_arg_index != -1))) {
+  while (data && *data && _currentArgCount < HTTP_MAX_ARGS) {
+    char *next = strchr(data, '&');
+    if (next)
+      *next++ = '\0';
+    char *equal = strchr(data, '=');
+    if (equal) {
+      *equal = '\0';
+      RequestArgument& arg = _currentArgs[_currentArgCount++];
+      arg.key = _urlDecode(data);
+      arg.value = _urlDecode(equal + 1);
 #ifdef DEBUG_ESP_HTTP_SERVER
-      DEBUG_OUTPUT.print("arg missing value: ");
-      DEBUG_OUTPUT.println(iarg);
+      DEBUG_OUTPUT.print("arg key: ");
+      DEBUG_OUTPUT.print(arg.key);
+      DEBUG_OUTPUT.print(" value: ");
+      DEBUG_OUTPUT.println(arg.value);
 #endif
-      if (next_arg_index == -1)
-        break;
-      pos = next_arg_index + 1;
-      continue;
     }
-    RequestArgument& arg = _currentArgs[iarg];
-    arg.key = data.substring(pos, equal_sign_index);
-	arg.value = data.substring(equal_sign_index + 1, next_arg_index);
-#ifdef DEBUG_ESP_HTTP_SERVER
-    DEBUG_OUTPUT.print("arg ");
-    DEBUG_OUTPUT.print(iarg);
-    DEBUG_OUTPUT.print(" key: ");
-    DEBUG_OUTPUT.print(arg.key);
-    DEBUG_OUTPUT.print(" value: ");
-    DEBUG_OUTPUT.println(arg.value);
-#endif
-    ++iarg;
-    if (next_arg_index == -1)
-      break;
-    pos = next_arg_index + 1;
-  }
-  _currentArgCount = iarg;
-#ifdef DEBUG_ESP_HTTP_SERVER
-  DEBUG_OUTPUT.print("args count: ");
-  DEBUG_OUTPUT.println(_currentArgCount);
-#endif
-
-}
-
-void ESP32WebServer::_uploadWriteByte(uint8_t b){
-  if (_currentUpload.currentSize == HTTP_UPLOAD_BUFLEN){
-    if(_currentHandler && _currentHandler->canUpload(_currentUri))
-      _currentHandler->upload(*this, _currentUri, _currentUpload);
-    _currentUpload.totalSize += _currentUpload.currentSize;
-    _currentUpload.currentSize = 0;
-  }
-  _currentUpload.buf[_currentUpload.currentSize++] = b;
-}
-
-uint8_t ESP32WebServer::_uploadReadByte(WiFiClient& client){
-  int res = client.read();
-  if(res == -1){
-    while(!client.available() && client.connected())
-      yield();
-    res = client.read();
+    data = next;
   }
-  return (uint8_t)res;
 }
 
-bool ESP32WebServer::_parseForm(WiFiClient& client, String boundary, uint32_t len){
-  (void) len;
-#ifdef DEBUG_ESP_HTTP_SERVER
-  DEBUG_OUTPUT.print("Parse Form: Boundary: ");
-  DEBUG_OUTPUT.print(boundary);
-  DEBUG_OUTPUT.print(" Length: ");
-  DEBUG_OUTPUT.println(len);
-#endif
-  String line;
-  int retry = 0;
-  do {
-    line = client.readStringUntil('\r');
-    ++retry;
-  } while (line.length() == 0 && retry < 3);
-
-  client.readStringUntil('\n');
-  //start reading the form
-  if (line == ("--"+boundary)){
-    RequestArgument* postArgs = new RequestArgument[32];
-    int postArgsLen = 0;
-    while(1){
-      String argName;
-      String argValue;
-      String argType;
-      String argFilename;
-      bool argIsFile = false;
-
-      line = client.readStringUntil('\r');
-      client.readStringUntil('\n');
-      if (line.length() > 19 && line.substring(0, 19).equalsIgnoreCase("Content-Disposition")){
-        int nameStart = line.indexOf('=');
-        if (nameStart != -1){
-          argName = line.substring(nameStart+2);
-          nameStart = argName.indexOf('=');
-          if (nameStart == -1){
-            argName = argName.substring(0, argName.length() - 1);
-          } else {
-            argFilename = argName.substring(nameStart+2, argName.length() - 1);
-            argName = argName.substring(0, argName.indexOf('"'));
-            argIsFile = true;
-#ifdef DEBUG_ESP_HTTP_SERVER
-            DEBUG_OUTPUT.print("PostArg FileName: ");
-            DEBUG_OUTPUT.println(argFilename);
-#endif
-            //use GET to set the filename if uploading using blob
-            if (argFilename == "blob" && hasArg("filename")) argFilename = arg("filename");
-          }
-#ifdef DEBUG_ESP_HTTP_SERVER
-          DEBUG_OUTPUT.print("PostArg Name: ");
-          DEBUG_OUTPUT.println(argName);
-#endif
-          argType = "text/plain";
-          line = client.readStringUntil('\r');
-          client.readStringUntil('\n');
-          if (line.length() > 12 && line.substring(0, 12).equalsIgnoreCase("Content-Type")){
-            argType = line.substring(line.indexOf(':')+2);
-            //skip next line
-            client.readStringUntil('\r');
-            client.readStringUntil('\n');
-          }
-#ifdef DEBUG_ESP_HTTP_SERVER
-          DEBUG_OUTPUT.print("PostArg Type: ");
-          DEBUG_OUTPUT.println(argType);
-#endif
-          if (!argIsFile){
-            while(1){
-              line = client.readStringUntil('\r');
-              client.readStringUntil('\n');
-              if (line.startsWith("--"+boundary)) break;
-              if (argValue.length() > 0) argValue += "\n";
-              argValue += line;
-            }
-#ifdef DEBUG_ESP_HTTP_SERVER
-            DEBUG_OUTPUT.print("PostArg Value: ");
-            DEBUG_OUTPUT.println(argValue);
-            DEBUG_OUTPUT.println();
-#endif
-
-            RequestArgument& arg = postArgs[postArgsLen++];
-            arg.key = argName;
-            arg.value = argValue;
-
-            if (line == ("--"+boundary+"--")){
-#ifdef DEBUG_ESP_HTTP_SERVER
-              DEBUG_OUTPUT.println("Done Parsing POST");
-#endif
-              break;
-            }
-          } else {
-            _currentUpload.status = UPLOAD_FILE_START;
-            _currentUpload.name = argName;
-            _currentUpload.filename = argFilename;
-            _currentUpload.type = argType;
-            _currentUpload.totalSize = 0;
-            _currentUpload.currentSize = 0;
-#ifdef DEBUG_ESP_HTTP_SERVER
-            DEBUG_OUTPUT.print("Start File: ");
-            DEBUG_OUTPUT.print(_currentUpload.filename);
-            DEBUG_OUTPUT.print(" Type: ");
-            DEBUG_OUTPUT.println(_currentUpload.type);
-#endif
-            if(_currentHandler && _currentHandler->canUpload(_currentUri))
-              _currentHandler->upload(*this, _currentUri, _currentUpload);
-            _currentUpload.status = UPLOAD_FILE_WRITE;
-            uint8_t argByte = _uploadReadByte(client);
-readfile:
-            while(argByte != 0x0D){
-              if (!client.connected()) return _parseFormUploadAborted();
-              _uploadWriteByte(argByte);
-              argByte = _uploadReadByte(client);
-            }
-
-            argByte = _uploadReadByte(client);
-            if (!client.connected()) return _parseFormUploadAborted();
-            if (argByte == 0x0A){
-              argByte = _uploadReadByte(client);
-              if (!client.connected()) return _parseFormUploadAborted();
-              if ((char)argByte != '-'){
-                //continue reading the file
-                _uploadWriteByte(0x0D);
-                _uploadWriteByte(0x0A);
-                goto readfile;
-              } else {
-                argByte = _uploadReadByte(client);
-                if (!client.connected()) return _parseFormUploadAborted();
-                if ((char)argByte != '-'){
-                  //continue reading the file
-                  _uploadWriteByte(0x0D);
-                  _uploadWriteByte(0x0A);
-                  _uploadWriteByte((uint8_t)('-'));
-                  goto readfile;
-                }
-              }
-
-              uint8_t endBuf[boundary.length()];
-              client.readBytes(endBuf, boundary.length());
-
-              if (strstr((const char*)endBuf, boundary.c_str()) != NULL){
-                if(_currentHandler && _currentHandler->canUpload(_currentUri))
-                  _currentHandler->upload(*this, _currentUri, _currentUpload);
-                _currentUpload.totalSize += _currentUpload.currentSize;
-                _currentUpload.status = UPLOAD_FILE_END;
-                if(_currentHandler && _currentHandler->canUpload(_currentUri))
-                  _currentHandler->upload(*this, _currentUri, _currentUpload);
-#ifdef DEBUG_ESP_HTTP_SERVER
-                DEBUG_OUTPUT.print("End File: ");
-                DEBUG_OUTPUT.print(_currentUpload.filename);
-                DEBUG_OUTPUT.print(" Type: ");
-                DEBUG_OUTPUT.print(_currentUpload.type);
-                DEBUG_OUTPUT.print(" Size: ");
-                DEBUG_OUTPUT.println(_currentUpload.totalSize);
-#endif
-                line = client.readStringUntil(0x0D);
-                client.readStringUntil(0x0A);
-                if (line == "--"){
-#ifdef DEBUG_ESP_HTTP_SERVER
-                  DEBUG_OUTPUT.println("Done Parsing POST");
-#endif
-                  break;
-                }
-                continue;
-              } else {
-                _uploadWriteByte(0x0D);
-                _uploadWriteByte(0x0A);
-                _uploadWriteByte((uint8_t)('-'));
-                _uploadWriteByte((uint8_t)('-'));
-                uint32_t i = 0;
-                while(i < boundary.length()){
-                  _uploadWriteByte(endBuf[i++]);
-                }
-                argByte = _uploadReadByte(client);
-                goto readfile;
-              }
-            } else {
-              _uploadWriteByte(0x0D);
-              goto readfile;
-            }
-            break;
-          }
-        }
-      }
-    }
-
-    int iarg;
-    int totalArgs = ((32 - postArgsLen) < _currentArgCount)?(32 - postArgsLen):_currentArgCount;
-    for (iarg = 0; iarg < totalArgs; iarg++){
-      RequestArgument& arg = postArgs[postArgsLen++];
-      arg.key = _currentArgs[iarg].key;
-      arg.value = _currentArgs[iarg].value;
-    }
-    if (_currentArgs) delete[] _currentArgs;
-    _currentArgs = new RequestArgument[postArgsLen];
-    for (iarg = 0; iarg < postArgsLen; iarg++){
-      RequestArgument& arg = _currentArgs[iarg];
-      arg.key = postArgs[iarg].key;
-      arg.value = postArgs[iarg].value;
+// Decode %xx and '+' in place, the result is never longer than the input
+char* ESP32WebServer::_urlDecode(char* text) {
+  char *out = text;
+  for (char *in = text; *in; in++) {
+    if (*in == '%' && isxdigit((unsigned char)in[1]) && isxdigit((unsigned char)in[2])) {
+      char hex[3] = {in[1], in[2], '\0'};
+      *out++ = (char) strtol(hex, NULL, 16);
+      in += 2;
+    } else if (*in == '+') {
+      *out++ = ' ';
+    } else {
+      *out++ = *in;
     }
-    _currentArgCount = iarg;
-    if (postArgs) delete[] postArgs;
-    return true;
   }
-#ifdef DEBUG_ESP_HTTP_SERVER
-  DEBUG_OUTPUT.print("Error: line: ");
-  DEBUG_OUTPUT.println(line);
-#endif
-  return false;
+  *out = '\0';
+  return text;
 }
 
 String ESP32WebServer::urlDecode(const String& text)
@@ -598,10 +262,3 @@ String ESP32WebServer::urlDecode(const String& text)
 	}
 	return decoded;
 }
-
-bool ESP32WebServer::_parseFormUploadAborted(){
-  _currentUpload.status = UPLOAD_FILE_ABORTED;
-  if(_currentHandler && _currentHandler->canUpload(_currentUri))
-    _currentHandler->upload(*this, _currentUri, _currentUpload);
-  return false;
-}
@@ -0,0 +1,231 @@
+/*
+  Routing.cpp - Prefix tree of the routes registered with on().
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <Arduino.h>
+#include "ESP32WebServer.h"
+
+//#define DEBUG_ESP_HTTP_SERVER
+#ifdef DEBUG_ESP_PORT
+#define DEBUG_OUTPUT DEBUG_ESP_PORT
+#else
+#define DEBUG_OUTPUT Serial
+#endif
+
+// Routes share their common prefix, "/SF={-1|1}" and "/SCAN" hang below one
+// "/S" node. Literal edges are split when a new route only shares a part of
+// them. A parameter is its own edge:
+//   {int}     an optionally signed decimal number
+//   {str}     any text up to the next '/'
+//   {a|b|c}   exactly one of the alternatives, pathArgIndex() tells which
+// Literal children are tried before parameters, so "/sf/auto" wins over
+// "/sf/{int}". Building the tree allocates, matching a request does not.
+
+static char* _strndup(const char* s, size_t len) {
+  char* d = (char *) malloc(len + 1);
+  if (d) {
+    memcpy(d, s, len);
+    d[len] = '\0';
+  }
+  return d;
+}
+
+// Find or create the child of node for one parameter edge
+UriNode* ESP32WebServer::_routeChild(UriNode* node, const char* label, uint8_t len, uint8_t type) {
+  UriNode** link = &node->child;
+  for (UriNode* c = node->child; c; c = c->sibling) {
+    if (c->type == type && c->len == len && strncmp(c->label, label, len) == 0)
+      return c;
+    link = &c->sibling;
+  }
+  UriNode* c = (UriNode *) calloc(1, sizeof(UriNode));
+  if (!c)
+    return NULL;
+  c->label = _strndup(label, len);
+  c->len = len;
+  c->type = type;
+  *link = c;  // parameters go to the end of the list
+  return c;
+}
+
+bool ESP32WebServer::_routeAdd(const char* pattern, RequestHandler* handler) {
+  UriNode* node = &_routes;
+  const char* p = pattern;
+
+  while (*p) {
+    if (*p == '{') {
+      const char* end = strchr(p, '}');
+      if (!end)
+        return false;
+      const char* spec = p + 1;
+      uint8_t len = end - spec;
+      uint8_t type = URI_ENUM;
+      if (len == 3 && strncmp(spec, "int", 3) == 0)
+        type = URI_INT;
+      else if (len == 3 && strncmp(spec, "str", 3) == 0)
+        type = URI_STR;
+      node = _routeChild(node, spec, len, type);
+      if (!node)
+        return false;
+      p = end + 1;
+      continue;
+    }
+
+    // Literal text up to the next parameter
+    size_t len = strcspn(p, "{");
+    UriNode* c;
+    for (c = node->child; c; c = c->sibling) {
+      if (c->type == URI_LITERAL && c->label[0] == p[0])
+        break;
+    }
+    if (!c) {
+      // New literal edge, in front of the parameter edges
+      c = (UriNode *) calloc(1, sizeof(UriNode));
+      if (!c)
+        return false;
+      c->label = _strndup(p, len);
+      c->len = len;
+      c->type = URI_LITERAL;
+      c->sibling = node->child;
+      node->child = c;
+      node = c;
+      p += len;
+      continue;
+    }
+
+    size_t common = 0;
+    while (common < c->len && common < len && c->label[common] == p[common])
+      common++;
+    if (common < c->len) {
+      // Split c: the shared part stays, the rest moves one level down
+      UriNode* rest = (UriNode *) calloc(1, sizeof(UriNode));
+      char* head = _strndup(c->label, common);
+      if (!rest || !head) {
+        free(rest);
+        free(head);
+        return false;
+      }
+      rest->label = _strndup(c->label + common, c->len - common);
+      rest->len = c->len - common;
+      rest->type = URI_LITERAL;
+      rest->child = c->child;
+      rest->handler = c->handler;
+      free(c->label);
+      c->label = head;
+      c->len = common;
+      c->child = rest;
+      c->handler = NULL;
+    }
+    node = c;
+    p += common;
+  }
+
+  // Keep the handlers of one route in registration order
+  if (!node->handler) {
+    node->handler = handler;
+  } else {
+    RequestHandler* h = node->handler;
+    while (h->nextRoute())
+      h = h->nextRoute();
+    h->nextRoute(handler);
+  }
+  return true;
+}
+
+void ESP32WebServer::_routeFree(UriNode* node) {
+  while (node) {
+    UriNode* next = node->sibling;
+    _routeFree(node->child);
+    RequestHandler* h = node->handler;
+    while (h) {
+      RequestHandler* n = h->nextRoute();
+      delete h;
+      h = n;
+    }
+    free(node->label);
+    free(node);
+    node = next;
+  }
+}
+
+// Walk the tree along uri. Returns the handler for the current method, the
+// typed parameters that were passed on the way are left in _pathArgs.
+RequestHandler* ESP32WebServer::_routeMatch(UriNode* node, const char* uri) {
+  if (*uri == '\0') {
+    for (RequestHandler* h = node->handler; h; h = h->nextRoute()) {
+      if (h->canHandle(_currentMethod, _currentUri))
+        return h;
+    }
+    return NULL;
+  }
+
+  for (UriNode* c = node->child; c; c = c->sibling) {
+    if (c->type == URI_LITERAL) {
+      if (strncmp(uri, c->label, c->len) != 0)
+        continue;
+      RequestHandler* h = _routeMatch(c, uri + c->len);
+      if (h)
+        return h;
+      continue;
+    }
+
+    if (_pathArgCount >= HTTP_MAX_PATH_ARGS)
+      continue;
+    HTTPPathArg& arg = _pathArgs[_pathArgCount];
+    arg.value = uri;
+    arg.index = 0;
+
+    if (c->type == URI_ENUM) {
+      // Try every alternative, "1" must not hide "10"
+      const char* alt = c->label;
+      const char* end = c->label + c->len;
+      for (uint8_t i = 0; alt < end; i++) {
+        const char* bar = (const char *) memchr(alt, '|', end - alt);
+        size_t len = (bar ? bar : end) - alt;
+        if (len > 0 && strncmp(uri, alt, len) == 0) {
+          arg.len = len;
+          arg.index = i;
+          _pathArgCount++;
+          RequestHandler* h = _routeMatch(c, uri + len);
+          if (h)
+            return h;
+          _pathArgCount--;
+        }
+        alt += len + 1;
+      }
+      continue;
+    }
+
+    size_t len;
+    if (c->type == URI_INT) {
+      len = (uri[0] == '-' || uri[0] == '+') ? 1 : 0;
+      size_t digits = strspn(uri + len, "0123456789");
+      len = digits ? len + digits : 0;
+    } else {
+      len = strcspn(uri, "/");
+    }
+    if (len == 0 || len > 255)
+      continue;
+    arg.len = len;
+    _pathArgCount++;
+    RequestHandler* h = _routeMatch(c, uri + len);
+    if (h)
+      return h;
+    _pathArgCount--;
+  }
+  return NULL;
+}
@@ -4,16 +4,21 @@
 class RequestHandler {
 public:
     virtual ~RequestHandler() { }
-    virtual bool canHandle(HTTPMethod method, String uri) { (void) method; (void) uri; return false; }
-    virtual bool canUpload(String uri) { (void) uri; return false; }
-    virtual bool handle(ESP32WebServer& server, HTTPMethod requestMethod, String requestUri) { (void) server; (void) requestMethod; (void) requestUri; return false; }
-    virtual void upload(ESP32WebServer& server, String requestUri, HTTPUpload& upload) { (void) server; (void) requestUri; (void) upload; }
+    virtual bool canHandle(HTTPMethod method, const char* uri) { (void) method; (void) uri; return false; }
+    virtual bool canUpload(const char* uri) { (void) uri; return false; }
+    virtual bool handle(ESP32WebServer& server, HTTPMethod requestMethod, const char* requestUri) { (void) server; (void) requestMethod; (void) requestUri; return false; }
+    virtual void upload(ESP32WebServer& server, const char* requestUri, HTTPUpload& upload) { (void) server; (void) requestUri; (void) upload; }
 
     RequestHandler* next() { return _next; }
     void next(RequestHandler* r) { _next = r; }
 
+    // Other handlers for the same route in the route tree (GET, POST, ...)
+    RequestHandler* nextRoute() { return _nextRoute; }
+    void nextRoute(RequestHandler* r) { _nextRoute = r; }
+
 private:
     RequestHandler* _next = nullptr;
+    RequestHandler* _nextRoute = nullptr;
 };
 
 #endif //REQUESTHANDLER_H
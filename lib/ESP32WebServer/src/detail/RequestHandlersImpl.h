@@ -3,34 +3,33 @@
 
 #include "RequestHandler.h"
 
+// Handler for a route registered with on(). The uri was already matched by
+// the route tree, so only the method is left to check here.
 class FunctionRequestHandler : public RequestHandler {
 public:
-    FunctionRequestHandler(ESP32WebServer::THandlerFunction fn, ESP32WebServer::THandlerFunction ufn, const String &uri, HTTPMethod method)
+    FunctionRequestHandler(ESP32WebServer::THandlerFunction fn, ESP32WebServer::THandlerFunction ufn, HTTPMethod method)
     : _fn(fn)
     , _ufn(ufn)
-    , _uri(uri)
     , _method(method)
     {
     }
 
-    bool canHandle(HTTPMethod requestMethod, String requestUri) override  {
+    bool canHandle(HTTPMethod requestMethod, const char* requestUri) override  {
+        (void) requestUri;
         if (_method != HTTP_ANY && _method != requestMethod)
             return false;
 
-        if (requestUri != _uri)
-            return false;
-
         return true;
     }
 
-    bool canUpload(String requestUri) override  {
+    bool canUpload(const char* requestUri) override  {
         if (!_ufn || !canHandle(HTTP_POST, requestUri))
             return false;
 
         return true;
     }
 
-    bool handle(ESP32WebServer& server, HTTPMethod requestMethod, String requestUri) override {
+    bool handle(ESP32WebServer& server, HTTPMethod requestMethod, const char* requestUri) override {
         (void) server;
         if (!canHandle(requestMethod, requestUri))
             return false;
@@ -39,7 +38,7 @@ public:
         return true;
     }
 
-    void upload(ESP32WebServer& server, String requestUri, HTTPUpload& upload) override {
+    void upload(ESP32WebServer& server, const char* requestUri, HTTPUpload& upload) override {
         (void) server;
         (void) upload;
         if (canUpload(requestUri))
@@ -49,7 +48,6 @@ public:
 protected:
     ESP32WebServer::THandlerFunction _fn;
     ESP32WebServer::THandlerFunction _ufn;
-    String _uri;
     HTTPMethod _method;
 };
 
@@ -66,7 +64,8 @@ public:
         _baseUriLength = _uri.length();
     }
 
-    bool canHandle(HTTPMethod requestMethod, String requestUri) override  {
+    bool canHandle(HTTPMethod requestMethod, const char* uri) override  {
+        String requestUri(uri);
         if (requestMethod != HTTP_GET)
             return false;
 
@@ -76,10 +75,12 @@ public:
         return true;
     }
 
-    bool handle(ESP32WebServer& server, HTTPMethod requestMethod, String requestUri) override {
-        if (!canHandle(requestMethod, requestUri))
+    bool handle(ESP32WebServer& server, HTTPMethod requestMethod, const char* uri) override {
+        if (!canHandle(requestMethod, uri))
             return false;
 
+        String requestUri(uri);
+
         log_e("StaticRequestHandler::handle: request=%s _uri=%s\r\n", requestUri.c_str(), _uri.c_str());
 
         String path(_path);
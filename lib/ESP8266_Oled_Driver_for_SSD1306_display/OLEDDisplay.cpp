@@ -555,6 +555,30 @@ void OLEDDisplay::flipScreenVertically() {
   sendCommand(COMSCANDEC);           //Rotate screen 180 Deg
 }
 
+#ifdef OLEDDISPLAY_DOUBLE_BUFFER
+bool OLEDDisplay::updateDirty() {
+  bool dirty = false;
+  for (uint8_t y = 0; y < (DISPLAY_HEIGHT / 8); y++) {
+    uint8_t *front = buffer + y * DISPLAY_WIDTH;
+    uint8_t *back = buffer_back + y * DISPLAY_WIDTH;
+    int16_t first = 0;
+    int16_t last = DISPLAY_WIDTH - 1;
+    while (first <= last && front[first] == back[first]) first++;
+    while (last > first && front[last] == back[last]) last--;
+    if (first > last) {
+      dirtyFirst[y] = 1;
+      dirtyLast[y] = 0;
+      continue;
+    }
+    memcpy(back + first, front + first, last - first + 1);
+    dirtyFirst[y] = first;
+    dirtyLast[y] = last;
+    dirty = true;
+  }
+  return dirty;
+}
+#endif
+
 void OLEDDisplay::clear(void) {
   memset(buffer, 0, DISPLAY_BUFFER_SIZE);
 }
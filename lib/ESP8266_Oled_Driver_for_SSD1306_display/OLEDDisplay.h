@@ -232,8 +232,28 @@ class OLEDDisplay : public Print {
     uint8_t            *buffer_back;
     #endif
 
+    // Bytes put on the bus and time taken by the last display() that
+    // had something to send
+    uint32_t getFrameBytes() { return frameBytes; }
+    uint32_t getFrameMicros() { return frameMicros; }
+
   protected:
 
+    #ifdef OLEDDISPLAY_DOUBLE_BUFFER
+    // Changed columns of every page, filled by updateDirty().
+    // A page with dirtyFirst > dirtyLast has not changed.
+    uint8_t    dirtyFirst[DISPLAY_HEIGHT / 8];
+    uint8_t    dirtyLast[DISPLAY_HEIGHT / 8];
+
+    // Compare buffer with buffer_back page by page, note the changed
+    // columns and copy them to buffer_back. Returns false when nothing
+    // changed since the last display().
+    bool updateDirty();
+    #endif
+
+    uint32_t   frameBytes                      = 0;
+    uint32_t   frameMicros                     = 0;
+
     OLEDDISPLAY_TEXT_ALIGNMENT   textAlignment = TEXT_ALIGN_LEFT;
     OLEDDISPLAY_COLOR            color         = WHITE;
 
@@ -57,66 +57,35 @@ class SH1106Brzo : public OLEDDisplay {
 
     void display(void) {
     #ifdef OLEDDISPLAY_DOUBLE_BUFFER
-       uint8_t minBoundY = ~0;
-       uint8_t maxBoundY = 0;
+       // Only the changed columns of the changed pages go on the bus
+       if (!updateDirty()) return;
 
-       uint8_t minBoundX = ~0;
-       uint8_t maxBoundX = 0;
-       uint8_t x, y;
-
-       // Calculate the Y bounding box of changes
-       // and copy buffer[pos] to buffer_back[pos];
-       for (y = 0; y < (DISPLAY_HEIGHT / 8); y++) {
-         for (x = 0; x < DISPLAY_WIDTH; x++) {
-          uint16_t pos = x + y * DISPLAY_WIDTH;
-          if (buffer[pos] != buffer_back[pos]) {
-            minBoundY = _min(minBoundY, y);
-            maxBoundY = _max(maxBoundY, y);
-            minBoundX = _min(minBoundX, x);
-            maxBoundX = _max(maxBoundX, x);
-          }
-          buffer_back[pos] = buffer[pos];
-        }
-        yield();
-       }
-
-       // If the minBoundY wasn't updated
-       // we can savely assume that buffer_back[pos] == buffer[pos]
-       // holdes true for all values of pos
-       if (minBoundY == ~0) return;
-
-       byte k = 0;
        uint8_t sendBuffer[17];
        sendBuffer[0] = 0x40;
-
-       // Calculate the colum offset 
-       uint8_t minBoundXp2H = (minBoundX + 2) & 0x0F;
-       uint8_t minBoundXp2L = 0x10 | ((minBoundX + 2) >> 4 );
-
-       brzo_i2c_start_transaction(this->_address, BRZO_I2C_SPEED);
-
-       for (y = minBoundY; y <= maxBoundY; y++) {
+       for (uint8_t y = 0; y < (DISPLAY_HEIGHT / 8); y++) {
+         if (dirtyFirst[y] > dirtyLast[y]) continue;
+         // Calculate the colum offset
+         uint8_t column = dirtyFirst[y] + 2;
          sendCommand(0xB0 + y);
-         sendCommand(minBoundXp2H);
-         sendCommand(minBoundXp2L);
-         for (x = minBoundX; x <= maxBoundX; x++) {
-             k++;
-             sendBuffer[k] = buffer[x + y * DISPLAY_WIDTH];
-             if (k == 16)  {
-               brzo_i2c_write(sendBuffer, 17, true);
-               k = 0;
-             }
+         sendCommand(column & 0x0F);
+         sendCommand(0x10 | (column >> 4));
+
+         byte k = 0;
+         brzo_i2c_start_transaction(this->_address, BRZO_I2C_SPEED);
+         for (uint8_t x = dirtyFirst[y]; x <= dirtyLast[y]; x++) {
+           k++;
+           sendBuffer[k] = buffer[x + y * DISPLAY_WIDTH];
+           if (k == 16)  {
+             brzo_i2c_write(sendBuffer, 17, true);
+             k = 0;
+           }
          }
          if (k != 0) {
            brzo_i2c_write(sendBuffer, k + 1, true);
-           k = 0;
          }
+         brzo_i2c_end_transaction();
          yield();
        }
-       if (k != 0) {
-         brzo_i2c_write(sendBuffer, k + 1, true);
-       }
-       brzo_i2c_end_transaction();
      #else
      #endif
     }
@@ -61,45 +61,18 @@ class SH1106Spi : public OLEDDisplay {
 
     void display(void) {
     #ifdef OLEDDISPLAY_DOUBLE_BUFFER
-       uint8_t minBoundY = ~0;
-       uint8_t maxBoundY = 0;
+       // Only the changed columns of the changed pages go on the bus
+       if (!updateDirty()) return;
 
-       uint8_t minBoundX = ~0;
-       uint8_t maxBoundX = 0;
-
-       uint8_t x, y;
-
-       // Calculate the Y bounding box of changes
-       // and copy buffer[pos] to buffer_back[pos];
-       for (y = 0; y < (DISPLAY_HEIGHT / 8); y++) {
-         for (x = 0; x < DISPLAY_WIDTH; x++) {
-          uint16_t pos = x + y * DISPLAY_WIDTH;
-          if (buffer[pos] != buffer_back[pos]) {
-            minBoundY = _min(minBoundY, y);
-            maxBoundY = _max(maxBoundY, y);
-            minBoundX = _min(minBoundX, x);
-            maxBoundX = _max(maxBoundX, x);
-          }
-          buffer_back[pos] = buffer[pos];
-        }
-        yield();
-       }
-
-       // If the minBoundY wasn't updated
-       // we can savely assume that buffer_back[pos] == buffer[pos]
-       // holdes true for all values of pos
-       if (minBoundY == ~0) return;
-
-       // Calculate the colum offset
-       uint8_t minBoundXp2H = (minBoundX + 2) & 0x0F;
-       uint8_t minBoundXp2L = 0x10 | ((minBoundX + 2) >> 4 );
-
-       for (y = minBoundY; y <= maxBoundY; y++) {
+       for (uint8_t y = 0; y < (DISPLAY_HEIGHT / 8); y++) {
+         if (dirtyFirst[y] > dirtyLast[y]) continue;
+         // Calculate the colum offset
+         uint8_t column = dirtyFirst[y] + 2;
          sendCommand(0xB0 + y);
-         sendCommand(minBoundXp2H);
-         sendCommand(minBoundXp2L);
+         sendCommand(column & 0x0F);
+         sendCommand(0x10 | (column >> 4));
          digitalWrite(_dc, HIGH);   // data mode
-         for (x = minBoundX; x <= maxBoundX; x++) {
+         for (uint8_t x = dirtyFirst[y]; x <= dirtyLast[y]; x++) {
            SPI.transfer(buffer[x + y * DISPLAY_WIDTH]);
          }
          yield();
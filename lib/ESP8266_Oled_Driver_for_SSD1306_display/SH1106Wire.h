@@ -60,81 +60,31 @@ class SH1106Wire : public OLEDDisplay {
 
     void display(void) {
       #ifdef OLEDDISPLAY_DOUBLE_BUFFER
-        uint8_t minBoundY = ~0;
-        uint8_t maxBoundY = 0;
-
-        uint8_t minBoundX = ~0;
-        uint8_t maxBoundX = 0;
-
-        uint8_t x, y;
-
-        // Calculate the Y bounding box of changes
-        // and copy buffer[pos] to buffer_back[pos];
-        for (y = 0; y < (DISPLAY_HEIGHT / 8); y++) {
-          for (x = 0; x < DISPLAY_WIDTH; x++) {
-           uint16_t pos = x + y * DISPLAY_WIDTH;
-           if (buffer[pos] != buffer_back[pos]) {
-             minBoundY = _min(minBoundY, y);
-             maxBoundY = _max(maxBoundY, y);
-             minBoundX = _min(minBoundX, x);
-             maxBoundX = _max(maxBoundX, x);
-           }
-           buffer_back[pos] = buffer[pos];
-         }
-         yield();
-        }
-
-        // If the minBoundY wasn't updated
-        // we can savely assume that buffer_back[pos] == buffer[pos]
-        // holdes true for all values of pos
-        if (minBoundY == ~0) return;
-
-        // Calculate the colum offset
-        uint8_t minBoundXp2H = (minBoundX + 2) & 0x0F;
-        uint8_t minBoundXp2L = 0x10 | ((minBoundX + 2) >> 4 );
-
-        byte k = 0;
-        for (y = minBoundY; y <= maxBoundY; y++) {
-          sendCommand(0xB0 + y);
-          sendCommand(minBoundXp2H);
-          sendCommand(minBoundXp2L);
-          for (x = minBoundX; x <= maxBoundX; x++) {
-            if (k == 0) {
-              Wire.beginTransmission(_address);
-              Wire.write(0x40);
-            }
-            Wire.write(buffer[x + y * DISPLAY_WIDTH]);
-            k++;
-            if (k == 16)  {
-              Wire.endTransmission();
-              k = 0;
-            }
-          }
-          if (k != 0)  {
-            Wire.endTransmission();
-            k = 0;
-          }
+        // Only the changed columns of the changed pages go on the bus
+        if (!updateDirty()) return;
+        uint32_t start = micros();
+        frameBytes = 0;
+
+        for (uint8_t y = 0; y < (DISPLAY_HEIGHT / 8); y++) {
+          if (dirtyFirst[y] > dirtyLast[y]) continue;
+          // The SH1106 has 132 columns, the visible ones start at 2
+          uint8_t column = dirtyFirst[y] + 2;
+          uint8_t window[] = {(uint8_t)(0xB0 + y), (uint8_t)(column & 0x0F), (uint8_t)(0x10 | (column >> 4))};
+          sendCommands(window, sizeof(window));
+          sendData(buffer + y * DISPLAY_WIDTH + dirtyFirst[y], dirtyLast[y] - dirtyFirst[y] + 1);
           yield();
         }
-
-        if (k != 0) {
-          Wire.endTransmission();
-        }
+        frameMicros = micros() - start;
       #else
-        uint8_t * p = &buffer[0];
-        for (uint8_t y=0; y<8; y++) {
-          sendCommand(0xB0+y);
-          sendCommand(0x02);
-          sendCommand(0x10);
-          for( uint8_t x=0; x<8; x++) {
-            Wire.beginTransmission(_address);
-            Wire.write(0x40);
-            for (uint8_t k = 0; k < 16; k++) {
-              Wire.write(*p++);
-            }
-            Wire.endTransmission();
-          }
+        uint32_t start = micros();
+        frameBytes = 0;
+
+        for (uint8_t y = 0; y < (DISPLAY_HEIGHT / 8); y++) {
+          uint8_t window[] = {(uint8_t)(0xB0 + y), 0x02, 0x10};
+          sendCommands(window, sizeof(window));
+          sendData(buffer + y * DISPLAY_WIDTH, DISPLAY_WIDTH);
         }
+        frameMicros = micros() - start;
       #endif
     }
 
@@ -144,6 +94,30 @@ class SH1106Wire : public OLEDDisplay {
       Wire.write(0x80);
       Wire.write(command);
       Wire.endTransmission();
+      frameBytes += 3;
+    }
+
+    // Several commands in one transfer, control byte 0x00 = command stream
+    void sendCommands(const uint8_t *commands, uint8_t count) {
+      Wire.beginTransmission(_address);
+      Wire.write((uint8_t)0x00);
+      Wire.write(commands, count);
+      Wire.endTransmission();
+      frameBytes += count + 2;
+    }
+
+    // Display data in transfers of at most 16 bytes
+    void sendData(const uint8_t *data, uint16_t count) {
+      while (count) {
+        uint8_t k = count > 16 ? 16 : count;
+        Wire.beginTransmission(_address);
+        Wire.write(0x40);
+        Wire.write(data, k);
+        Wire.endTransmission();
+        frameBytes += k + 2;
+        data += k;
+        count -= k;
+      }
     }
 
 
@@ -69,53 +69,28 @@ class SSD1306Spi : public OLEDDisplay {
 
     void display(void) {
     #ifdef OLEDDISPLAY_DOUBLE_BUFFER
-       uint8_t minBoundY = ~0;
-       uint8_t maxBoundY = 0;
-
-       uint8_t minBoundX = ~0;
-       uint8_t maxBoundX = 0;
-
-       uint8_t x, y;
-
-       // Calculate the Y bounding box of changes
-       // and copy buffer[pos] to buffer_back[pos];
-       for (y = 0; y < (DISPLAY_HEIGHT / 8); y++) {
-         for (x = 0; x < DISPLAY_WIDTH; x++) {
-          uint16_t pos = x + y * DISPLAY_WIDTH;
-          if (buffer[pos] != buffer_back[pos]) {
-            minBoundY = _min(minBoundY, y);
-            maxBoundY = _max(maxBoundY, y);
-            minBoundX = _min(minBoundX, x);
-            maxBoundX = _max(maxBoundX, x);
-          }
-          buffer_back[pos] = buffer[pos];
-        }
-        yield();
-       }
-
-       // If the minBoundY wasn't updated
-       // we can savely assume that buffer_back[pos] == buffer[pos]
-       // holdes true for all values of pos
-       if (minBoundY == ~0) return;
-
-       sendCommand(COLUMNADDR);
-       sendCommand(minBoundX);
-       sendCommand(maxBoundX);
-
-       sendCommand(PAGEADDR);
-       sendCommand(minBoundY);
-       sendCommand(maxBoundY);
-
-       digitalWrite(_cs, HIGH);
-       digitalWrite(_dc, HIGH);   // data mode
-       digitalWrite(_cs, LOW);
-       for (y = minBoundY; y <= maxBoundY; y++) {
-         for (x = minBoundX; x <= maxBoundX; x++) {
+       // Only the changed columns of the changed pages go on the bus
+       if (!updateDirty()) return;
+
+       for (uint8_t y = 0; y < (DISPLAY_HEIGHT / 8); y++) {
+         if (dirtyFirst[y] > dirtyLast[y]) continue;
+         sendCommand(COLUMNADDR);
+         sendCommand(dirtyFirst[y]);
+         sendCommand(dirtyLast[y]);
+
+         sendCommand(PAGEADDR);
+         sendCommand(y);
+         sendCommand(y);
+
+         digitalWrite(_cs, HIGH);
+         digitalWrite(_dc, HIGH);   // data mode
+         digitalWrite(_cs, LOW);
+         for (uint8_t x = dirtyFirst[y]; x <= dirtyLast[y]; x++) {
            SPI.transfer(buffer[x + y * DISPLAY_WIDTH]);
          }
+         digitalWrite(_cs, HIGH);
          yield();
        }
-       digitalWrite(_cs, HIGH);
      #else
        // No double buffering
        sendCommand(COLUMNADDR);
@@ -54,82 +54,27 @@ class SSD1306Wire : public OLEDDisplay {
 
     void display(void) {
       #ifdef OLEDDISPLAY_DOUBLE_BUFFER
-        uint8_t minBoundY = ~0;
-        uint8_t maxBoundY = 0;
-
-        uint8_t minBoundX = ~0;
-        uint8_t maxBoundX = 0;
-        uint8_t x, y;
-
-        // Calculate the Y bounding box of changes
-        // and copy buffer[pos] to buffer_back[pos];
-        for (y = 0; y < (DISPLAY_HEIGHT / 8); y++) {
-          for (x = 0; x < DISPLAY_WIDTH; x++) {
-           uint16_t pos = x + y * DISPLAY_WIDTH;
-           if (buffer[pos] != buffer_back[pos]) {
-             minBoundY = _min(minBoundY, y);
-             maxBoundY = _max(maxBoundY, y);
-             minBoundX = _min(minBoundX, x);
-             maxBoundX = _max(maxBoundX, x);
-           }
-           buffer_back[pos] = buffer[pos];
-         }
-         yield();
-        }
-
-        // If the minBoundY wasn't updated
-        // we can savely assume that buffer_back[pos] == buffer[pos]
-        // holdes true for all values of pos
-        if (minBoundY == ~0) return;
-
-        sendCommand(COLUMNADDR);
-        sendCommand(minBoundX);
-        sendCommand(maxBoundX);
-
-        sendCommand(PAGEADDR);
-        sendCommand(minBoundY);
-        sendCommand(maxBoundY);
-
-        byte k = 0;
-        for (y = minBoundY; y <= maxBoundY; y++) {
-          for (x = minBoundX; x <= maxBoundX; x++) {
-            if (k == 0) {
-              Wire.beginTransmission(_address);
-              Wire.write(0x40);
-            }
-            Wire.write(buffer[x + y * DISPLAY_WIDTH]);
-            k++;
-            if (k == 16)  {
-              Wire.endTransmission();
-              k = 0;
-            }
-          }
+        // Only the changed columns of the changed pages go on the bus
+        if (!updateDirty()) return;
+        uint32_t start = micros();
+        frameBytes = 0;
+
+        for (uint8_t y = 0; y < (DISPLAY_HEIGHT / 8); y++) {
+          if (dirtyFirst[y] > dirtyLast[y]) continue;
+          uint8_t window[] = {COLUMNADDR, dirtyFirst[y], dirtyLast[y], PAGEADDR, y, y};
+          sendCommands(window, sizeof(window));
+          sendData(buffer + y * DISPLAY_WIDTH + dirtyFirst[y], dirtyLast[y] - dirtyFirst[y] + 1);
           yield();
         }
-
-        if (k != 0) {
-          Wire.endTransmission();
-        }
+        frameMicros = micros() - start;
       #else
+        uint32_t start = micros();
+        frameBytes = 0;
 
-        sendCommand(COLUMNADDR);
-        sendCommand(0x0);
-        sendCommand(0x7F);
-
-        sendCommand(PAGEADDR);
-        sendCommand(0x0);
-        sendCommand(0x7);
-
-        for (uint16_t i=0; i < DISPLAY_BUFFER_SIZE; i++) {
-          Wire.beginTransmission(this->_address);
-          Wire.write(0x40);
-          for (uint8_t x = 0; x < 16; x++) {
-            Wire.write(buffer[i]);
-            i++;
-          }
-          i--;
-          Wire.endTransmission();
-        }
+        uint8_t window[] = {COLUMNADDR, 0x0, 0x7F, PAGEADDR, 0x0, 0x7};
+        sendCommands(window, sizeof(window));
+        sendData(buffer, DISPLAY_BUFFER_SIZE);
+        frameMicros = micros() - start;
       #endif
     }
 
@@ -139,6 +84,30 @@ class SSD1306Wire : public OLEDDisplay {
       Wire.write(0x80);
       Wire.write(command);
       Wire.endTransmission();
+      frameBytes += 3;
+    }
+
+    // Several commands in one transfer, control byte 0x00 = command stream
+    void sendCommands(const uint8_t *commands, uint8_t count) {
+      Wire.beginTransmission(_address);
+      Wire.write((uint8_t)0x00);
+      Wire.write(commands, count);
+      Wire.endTransmission();
+      frameBytes += count + 2;
+    }
+
+    // Display data in transfers of at most 16 bytes
+    void sendData(const uint8_t *data, uint16_t count) {
+      while (count) {
+        uint8_t k = count > 16 ? 16 : count;
+        Wire.beginTransmission(_address);
+        Wire.write(0x40);
+        Wire.write(data, k);
+        Wire.endTransmission();
+        frameBytes += k + 2;
+        data += k;
+        count -= k;
+      }
     }
 
 
@@ -33,96 +33,362 @@ Maintainer: Miguel Luis, Gregory Cristian and Wael Guibene
  *	OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  *
  *****************************************************************************/
-#if defined ESP8266 || defined ESP32
+#if defined ESP8266 || defined ESP32 || defined SX126X_TIMER_HOST
 #include "boards/mcu/timer.h"
+#ifdef SX126X_TIMER_HOST
+#include <stddef.h>
+#else
 #include "boards/mcu/board.h"
+#endif
+#ifdef ESP32
+#include <esp_timer.h>
+#endif
+
+/*
+ * All timer objects share one hardware backed alarm. Running timers are kept
+ * in a list sorted by their absolute deadline in us, linked through the Next
+ * field of the timer object itself, so there is no limit on the number of
+ * timers. The alarm is always armed for the head of the list.
+ *
+ * On the ESP32 the alarm is an esp_timer with ESP_TIMER_TASK dispatch, so the
+ * callbacks run in the esp_timer task and never in an interrupt. On the
+ * ESP8266 a single Ticker is used, which has ms resolution only.
+ * With SX126X_TIMER_HOST defined the clock is simulated and advanced with
+ * TimerHostAdvance(), to run the scheduler on a host for tests.
+ */
 
 extern "C"
 {
 
-	Ticker timerTickers[10];
-	uint32_t timerTimes[10];
-	bool timerInUse[10] = {false, false, false, false, false, false, false, false, false, false};
+#if defined ESP32
+	static portMUX_TYPE timerMux = portMUX_INITIALIZER_UNLOCKED;
+	static esp_timer_handle_t timerAlarm = NULL;
+#define TIMER_LOCK() portENTER_CRITICAL(&timerMux)
+#define TIMER_UNLOCK() portEXIT_CRITICAL(&timerMux)
+#elif defined ESP8266
+	static Ticker timerAlarm;
+#define TIMER_LOCK() noInterrupts()
+#define TIMER_UNLOCK() interrupts()
+#else
+	static uint64_t timerHostNow = 0;
+	static int64_t timerHostAlarm = -1;
+#define TIMER_LOCK()
+#define TIMER_UNLOCK()
+#endif
 
-	// External functions
+	static TimerEvent_t *timerListHead = NULL;
+	static uint32_t timerArmGen = 0; // Changes with the head of the list
+	static TimerStats_t timerStats;
+	static uint64_t timerLatencySum = 0;
 
-	void TimerConfig(void)
+	static void timerExpired(void *arg);
+
+	/**@brief Current time of the alarm clock in us
+ */
+	static int64_t timerNow(void)
 	{
-		/// \todo Nothing to do here for ESP32
+#if defined ESP32
+		return esp_timer_get_time();
+#elif defined ESP8266
+		return (int64_t)micros64();
+#else
+		return (int64_t)timerHostNow;
+#endif
 	}
 
-	void TimerInit(TimerEvent_t *obj, void (*callback)(void))
+	/**@brief Set the alarm to a deadline in us, -1 stops it, called unlocked
+ */
+	static void timerAlarmSet(int64_t deadline)
 	{
-		// Look for an available Ticker
-		for (int idx = 0; idx < 10; idx++)
+#if defined ESP32
+		if (timerAlarm == NULL)
+		{
+			return;
+		}
+		esp_timer_stop(timerAlarm);
+		if (deadline >= 0)
 		{
-			if (timerInUse[idx] == false)
+			int64_t wait = deadline - timerNow();
+			if (wait < 0)
 			{
-				timerInUse[idx] = true;
-				obj->timerNum = idx;
-				obj->Callback = callback;
-				return;
+				wait = 0;
 			}
+			esp_timer_start_once(timerAlarm, (uint64_t)wait);
 		}
-		/// \todo We run out of tickers, what do we do now???
+#elif defined ESP8266
+		timerAlarm.detach();
+		if (deadline >= 0)
+		{
+			int64_t wait = deadline - timerNow();
+			if (wait < 0)
+			{
+				wait = 0;
+			}
+			timerAlarm.once_ms((uint32_t)((wait + 999) / 1000), timerExpired, (void *)NULL);
+		}
+#else
+		timerHostAlarm = deadline;
+#endif
 	}
 
-	void timerCallback(TimerEvent_t *obj)
+	/**@brief Arm the alarm for the head of the list, must be called unlocked
+ *
+ * @details The deadline is taken under the lock, the alarm is set outside of
+ *          it because esp_timer_stop() and esp_timer_start_once() take locks
+ *          of their own. timerArmGen changes whenever the head of the list
+ *          changes. When it changed while the alarm was set, the deadline
+ *          used may be stale and the alarm is set again.
+ */
+	static void timerArm(void)
 	{
-		// Nothing to do here for the ESP32
+		uint32_t gen;
+		int64_t deadline;
+
+		TIMER_LOCK();
+		do
+		{
+			gen = timerArmGen;
+			deadline = (timerListHead != NULL) ? timerListHead->Deadline : -1;
+			TIMER_UNLOCK();
+			timerAlarmSet(deadline);
+			TIMER_LOCK();
+		} while (gen != timerArmGen);
+		TIMER_UNLOCK();
 	}
 
-	void TimerStart(TimerEvent_t *obj)
+	/**@brief Unlink a timer object from the list, must be called locked
+ *
+ * @retval true if the object was in the list
+ */
+	static bool timerRemove(TimerEvent_t *obj)
 	{
-		int idx = obj->timerNum;
-		if (obj->oneShot)
+		TimerEvent_t **cur = &timerListHead;
+		while (*cur != NULL)
 		{
-			timerTickers[idx].once_ms(timerTimes[idx], obj->Callback);
+			if (*cur == obj)
+			{
+				if (cur == &timerListHead)
+				{
+					timerArmGen++;
+				}
+				*cur = obj->Next;
+				obj->Next = NULL;
+				obj->IsRunning = false;
+				timerStats.active--;
+				return (true);
+			}
+			cur = &(*cur)->Next;
 		}
-		else
+		return (false);
+	}
+
+	/**@brief Link a timer object into the list by deadline, must be called locked
+ *
+ * @details Timers with the same deadline expire in the order they were started.
+ */
+	static void timerInsert(TimerEvent_t *obj)
+	{
+		TimerEvent_t **cur = &timerListHead;
+		while ((*cur != NULL) && ((*cur)->Deadline <= obj->Deadline))
 		{
-			timerTickers[idx].attach_ms(timerTimes[idx], obj->Callback);
+			cur = &(*cur)->Next;
 		}
+		if (cur == &timerListHead)
+		{
+			timerArmGen++;
+		}
+		obj->Next = *cur;
+		*cur = obj;
+		obj->IsRunning = true;
+		timerStats.active++;
 	}
 
-	void TimerStop(TimerEvent_t *obj)
+	/**@brief Alarm handler, calls every expired timer in deadline order
+ *
+ * @details The list is unlocked while a callback runs, callbacks may start
+ *          and stop timers, including their own.
+ */
+	static void timerExpired(void *arg)
 	{
-		int idx = obj->timerNum;
-		timerTickers[idx].detach();
+		(void)arg;
+		TIMER_LOCK();
+		while (timerListHead != NULL)
+		{
+			TimerEvent_t *obj = timerListHead;
+			int64_t now = timerNow();
+			if (obj->Deadline > now)
+			{
+				break;
+			}
+			timerRemove(obj);
+
+			uint32_t late = (uint32_t)(now - obj->Deadline);
+			timerStats.count++;
+			timerStats.last = late;
+			if (late > timerStats.max)
+			{
+				timerStats.max = late;
+			}
+			timerLatencySum += late;
+			timerStats.avg = (uint32_t)(timerLatencySum / timerStats.count);
+
+			if (!obj->oneShot && (obj->ReloadUs != 0))
+			{
+				// Keep the period, but skip ticks that are already lost
+				obj->Deadline += obj->ReloadUs;
+				if (obj->Deadline <= now)
+				{
+					obj->Deadline = now + obj->ReloadUs;
+				}
+				timerInsert(obj);
+			}
+
+			void (*callback)(void) = obj->Callback;
+			TIMER_UNLOCK();
+			if (callback != NULL)
+			{
+				callback();
+			}
+			TIMER_LOCK();
+		}
+		TIMER_UNLOCK();
+		timerArm();
 	}
 
-	void TimerReset(TimerEvent_t *obj)
+	// External functions
+
+	void TimerConfig(void)
+	{
+#if defined ESP32
+		if (timerAlarm == NULL)
+		{
+			esp_timer_create_args_t args = {};
+			args.callback = timerExpired;
+			args.arg = NULL;
+			args.dispatch_method = ESP_TIMER_TASK;
+			args.name = "sx126x";
+			esp_timer_create(&args, &timerAlarm);
+		}
+#endif
+	}
+
+	void TimerInit(TimerEvent_t *obj, void (*callback)(void))
+	{
+		TimerConfig();
+		TIMER_LOCK();
+		timerRemove(obj);
+		TIMER_UNLOCK();
+		obj->timerNum = 0;
+		obj->Timestamp = 0;
+		obj->ReloadValue = 0;
+		obj->ReloadUs = 0;
+		obj->Deadline = 0;
+		obj->IsRunning = false;
+		obj->Callback = callback;
+		obj->Next = NULL;
+	}
+
+	void timerCallback(TimerEvent_t *obj)
+	{
+		// Nothing to do here for the ESP32
+	}
+
+	void TimerStart(TimerEvent_t *obj)
 	{
-		int idx = obj->timerNum;
-		timerTickers[idx].detach();
-		if (obj->oneShot)
+		TIMER_LOCK();
+		uint32_t gen = timerArmGen;
+		timerRemove(obj);
+		obj->Deadline = timerNow() + obj->ReloadUs;
+		obj->Timestamp = (uint32_t)(obj->Deadline / 1000);
+		timerInsert(obj);
+		bool changed = (gen != timerArmGen);
+		TIMER_UNLOCK();
+		if (changed)
 		{
-			timerTickers[idx].once_ms(timerTimes[idx], obj->Callback);
+			timerArm();
 		}
-		else
+	}
+
+	void TimerStop(TimerEvent_t *obj)
+	{
+		TIMER_LOCK();
+		uint32_t gen = timerArmGen;
+		timerRemove(obj);
+		bool changed = (gen != timerArmGen);
+		TIMER_UNLOCK();
+		if (changed)
 		{
-			timerTickers[idx].attach_ms(timerTimes[idx], obj->Callback);
+			timerArm();
 		}
 	}
 
+	void TimerReset(TimerEvent_t *obj)
+	{
+		TimerStart(obj);
+	}
+
 	void TimerSetValue(TimerEvent_t *obj, uint32_t value)
 	{
-		int idx = obj->timerNum;
-		timerTimes[idx] = value;
+		TimerSetValueUs(obj, (uint64_t)value * 1000);
+	}
+
+	void TimerSetValueUs(TimerEvent_t *obj, uint64_t value)
+	{
+		TimerStop(obj);
+		obj->ReloadValue = (uint32_t)(value / 1000);
+		obj->ReloadUs = value;
 	}
 
 	TimerTime_t TimerGetCurrentTime(void)
 	{
-		return millis();
+		return (TimerTime_t)(timerNow() / 1000);
 	}
 
 	TimerTime_t TimerGetElapsedTime(TimerTime_t past)
 	{
-		uint32_t nowInTicks = millis();
+		uint32_t nowInTicks = TimerGetCurrentTime();
 		uint32_t pastInTicks = past;
 		TimerTime_t diff = nowInTicks - pastInTicks;
 
 		return diff;
 	}
+
+	uint64_t TimerGetCurrentTimeUs(void)
+	{
+		return (uint64_t)timerNow();
+	}
+
+	void TimerGetStats(TimerStats_t *stats)
+	{
+		TIMER_LOCK();
+		*stats = timerStats;
+		TIMER_UNLOCK();
+	}
+
+	void TimerResetStats(void)
+	{
+		TIMER_LOCK();
+		uint32_t active = timerStats.active;
+		timerStats = TimerStats_t();
+		timerStats.active = active;
+		timerLatencySum = 0;
+		TIMER_UNLOCK();
+	}
+
+#ifdef SX126X_TIMER_HOST
+	void TimerHostAdvance(uint64_t us)
+	{
+		uint64_t end = timerHostNow + us;
+		while ((timerHostAlarm >= 0) && ((uint64_t)timerHostAlarm <= end))
+		{
+			if ((uint64_t)timerHostAlarm > timerHostNow)
+			{
+				timerHostNow = (uint64_t)timerHostAlarm;
+			}
+			timerExpired(NULL);
+		}
+		timerHostNow = end;
+	}
+#endif
 };
-#endif
\ No newline at end of file
+#endif
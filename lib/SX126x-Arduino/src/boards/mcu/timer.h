@@ -39,7 +39,7 @@ Maintainer: Miguel Luis and Gregory Cristian
 
 #include "stdint.h"
 #include "stdbool.h"
-#if defined(ESP32) || defined(ESP8266)
+#if defined(ESP8266)
 #include <Ticker.h>
 #endif
 
@@ -60,8 +60,24 @@ extern "C"
 		bool IsRunning;			   /**< Is the timer currently running	*/
 		void (*Callback)(void);	/**< Timer IRQ callback function	*/
 		struct TimerEvent_s *Next; /**< Pointer to the next Timer object.	*/
+		uint64_t ReloadUs;		   /**< Timer delay value in us (ESP32) */
+		int64_t Deadline;		   /**< Absolute expiry time in us (ESP32) */
 	} TimerEvent_t;
 
+	/**@brief Dispatch statistics of the timer service
+ *
+ * @details Latency is the time between the deadline of a timer and the
+ *          moment its callback is called from the timer task.
+ */
+	typedef struct TimerStats_s
+	{
+		uint32_t count;  /**< Number of callbacks dispatched */
+		uint32_t last;   /**< Latency of the last dispatch in us */
+		uint32_t max;    /**< Worst dispatch latency in us */
+		uint32_t avg;    /**< Mean dispatch latency in us */
+		uint32_t active; /**< Number of timers currently running */
+	} TimerStats_t;
+
 /**@brief Timer time variable definition
  */
 #ifndef TimerTime_t
@@ -125,5 +141,40 @@ extern "C"
  * @retval current time in ms
  */
 	TimerTime_t TimerGetCurrentTime(void);
+
+	/**@brief Set timer new timeout value with microsecond resolution
+ *
+ * @param [IN] obj   Structure containing the timer object parameters
+ *
+ * @param [IN] value New timer timeout value in us
+ */
+	void TimerSetValueUs(TimerEvent_t *obj, uint64_t value);
+
+	/**@brief Read the current time of the timer service
+ *
+ * @retval current time in us
+ */
+	uint64_t TimerGetCurrentTimeUs(void);
+
+	/**@brief Copy the dispatch statistics of the timer service
+ *
+ * @param [OUT] stats Structure receiving the statistics
+ */
+	void TimerGetStats(TimerStats_t *stats);
+
+	/**@brief Clear the dispatch statistics of the timer service
+ */
+	void TimerResetStats(void);
+
+#ifdef SX126X_TIMER_HOST
+	/**@brief Advance the simulated clock of the host build
+ *
+ * @details Dispatches every timer that expires within the step, in
+ *          deadline order, from the calling thread.
+ *
+ * @param [IN] us Time to advance in us
+ */
+	void TimerHostAdvance(uint64_t us);
+#endif
 };
 #endif // __TIMER_H__
@@ -40,10 +40,164 @@ Maintainer: Miguel Luis and Gregory Cristian
 #include "boards/mcu/spi_board.h"
 #include "radio/sx126x/sx126x.h"
 #include "sx126x-board.h"
+#ifdef ESP32
+#include "soc/gpio_reg.h"
+#endif
+
+/* SPI clock of the radio, the SX126x allows up to 16 MHz.
+ * Can be set with a build flag, e.g. -DSX126X_SPI_FREQ=16000000 */
+#ifndef SX126X_SPI_FREQ
+#define SX126X_SPI_FREQ 8000000
+#endif
+
+/* BUSY is polled this long before the wait blocks on the pin interrupt.
+ * Commands release BUSY within a few us, calibration, image calibration
+ * and wakeup from sleep take milliseconds. */
+#ifndef SX126X_BUSY_SPIN_US
+#define SX126X_BUSY_SPIN_US 200
+#endif
+
+/* Give up waiting for BUSY after this time */
+#define SX126X_BUSY_TIMEOUT_MS 1000
 
 extern "C"
 {
-	SPISettings spiSettings = SPISettings(2000000, MSBFIRST, SPI_MODE0);
+	SPISettings spiSettings = SPISettings(SX126X_SPI_FREQ, MSBFIRST, SPI_MODE0);
+
+	// Time spent in SPI transactions, see SX126xGetSpiStats()
+	static uint32_t spiUs = 0;
+	static uint32_t spiCalls = 0;
+
+	/*!
+	 * Clock out size bytes, the received bytes are ignored
+	 */
+	static void SX126xSpiWrite(const uint8_t *buffer, uint16_t size)
+	{
+#if defined ESP8266 || defined ESP32
+		SPI_LORA.writeBytes((uint8_t *)buffer, size);
+#elif defined NRF52
+		SPI_LORA.transfer(buffer, NULL, size);
+#else
+		for (uint16_t i = 0; i < size; i++)
+		{
+			SPI_LORA.transfer(buffer[i]);
+		}
+#endif
+	}
+
+	/*!
+	 * One complete SPI transaction with the radio: NSS low, the header
+	 * (opcode, address and status byte), then size bytes from tx or into rx,
+	 * NSS high. The bytes are handed to the SPI driver as blocks, it moves
+	 * them through the FIFO without one call per byte.
+	 * The caller waits for BUSY before. Writes also wait after, reads
+	 * leave that to the next transaction, which waits first anyway.
+	 */
+	static void SX126xSpi(const uint8_t *hdr, uint8_t hdrLen, const uint8_t *tx, uint8_t *rx, uint16_t size)
+	{
+		uint32_t start = micros();
+
+		digitalWrite(_hwConfig.PIN_LORA_NSS, LOW);
+		SPI_LORA.beginTransaction(spiSettings);
+
+		SX126xSpiWrite(hdr, hdrLen);
+		if (rx != NULL)
+		{
+			// Send NOPs, the radio ignores MOSI while it sends data
+			memset(rx, 0x00, size);
+			SPI_LORA.transfer(rx, size);
+		}
+		else if (size > 0)
+		{
+			SX126xSpiWrite(tx, size);
+		}
+
+		SPI_LORA.endTransaction();
+		digitalWrite(_hwConfig.PIN_LORA_NSS, HIGH);
+
+		spiUs += micros() - start;
+		spiCalls++;
+	}
+
+	void SX126xGetSpiStats(uint32_t *us, uint32_t *calls)
+	{
+		*us = spiUs;
+		*calls = spiCalls;
+	}
+
+	// Time spent waiting on BUSY, see SX126xGetBusyStats()
+	static uint32_t busyUs = 0;
+	static uint32_t busyWaits = 0;
+	static uint32_t busyTimeouts = 0;
+
+#ifdef ESP32
+	// Input register and mask of the BUSY pin, set in SX126xIoInit()
+	static uint32_t busyReg = GPIO_IN_REG;
+	static uint32_t busyMask = 0;
+	static SemaphoreHandle_t busySem = NULL;
+
+	static void IRAM_ATTR SX126xBusyIsr(void)
+	{
+		BaseType_t woken = pdFALSE;
+		xSemaphoreGiveFromISR(busySem, &woken);
+		if (woken == pdTRUE)
+		{
+			portYIELD_FROM_ISR();
+		}
+	}
+#endif
+
+	/*!
+	 * State of the BUSY pin, a single register read on ESP32
+	 */
+	static inline bool SX126xBusy(void)
+	{
+#ifdef ESP32
+		return ((REG_READ(busyReg) & busyMask) != 0);
+#else
+		return (digitalRead(_hwConfig.PIN_LORA_BUSY) == HIGH);
+#endif
+	}
+
+	/*!
+	 * Wait for BUSY low without spinning, for the long operations.
+	 * On ESP32 the task sleeps on a semaphore given by the falling edge
+	 * of BUSY. In an ISR, before the scheduler runs and on the other MCUs
+	 * it falls back to polling every ms.
+	 * Returns false on timeout
+	 */
+	static bool SX126xBusyBlock(void)
+	{
+#ifdef ESP32
+		if ((busySem != NULL) && !xPortInIsrContext() && (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING))
+		{
+			// Drop an edge left over from an earlier wait
+			xSemaphoreTake(busySem, 0);
+			attachInterrupt(_hwConfig.PIN_LORA_BUSY, SX126xBusyIsr, FALLING);
+			// BUSY may have dropped before the interrupt was armed
+			bool ready = !SX126xBusy() || (xSemaphoreTake(busySem, pdMS_TO_TICKS(SX126X_BUSY_TIMEOUT_MS)) == pdTRUE) || !SX126xBusy();
+			detachInterrupt(_hwConfig.PIN_LORA_BUSY);
+			return ready;
+		}
+#endif
+		uint32_t start = millis();
+		while (SX126xBusy())
+		{
+			if ((millis() - start) > SX126X_BUSY_TIMEOUT_MS)
+			{
+				return false;
+			}
+			delay(1);
+		}
+		return true;
+	}
+
+	void SX126xGetBusyStats(uint32_t *us, uint32_t *waits, uint32_t *timeouts)
+	{
+		*us = busyUs;
+		*waits = busyWaits;
+		*timeouts = busyTimeouts;
+	}
 
 	// No need to initialize DIO3 as output everytime, do it once and remember it
 	bool dio3IsOutput = false;
@@ -58,6 +212,24 @@ extern "C"
 		pinMode(_hwConfig.PIN_LORA_NSS, OUTPUT);
 		digitalWrite(_hwConfig.PIN_LORA_NSS, HIGH);
 		pinMode(_hwConfig.PIN_LORA_BUSY, INPUT);
+#ifdef ESP32
+#ifdef GPIO_IN1_REG
+		if (_hwConfig.PIN_LORA_BUSY >= 32)
+		{
+			busyReg = GPIO_IN1_REG;
+			busyMask = 1UL << (_hwConfig.PIN_LORA_BUSY - 32);
+		}
+		else
+#endif
+		{
+			busyReg = GPIO_IN_REG;
+			busyMask = 1UL << _hwConfig.PIN_LORA_BUSY;
+		}
+		if (busySem == NULL)
+		{
+			busySem = xSemaphoreCreateBinary();
+		}
+#endif
 		pinMode(_hwConfig.PIN_LORA_DIO_1, INPUT);
 		pinMode(_hwConfig.PIN_LORA_RESET, OUTPUT);
 		digitalWrite(_hwConfig.PIN_LORA_RESET, HIGH);
@@ -92,27 +264,37 @@ extern "C"
 		digitalWrite(_hwConfig.PIN_LORA_RESET, HIGH);
 		delay(10);
 		dio3IsOutput = false;
+		SX126xShadowInvalidate();
 	}
 
-	void SX126xWaitOnBusy(void)
+	bool SX126xWaitOnBusy(void)
 	{
-		int timeout = 1000;
-		while (digitalRead(_hwConfig.PIN_LORA_BUSY) == HIGH)
+		uint32_t start = micros();
+		bool ready = true;
+
+		// Spin on the input register for the short waits
+		while (SX126xBusy())
 		{
-			delay(1);
-			timeout -= 1;
-			if (timeout < 0)
+			if ((micros() - start) >= SX126X_BUSY_SPIN_US)
 			{
-/// \todo This error should be reported to the main app
+				ready = SX126xBusyBlock();
+				break;
+			}
+		}
+
+		busyUs += micros() - start;
+		busyWaits++;
+		if (!ready)
+		{
+			busyTimeouts++;
 #ifdef ESP32
-				log_e("LORA Busy timeout waiting for BUSY low");
+			log_e("LORA Busy timeout waiting for BUSY low");
 #endif
 #ifdef NRF52
-				LOG_LV2("LORA", "[SX126xWaitOnBusy] Timeout waiting for BUSY low");
+			LOG_LV2("LORA", "[SX126xWaitOnBusy] Timeout waiting for BUSY low");
 #endif
-				return;
-			}
 		}
+		return ready;
 	}
 
 	void SX126xWakeup(void)
@@ -126,74 +308,210 @@ extern "C"
 		SPI_LORA.endTransaction();
 		digitalWrite(_hwConfig.PIN_LORA_NSS, HIGH);
 
-		// Wait for chip to be ready.
-		SX126xWaitOnBusy();
-
 		BoardEnableIrq();
+
+		// Wait for chip to be ready, outside the critical section as the
+		// wakeup takes milliseconds and the wait may block.
+		SX126xWaitOnBusy();
 	}
 
-	void SX126xWriteCommand(RadioCommands_t command, uint8_t *buffer, uint16_t size)
+	/*!
+	 * Write-through shadow of the configuration the chip holds. A command
+	 * from this table whose parameters match the last ones sent is not sent
+	 * again. reg is a register the chip rewrites itself when it executes
+	 * the command, its shadow is dropped when the command is sent.
+	 */
+	typedef struct
 	{
-		SX126xCheckDeviceReady();
-
-		digitalWrite(_hwConfig.PIN_LORA_NSS, LOW);
+		uint8_t opcode;
+		uint16_t reg;
+		uint8_t size; // 0 while unknown
+		uint8_t buf[9];
+	} SX126xCmdShadow_t;
+
+	static SX126xCmdShadow_t cmdShadow[] = {
+		{RADIO_SET_PACKETTYPE, 0, 0, {0}},
+		{RADIO_SET_MODULATIONPARAMS, 0, 0, {0}},
+		{RADIO_SET_PACKETPARAMS, 0x0736, 0, {0}},
+		{RADIO_SET_RFFREQUENCY, 0, 0, {0}},
+		{RADIO_CFG_DIOIRQ, 0, 0, {0}},
+		{RADIO_SET_TXPARAMS, 0, 0, {0}},
+		{RADIO_SET_PACONFIG, REG_OCP, 0, {0}},
+		{RADIO_SET_BUFFERBASEADDRESS, 0, 0, {0}},
+		{RADIO_SET_REGULATORMODE, 0, 0, {0}},
+		{RADIO_SET_RFSWITCHMODE, 0, 0, {0}},
+		{RADIO_SET_STOPRXTIMERONPREAMBLE, 0, 0, {0}},
+		{RADIO_SET_LORASYMBTIMEOUT, 0, 0, {0}},
+	};
+
+	/*!
+	 * Registers whose value is known after the first read or write. Reads
+	 * of them are answered from here. Writes of an unchanged value are
+	 * skipped unless always is set (0x0944 clears an event when written).
+	 */
+	typedef struct
+	{
+		uint16_t addr;
+		bool always;
+		bool valid;
+		uint8_t value;
+	} SX126xRegShadow_t;
+
+	static SX126xRegShadow_t regShadow[] = {
+		{REG_LR_SYNCWORD, false, false, 0},
+		{REG_LR_SYNCWORD + 1, false, false, 0},
+		{0x0736, false, false, 0}, // RegIqPolaritySetup
+		{0x08D8, false, false, 0}, // RegTxClampConfig
+		{REG_RX_GAIN, false, false, 0},
+		{REG_OCP, false, false, 0},
+		{0x0944, true, false, 0}, // RegEventMask
+	};
+
+#define SHADOW_CMDS (sizeof(cmdShadow) / sizeof(cmdShadow[0]))
+#define SHADOW_REGS (sizeof(regShadow) / sizeof(regShadow[0]))
+
+	// Transactions saved by the shadow, see SX126xGetShadowStats()
+	static uint32_t shadowCmds = 0;
+	static uint32_t shadowRegs = 0;
+
+	void SX126xShadowInvalidate(void)
+	{
+		for (uint8_t i = 0; i < SHADOW_CMDS; i++)
+		{
+			cmdShadow[i].size = 0;
+		}
+		for (uint8_t i = 0; i < SHADOW_REGS; i++)
+		{
+			regShadow[i].valid = false;
+		}
+	}
 
-		SPI_LORA.beginTransaction(spiSettings);
-		SPI_LORA.transfer((uint8_t)command);
+	void SX126xGetShadowStats(uint32_t *cmds, uint32_t *regs)
+	{
+		*cmds = shadowCmds;
+		*regs = shadowRegs;
+	}
 
-		for (uint16_t i = 0; i < size; i++)
+	static SX126xRegShadow_t *SX126xRegFind(uint16_t address)
+	{
+		for (uint8_t i = 0; i < SHADOW_REGS; i++)
 		{
-			SPI_LORA.transfer(buffer[i]);
+			if (regShadow[i].addr == address)
+			{
+				return &regShadow[i];
+			}
 		}
+		return NULL;
+	}
 
-		SPI_LORA.endTransaction();
-		digitalWrite(_hwConfig.PIN_LORA_NSS, HIGH);
+	/*!
+	 * Checks a command against the shadow and records it.
+	 * Returns true if the chip already holds these parameters.
+	 */
+	static bool SX126xCmdCached(uint8_t command, const uint8_t *buffer, uint16_t size)
+	{
+		switch (command)
+		{
+		case RADIO_SET_SLEEP:
+		case RADIO_SET_RXDUTYCYCLE:
+		case RADIO_CALIBRATE:
+			// Retention and calibration may not keep everything
+			SX126xShadowInvalidate();
+			return false;
+		default:
+			break;
+		}
 
-		if (command != RADIO_SET_SLEEP)
+		for (uint8_t i = 0; i < SHADOW_CMDS; i++)
 		{
-			SX126xWaitOnBusy();
+			SX126xCmdShadow_t *c = &cmdShadow[i];
+			if (c->opcode != command)
+			{
+				continue;
+			}
+			// In sleep or RX duty cycle the command must still wake the chip
+			if ((c->size == size) && (memcmp(c->buf, buffer, size) == 0) &&
+				(SX126xGetOperatingMode() != MODE_SLEEP) && (SX126xGetOperatingMode() != MODE_RX_DC))
+			{
+				shadowCmds++;
+				return true;
+			}
+			if ((command == RADIO_SET_PACKETTYPE) && (c->size != 0))
+			{
+				// Switching modems resets the modem settings and sync words
+				SX126xShadowInvalidate();
+			}
+			if (size <= sizeof(c->buf))
+			{
+				memcpy(c->buf, buffer, size);
+				c->size = size;
+			}
+			if (c->reg != 0)
+			{
+				SX126xRegShadow_t *r = SX126xRegFind(c->reg);
+				if (r != NULL)
+				{
+					r->valid = false;
+				}
+			}
+			return false;
 		}
+		return false;
 	}
 
-	void SX126xReadCommand(RadioCommands_t command, uint8_t *buffer, uint16_t size)
+	void SX126xWriteCommand(RadioCommands_t command, uint8_t *buffer, uint16_t size)
 	{
-		SX126xCheckDeviceReady();
+		uint8_t hdr[1] = {(uint8_t)command};
 
-		digitalWrite(_hwConfig.PIN_LORA_NSS, LOW);
-
-		SPI_LORA.beginTransaction(spiSettings);
-		SPI_LORA.transfer((uint8_t)command);
-		SPI_LORA.transfer(0x00);
-		for (uint16_t i = 0; i < size; i++)
+		if (SX126xCmdCached(command, buffer, size))
 		{
-			buffer[i] = SPI_LORA.transfer(0x00);
+			return;
 		}
 
-		SPI_LORA.endTransaction();
-		digitalWrite(_hwConfig.PIN_LORA_NSS, HIGH);
+		SX126xCheckDeviceReady();
+		SX126xSpi(hdr, 1, buffer, NULL, size);
 
-		SX126xWaitOnBusy();
+		if (command != RADIO_SET_SLEEP)
+		{
+			SX126xWaitOnBusy();
+		}
 	}
 
-	void SX126xWriteRegisters(uint16_t address, uint8_t *buffer, uint16_t size)
+	void SX126xReadCommand(RadioCommands_t command, uint8_t *buffer, uint16_t size)
 	{
-		SX126xCheckDeviceReady();
+		uint8_t hdr[2] = {(uint8_t)command, 0x00};
 
-		digitalWrite(_hwConfig.PIN_LORA_NSS, LOW);
+		SX126xCheckDeviceReady();
+		SX126xSpi(hdr, 2, NULL, buffer, size);
+	}
 
-		SPI_LORA.beginTransaction(spiSettings);
-		SPI_LORA.transfer(RADIO_WRITE_REGISTER);
-		SPI_LORA.transfer((address & 0xFF00) >> 8);
-		SPI_LORA.transfer(address & 0x00FF);
+	void SX126xWriteRegisters(uint16_t address, uint8_t *buffer, uint16_t size)
+	{
+		uint8_t hdr[3] = {RADIO_WRITE_REGISTER, (uint8_t)(address >> 8), (uint8_t)address};
 
+		if (size == 1)
+		{
+			SX126xRegShadow_t *r = SX126xRegFind(address);
+			if ((r != NULL) && r->valid && !r->always && (r->value == buffer[0]) &&
+				(SX126xGetOperatingMode() != MODE_SLEEP) && (SX126xGetOperatingMode() != MODE_RX_DC))
+			{
+				shadowRegs++;
+				return;
+			}
+		}
+		// Write-through, also for the registers of a block write
 		for (uint16_t i = 0; i < size; i++)
 		{
-			SPI_LORA.transfer(buffer[i]);
+			SX126xRegShadow_t *r = SX126xRegFind(address + i);
+			if (r != NULL)
+			{
+				r->value = buffer[i];
+				r->valid = true;
+			}
 		}
 
-		SPI_LORA.endTransaction();
-		digitalWrite(_hwConfig.PIN_LORA_NSS, HIGH);
-
+		SX126xCheckDeviceReady();
+		SX126xSpi(hdr, 3, buffer, NULL, size);
 		SX126xWaitOnBusy();
 	}
 
@@ -204,23 +522,28 @@ extern "C"
 
 	void SX126xReadRegisters(uint16_t address, uint8_t *buffer, uint16_t size)
 	{
-		SX126xCheckDeviceReady();
-
-		digitalWrite(_hwConfig.PIN_LORA_NSS, LOW);
+		uint8_t hdr[4] = {RADIO_READ_REGISTER, (uint8_t)(address >> 8), (uint8_t)address, 0x00};
+		SX126xRegShadow_t *r = NULL;
 
-		SPI_LORA.beginTransaction(spiSettings);
-		SPI_LORA.transfer(RADIO_READ_REGISTER);
-		SPI_LORA.transfer((address & 0xFF00) >> 8);
-		SPI_LORA.transfer(address & 0x00FF);
-		SPI_LORA.transfer(0x00);
-		for (uint16_t i = 0; i < size; i++)
+		if (size == 1)
 		{
-			buffer[i] = SPI_LORA.transfer(0x00);
+			r = SX126xRegFind(address);
+			if ((r != NULL) && r->valid)
+			{
+				buffer[0] = r->value;
+				shadowRegs++;
+				return;
+			}
 		}
-		SPI_LORA.endTransaction();
-		digitalWrite(_hwConfig.PIN_LORA_NSS, HIGH);
 
-		SX126xWaitOnBusy();
+		SX126xCheckDeviceReady();
+		SX126xSpi(hdr, 4, NULL, buffer, size);
+
+		if (r != NULL)
+		{
+			r->value = buffer[0];
+			r->valid = true;
+		}
 	}
 
 	uint8_t SX126xReadRegister(uint16_t address)
@@ -232,41 +555,19 @@ extern "C"
 
 	void SX126xWriteBuffer(uint8_t offset, uint8_t *buffer, uint8_t size)
 	{
-		SX126xCheckDeviceReady();
-
-		digitalWrite(_hwConfig.PIN_LORA_NSS, LOW);
-
-		SPI_LORA.beginTransaction(spiSettings);
-		SPI_LORA.transfer(RADIO_WRITE_BUFFER);
-		SPI_LORA.transfer(offset);
-		for (uint16_t i = 0; i < size; i++)
-		{
-			SPI_LORA.transfer(buffer[i]);
-		}
-		SPI_LORA.endTransaction();
-		digitalWrite(_hwConfig.PIN_LORA_NSS, HIGH);
+		uint8_t hdr[2] = {RADIO_WRITE_BUFFER, offset};
 
+		SX126xCheckDeviceReady();
+		SX126xSpi(hdr, 2, buffer, NULL, size);
 		SX126xWaitOnBusy();
 	}
 
 	void SX126xReadBuffer(uint8_t offset, uint8_t *buffer, uint8_t size)
 	{
-		SX126xCheckDeviceReady();
+		uint8_t hdr[3] = {RADIO_READ_BUFFER, offset, 0x00};
 
-		digitalWrite(_hwConfig.PIN_LORA_NSS, LOW);
-
-		SPI_LORA.beginTransaction(spiSettings);
-		SPI_LORA.transfer(RADIO_READ_BUFFER);
-		SPI_LORA.transfer(offset);
-		SPI_LORA.transfer(0x00);
-		for (uint16_t i = 0; i < size; i++)
-		{
-			buffer[i] = SPI_LORA.transfer(0x00);
-		}
-		SPI_LORA.endTransaction();
-		digitalWrite(_hwConfig.PIN_LORA_NSS, HIGH);
-
-		SX126xWaitOnBusy();
+		SX126xCheckDeviceReady();
+		SX126xSpi(hdr, 3, NULL, buffer, size);
 	}
 
 	void SX126xSetRfTxPower(int8_t power)
@@ -286,173 +587,50 @@ extern "C"
 		}
 	}
 
-	static void SX126xDio3Control(bool state)
+	/*!
+	 * Register access for SX126xDio3Control(). It must not go through
+	 * SX126xCheckDeviceReady(), that switches the antenna itself.
+	 */
+	static uint8_t SX126xDio3Read(uint16_t address)
 	{
-		uint8_t reg_0x0580;
-		uint8_t reg_0x0583;
-		uint8_t reg_0x0584;
-		uint8_t reg_0x0585;
-		uint8_t reg_0x0920;
+		uint8_t hdr[4] = {RADIO_READ_REGISTER, (uint8_t)(address >> 8), (uint8_t)address, 0x00};
+		uint8_t value;
 
+		SX126xWaitOnBusy();
+		SX126xSpi(hdr, 4, NULL, &value, 1);
+		return value;
+	}
+
+	static void SX126xDio3Write(uint16_t address, uint8_t value)
+	{
+		uint8_t hdr[3] = {RADIO_WRITE_REGISTER, (uint8_t)(address >> 8), (uint8_t)address};
+
+		SX126xWaitOnBusy();
+		SX126xSpi(hdr, 3, &value, NULL, 1);
+	}
+
+	static void SX126xDio3Control(bool state)
+	{
 		if (!dio3IsOutput)
 		{
 			// Configure DIO3 as output
+			uint8_t reg_0x0580 = SX126xDio3Read(0x0580);
+			uint8_t reg_0x0583 = SX126xDio3Read(0x0583);
+			uint8_t reg_0x0584 = SX126xDio3Read(0x0584);
+			uint8_t reg_0x0585 = SX126xDio3Read(0x0585);
 
-			// Read 0x0580
-			SX126xWaitOnBusy();
-			digitalWrite(_hwConfig.PIN_LORA_NSS, LOW);
-			SPI_LORA.beginTransaction(spiSettings);
-			SPI_LORA.transfer(RADIO_READ_REGISTER);
-			SPI_LORA.transfer((0x0580 & 0xFF00) >> 8);
-			SPI_LORA.transfer(0x0580 & 0x00FF);
-			SPI_LORA.transfer(0x00);
-			reg_0x0580 = SPI_LORA.transfer(0x00);
-			SPI_LORA.endTransaction();
-			digitalWrite(_hwConfig.PIN_LORA_NSS, HIGH);
-
-			// Read 0x0583
-			SX126xWaitOnBusy();
-			digitalWrite(_hwConfig.PIN_LORA_NSS, LOW);
-			SPI_LORA.beginTransaction(spiSettings);
-			SPI_LORA.transfer(RADIO_READ_REGISTER);
-			SPI_LORA.transfer((0x0583 & 0xFF00) >> 8);
-			SPI_LORA.transfer(0x0583 & 0x00FF);
-			SPI_LORA.transfer(0x00);
-			reg_0x0583 = SPI_LORA.transfer(0x00);
-			SPI_LORA.endTransaction();
-			digitalWrite(_hwConfig.PIN_LORA_NSS, HIGH);
-
-			// Read 0x0584
-			SX126xWaitOnBusy();
-			digitalWrite(_hwConfig.PIN_LORA_NSS, LOW);
-			SPI_LORA.beginTransaction(spiSettings);
-			SPI_LORA.transfer(RADIO_READ_REGISTER);
-			SPI_LORA.transfer((0x0584 & 0xFF00) >> 8);
-			SPI_LORA.transfer(0x0584 & 0x00FF);
-			SPI_LORA.transfer(0x00);
-			reg_0x0584 = SPI_LORA.transfer(0x00);
-			SPI_LORA.endTransaction();
-			digitalWrite(_hwConfig.PIN_LORA_NSS, HIGH);
-
-			// Read 0x0585
-			SX126xWaitOnBusy();
-			digitalWrite(_hwConfig.PIN_LORA_NSS, LOW);
-			SPI_LORA.beginTransaction(spiSettings);
-			SPI_LORA.transfer(RADIO_READ_REGISTER);
-			SPI_LORA.transfer((0x0585 & 0xFF00) >> 8);
-			SPI_LORA.transfer(0x0585 & 0x00FF);
-			SPI_LORA.transfer(0x00);
-			reg_0x0585 = SPI_LORA.transfer(0x00);
-			SPI_LORA.endTransaction();
-			digitalWrite(_hwConfig.PIN_LORA_NSS, HIGH);
-
-			// Write 0x0580
-			// SX126xWriteRegister(0x0580, reg_0x0580 | 0x08);
-			SX126xWaitOnBusy();
-			digitalWrite(_hwConfig.PIN_LORA_NSS, LOW);
-			SPI_LORA.beginTransaction(spiSettings);
-			SPI_LORA.transfer(RADIO_WRITE_REGISTER);
-			SPI_LORA.transfer((0x0580 & 0xFF00) >> 8);
-			SPI_LORA.transfer(0x0580 & 0x00FF);
-			SPI_LORA.transfer(reg_0x0580 | 0x08);
-			SPI_LORA.endTransaction();
-			digitalWrite(_hwConfig.PIN_LORA_NSS, HIGH);
-
-			// Write 0x0583
-			SX126xWaitOnBusy();
-			digitalWrite(_hwConfig.PIN_LORA_NSS, LOW);
-			SPI_LORA.beginTransaction(spiSettings);
-			SPI_LORA.transfer(RADIO_WRITE_REGISTER);
-			SPI_LORA.transfer((0x0583 & 0xFF00) >> 8);
-			SPI_LORA.transfer(0x0583 & 0x00FF);
-			SPI_LORA.transfer(reg_0x0583 & ~0x08);
-			SPI_LORA.endTransaction();
-			digitalWrite(_hwConfig.PIN_LORA_NSS, HIGH);
-
-			// Write 0x0584
-			SX126xWaitOnBusy();
-			digitalWrite(_hwConfig.PIN_LORA_NSS, LOW);
-			SPI_LORA.beginTransaction(spiSettings);
-			SPI_LORA.transfer(RADIO_WRITE_REGISTER);
-			SPI_LORA.transfer((0x0584 & 0xFF00) >> 8);
-			SPI_LORA.transfer(0x0584 & 0x00FF);
-			SPI_LORA.transfer(reg_0x0584 & ~0x08);
-			SPI_LORA.endTransaction();
-			digitalWrite(_hwConfig.PIN_LORA_NSS, HIGH);
-
-			// Write 0x0585
-			SX126xWaitOnBusy();
-			digitalWrite(_hwConfig.PIN_LORA_NSS, LOW);
-			SPI_LORA.beginTransaction(spiSettings);
-			SPI_LORA.transfer(RADIO_WRITE_REGISTER);
-			SPI_LORA.transfer((0x0585 & 0xFF00) >> 8);
-			SPI_LORA.transfer(0x0585 & 0x00FF);
-			SPI_LORA.transfer(reg_0x0585 & ~0x08);
-			SPI_LORA.endTransaction();
-			digitalWrite(_hwConfig.PIN_LORA_NSS, HIGH);
-
-			// Write 0x0920
-			SX126xWaitOnBusy();
-			digitalWrite(_hwConfig.PIN_LORA_NSS, LOW);
-			SPI_LORA.beginTransaction(spiSettings);
-			SPI_LORA.transfer(RADIO_WRITE_REGISTER);
-			SPI_LORA.transfer((0x0920 & 0xFF00) >> 8);
-			SPI_LORA.transfer(0x0920 & 0x00FF);
-			SPI_LORA.transfer(0x06);
-			SPI_LORA.endTransaction();
-			digitalWrite(_hwConfig.PIN_LORA_NSS, HIGH);
+			SX126xDio3Write(0x0580, reg_0x0580 | 0x08);
+			SX126xDio3Write(0x0583, reg_0x0583 & ~0x08);
+			SX126xDio3Write(0x0584, reg_0x0584 & ~0x08);
+			SX126xDio3Write(0x0585, reg_0x0585 & ~0x08);
+			SX126xDio3Write(0x0920, 0x06);
 
 			dio3IsOutput = true;
 		}
 
-		if (state)
-		{
-			// Set DIO3 High
-			SX126xWaitOnBusy();
-			digitalWrite(_hwConfig.PIN_LORA_NSS, LOW);
-			SPI_LORA.beginTransaction(spiSettings);
-			SPI_LORA.transfer(RADIO_READ_REGISTER);
-			SPI_LORA.transfer((0x0920 & 0xFF00) >> 8);
-			SPI_LORA.transfer(0x0920 & 0x00FF);
-			SPI_LORA.transfer(0x00);
-			reg_0x0920 = SPI_LORA.transfer(0x00);
-			SPI_LORA.endTransaction();
-			digitalWrite(_hwConfig.PIN_LORA_NSS, HIGH);
-
-			SX126xWaitOnBusy();
-			digitalWrite(_hwConfig.PIN_LORA_NSS, LOW);
-			SPI_LORA.beginTransaction(spiSettings);
-			SPI_LORA.transfer(RADIO_WRITE_REGISTER);
-			SPI_LORA.transfer((0x0920 & 0xFF00) >> 8);
-			SPI_LORA.transfer(0x0920 & 0x00FF);
-			SPI_LORA.transfer(reg_0x0920 | 0x08);
-			SPI_LORA.endTransaction();
-			digitalWrite(_hwConfig.PIN_LORA_NSS, HIGH);
-		}
-		else
-		{
-			// Set DIO3 Low
-			SX126xWaitOnBusy();
-			digitalWrite(_hwConfig.PIN_LORA_NSS, LOW);
-			SPI_LORA.beginTransaction(spiSettings);
-			SPI_LORA.transfer(RADIO_READ_REGISTER);
-			SPI_LORA.transfer((0x0920 & 0xFF00) >> 8);
-			SPI_LORA.transfer(0x0920 & 0x00FF);
-			SPI_LORA.transfer(0x00);
-			reg_0x0920 = SPI_LORA.transfer(0x00);
-			SPI_LORA.endTransaction();
-			digitalWrite(_hwConfig.PIN_LORA_NSS, HIGH);
-
-			SX126xWaitOnBusy();
-			digitalWrite(_hwConfig.PIN_LORA_NSS, LOW);
-			SPI_LORA.beginTransaction(spiSettings);
-			SPI_LORA.transfer(RADIO_WRITE_REGISTER);
-			SPI_LORA.transfer((0x0920 & 0xFF00) >> 8);
-			SPI_LORA.transfer(0x0920 & 0x00FF);
-			SPI_LORA.transfer(reg_0x0920 & ~0x08);
-			SPI_LORA.endTransaction();
-			digitalWrite(_hwConfig.PIN_LORA_NSS, HIGH);
-		}
+		// Set DIO3 high or low
+		uint8_t reg_0x0920 = SX126xDio3Read(0x0920);
+		SX126xDio3Write(0x0920, state ? (reg_0x0920 | 0x08) : (reg_0x0920 & ~0x08));
 	}
 
 	void SX126xAntSwOn(void)
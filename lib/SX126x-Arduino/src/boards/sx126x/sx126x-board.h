@@ -63,8 +63,13 @@ extern "C"
 	void SX126xReset(void);
 
 	/**@brief Blocking loop to wait while the Busy pin in high
+ *
+ * Polls the pin for SX126X_BUSY_SPIN_US, then sleeps on the BUSY
+ * interrupt (ESP32) until the pin drops or the 1 s timeout.
+ *
+ * \retval      ready         false if BUSY did not go low in time
  */
-	void SX126xWaitOnBusy(void);
+	bool SX126xWaitOnBusy(void);
 
 	/**@brief Wakes up the radio
  */
@@ -101,6 +106,34 @@ extern "C"
  */
 	uint8_t SX126xReadRegister(uint16_t address);
 
+	/**@brief Time spent in SPI transactions with the radio since boot
+ *
+ * \param [out] us           Microseconds, NSS low to NSS high
+ * \param [out] calls        Number of transactions
+ */
+	void SX126xGetSpiStats(uint32_t *us, uint32_t *calls);
+
+	/**@brief Time spent waiting for BUSY low since boot
+ *
+ * \param [out] us           Microseconds in SX126xWaitOnBusy()
+ * \param [out] waits        Number of waits
+ * \param [out] timeouts     Waits that gave up with BUSY still high
+ */
+	void SX126xGetBusyStats(uint32_t *us, uint32_t *waits, uint32_t *timeouts);
+
+	/**@brief Forget the configuration shadow, the next commands and
+ * register accesses go to the chip again. Done on reset, sleep,
+ * RX duty cycle, calibration and packet type changes.
+ */
+	void SX126xShadowInvalidate(void);
+
+	/**@brief Transactions the configuration shadow saved since boot
+ *
+ * \param [out] cmds         Commands not sent, the chip held the same parameters
+ * \param [out] regs         Register reads answered and writes skipped locally
+ */
+	void SX126xGetShadowStats(uint32_t *cmds, uint32_t *regs);
+
 	/**@brief Sets the radio output power.
  *
  * \param [IN] power Sets the RF output power
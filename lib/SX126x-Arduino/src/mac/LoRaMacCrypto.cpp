@@ -60,11 +60,6 @@ extern "C"
  */
 	static lora_aes_context AesContext;
 
-	/*!
- * CMAC computation context variable
- */
-	static AES_CMAC_CTX AesCmacCtx[1];
-
 	/*!
  * \brief Computes the LoRaMAC frame MIC field  
  *
@@ -92,15 +87,14 @@ extern "C"
 
 		MicBlockB0[15] = size & 0xFF;
 
-		AES_CMAC_Init(AesCmacCtx);
+		// The key schedule and subkeys of a session key are kept between frames
+		AES_CMAC_CTX *cmac = AES_CMAC_Cached(key);
 
-		AES_CMAC_SetKey(AesCmacCtx, key);
+		AES_CMAC_Update(cmac, MicBlockB0, LORAMAC_MIC_BLOCK_B0_SIZE);
 
-		AES_CMAC_Update(AesCmacCtx, MicBlockB0, LORAMAC_MIC_BLOCK_B0_SIZE);
+		AES_CMAC_Update(cmac, buffer, size & 0xFF);
 
-		AES_CMAC_Update(AesCmacCtx, buffer, size & 0xFF);
-
-		AES_CMAC_Final(Mic, AesCmacCtx);
+		AES_CMAC_Final(Mic, cmac);
 
 		*mic = (uint32_t)((uint32_t)Mic[3] << 24 | (uint32_t)Mic[2] << 16 | (uint32_t)Mic[1] << 8 | (uint32_t)Mic[0]);
 	}
@@ -157,13 +151,11 @@ extern "C"
 
 	void LoRaMacJoinComputeMic(const uint8_t *buffer, uint16_t size, const uint8_t *key, uint32_t *mic)
 	{
-		AES_CMAC_Init(AesCmacCtx);
-
-		AES_CMAC_SetKey(AesCmacCtx, key);
+		AES_CMAC_CTX *cmac = AES_CMAC_Cached(key);
 
-		AES_CMAC_Update(AesCmacCtx, buffer, size & 0xFF);
+		AES_CMAC_Update(cmac, buffer, size & 0xFF);
 
-		AES_CMAC_Final(Mic, AesCmacCtx);
+		AES_CMAC_Final(Mic, cmac);
 
 		*mic = (uint32_t)((uint32_t)Mic[3] << 24 | (uint32_t)Mic[2] << 16 | (uint32_t)Mic[1] << 8 | (uint32_t)Mic[0]);
 	}
@@ -358,9 +358,11 @@ extern "C"
      * \brief Sets the Rx duty cycle management parameters
      *
      * \remark Available on SX126x radios only.
+     *         A detected preamble stops the duty cycle, the radio stays in
+     *         RX until the packet is received.
      *
-     * \param [in]  rxTime        Structure describing reception timeout value
-     * \param [in]  sleepTime     Structure describing sleep timeout value
+     * \param [in]  rxTime        Reception period [15.625 us steps]
+     * \param [in]  sleepTime     Sleep period [15.625 us steps]
      */
 		void (*SetRxDutyCycle)(uint32_t rxTime, uint32_t sleepTime);
 	};
@@ -1011,6 +1011,10 @@ extern "C"
 
 	void RadioSetRxDutyCycle(uint32_t rxTime, uint32_t sleepTime)
 	{
+		SX126xRXena();
+		// A detected preamble stops the RX timer, the radio then stays in RX
+		// until the packet is done instead of going back to sleep
+		SX126xSetStopRxTimerOnPreambleDetect(true);
 		SX126xSetRxDutyCycle(rxTime, sleepTime);
 	}
 
@@ -1161,7 +1165,14 @@ extern "C"
 			BoardEnableIrq();
 
 			uint16_t irqRegs = SX126xGetIrqStatus();
-			SX126xClearIrqStatus(IRQ_RADIO_ALL);
+			if (irqRegs != 0)
+			{
+				SX126xClearIrqStatus(IRQ_RADIO_ALL);
+			}
+			if ((irqRegs & (IRQ_RX_DONE | IRQ_CRC_ERROR | IRQ_HEADER_ERROR | IRQ_RX_TX_TIMEOUT)) != 0)
+			{
+				SX126xSetRxHeaderValid(false);
+			}
 
 			if ((irqRegs & IRQ_TX_DONE) == IRQ_TX_DONE)
 			{
@@ -1185,14 +1196,17 @@ extern "C"
 					SX126xSetOperatingMode(MODE_STDBY_RC);
 
 					// WORKAROUND - Implicit Header Mode Timeout Behavior, see DS_SX1261-2_V1.2 datasheet chapter 15.3
-					// RegRtcControl = @address 0x0902
-					SX126xWriteRegister(0x0902, 0x00);
-					// RegEventMask = @address 0x0944
-					SX126xWriteRegister(0x0944, SX126xReadRegister(0x0944) | (1 << 1));
+					// Only a single RX with timeout in implicit header mode leaves the RTC running
+					if ((RxTimeout != 0) && (SX126xGetPacketType() == PACKET_TYPE_LORA) && (SX126x.PacketParams.Params.LoRa.HeaderType == LORA_PACKET_IMPLICIT))
+					{
+						// RegRtcControl = @address 0x0902
+						SX126xWriteRegister(0x0902, 0x00);
+						// RegEventMask = @address 0x0944, the read is served by the register shadow
+						SX126xWriteRegister(0x0944, SX126xReadRegister(0x0944) | (1 << 1));
+					}
 					// WORKAROUND END
 				}
-				SX126xGetPayload(RadioRxPayload, &size, 255);
-				SX126xGetPacketStatus(&RadioPktStatus);
+				SX126xGetRxPacket(RadioRxPayload, &size, 255, &RadioPktStatus);
 				if ((RadioEvents != NULL) && (RadioEvents->RxDone != NULL))
 				{
 					RadioEvents->RxDone(RadioRxPayload, size, RadioPktStatus.Params.LoRa.RssiPkt, RadioPktStatus.Params.LoRa.SnrPkt);
@@ -1214,11 +1228,20 @@ extern "C"
 
 			if ((irqRegs & IRQ_CAD_DONE) == IRQ_CAD_DONE)
 			{
-				//!< Update operating mode state to a value lower than \ref MODE_STDBY_XOSC
-				SX126xSetOperatingMode(MODE_STDBY_RC);
+				bool detected = ((irqRegs & IRQ_CAD_ACTIVITY_DETECTED) == IRQ_CAD_ACTIVITY_DETECTED);
+				if (detected && (SX126xGetCadExitMode() == LORA_CAD_RX))
+				{
+					//!< The radio went on to RX, its timeout is reported as RX timeout
+					SX126xSetOperatingMode(MODE_RX);
+				}
+				else
+				{
+					//!< Update operating mode state to a value lower than \ref MODE_STDBY_XOSC
+					SX126xSetOperatingMode(MODE_STDBY_RC);
+				}
 				if ((RadioEvents != NULL) && (RadioEvents->CadDone != NULL))
 				{
-					RadioEvents->CadDone(((irqRegs & IRQ_CAD_ACTIVITY_DETECTED) == IRQ_CAD_ACTIVITY_DETECTED));
+					RadioEvents->CadDone(detected);
 				}
 			}
 
@@ -1248,7 +1271,11 @@ extern "C"
 
 			if ((irqRegs & IRQ_PREAMBLE_DETECTED) == IRQ_PREAMBLE_DETECTED)
 			{
-				//__NOP( );
+				if (SX126xGetOperatingMode() == MODE_RX_DC)
+				{
+					//!< The duty cycle stopped, the radio receives the packet
+					SX126xSetOperatingMode(MODE_RX);
+				}
 			}
 
 			if ((irqRegs & IRQ_SYNCWORD_VALID) == IRQ_SYNCWORD_VALID)
@@ -1258,7 +1285,11 @@ extern "C"
 
 			if ((irqRegs & IRQ_HEADER_VALID) == IRQ_HEADER_VALID)
 			{
-				//__NOP( );
+				//!< Packet in progress, unless it ended in the same batch of IRQs
+				if ((irqRegs & (IRQ_RX_DONE | IRQ_CRC_ERROR | IRQ_HEADER_ERROR | IRQ_RX_TX_TIMEOUT)) == 0)
+				{
+					SX126xSetRxHeaderValid(true);
+				}
 			}
 
 			if ((irqRegs & IRQ_HEADER_ERROR) == IRQ_HEADER_ERROR)
@@ -47,15 +47,38 @@ extern "C"
  */
 	static RadioPacketTypes_t PacketType;
 
+	/*!
+ * \brief Host copy of the LoRa header mode and fixed payload length, set in
+ * SX126xSetPacketParams. Saves reading REG_LR_PACKETPARAMS and
+ * REG_LR_PAYLOADLENGTH back for every received packet.
+ */
+	static bool LoRaImplicit = false;
+	static uint8_t LoRaFixLength = 0;
+
+	/*!
+ * \brief What the radio does after a CAD, set in SX126xSetCadParams
+ */
+	static RadioCadExitModes_t CadExitMode = LORA_CAD_ONLY;
+
+	/*!
+ * \brief A LoRa header was received and the packet is not done yet
+ */
+	static bool RxHeaderValid = false;
+
 	/*!
  * \brief Stores the last frequency error measured on LoRa received packet
  */
 	volatile uint32_t FrequencyError = 0;
 
 	/*!
- * \brief Hold the status of the Image calibration
+ * \brief Image calibration band the chip currently holds (calFreq pair), 0 when unknown
+ */
+	static uint16_t ImageCalBand = 0;
+
+	/*!
+ * \brief Image calibration band (calFreq pair) for a frequency
  */
-	static bool ImageCalibrated = false;
+	static uint16_t SX126xImageBand(uint32_t freq);
 
 	/*
  * SX126x DIO IRQ callback functions prototype
@@ -98,6 +121,7 @@ extern "C"
 			calibParam.Value = 0x7F;
 			SX126xCalibrate(calibParam);
 		}
+		ImageCalBand = 0;
 		if (_hwConfig.USE_DIO2_ANT_SWITCH)
 		{
 			SX126xSetDio2AsRfSwitchCtrl(true);
@@ -114,6 +138,7 @@ extern "C"
 	void SX126xSetOperatingMode(RadioOperatingModes_t mode)
 	{
 		OperatingMode = mode;
+		RxHeaderValid = false;
 	}
 
 	void SX126xCheckDeviceReady(void)
@@ -145,6 +170,24 @@ extern "C"
 		return 0;
 	}
 
+	uint8_t SX126xGetRxPacket(uint8_t *buffer, uint8_t *size, uint8_t maxSize, PacketStatus_t *pktStatus)
+	{
+		uint8_t offset = 0;
+		uint8_t result = 0;
+
+		SX126xGetRxBufferStatus(size, &offset);
+		if (*size > maxSize)
+		{
+			result = 1;
+		}
+		else
+		{
+			SX126xReadBuffer(offset, buffer, *size);
+		}
+		SX126xGetPacketStatus(pktStatus);
+		return result;
+	}
+
 	void SX126xSendPayload(uint8_t *payload, uint8_t size, uint32_t timeout)
 	{
 		SX126xSetPayload(payload, size);
@@ -233,6 +276,11 @@ extern "C"
 
 		SX126xWriteCommand(RADIO_SET_SLEEP, &sleepConfig.Value, 1);
 		SX126xSetOperatingMode(MODE_SLEEP);
+		if (sleepConfig.Fields.WarmStart == 0)
+		{
+			// Cold start loses the image calibration
+			ImageCalBand = 0;
+		}
 	}
 
 	void SX126xSetStandby(RadioStandbyModes_t standbyConfig)
@@ -340,38 +388,43 @@ extern "C"
 	void SX126xCalibrate(CalibrationParams_t calibParam)
 	{
 		SX126xWriteCommand(RADIO_CALIBRATE, (uint8_t *)&calibParam, 1);
+		if (calibParam.Fields.ImgEnable)
+		{
+			// Full image calibration runs for the default band
+			ImageCalBand = 0;
+		}
 	}
 
-	void SX126xCalibrateImage(uint32_t freq)
+	static uint16_t SX126xImageBand(uint32_t freq)
 	{
-		uint8_t calFreq[2];
-
 		if (freq > 900000000)
 		{
-			calFreq[0] = 0xE1;
-			calFreq[1] = 0xE9;
+			return 0xE1E9;
 		}
 		else if (freq > 850000000)
 		{
-			calFreq[0] = 0xD7;
-			calFreq[1] = 0xDB;
+			return 0xD7DB;
 		}
 		else if (freq > 770000000)
 		{
-			calFreq[0] = 0xC1;
-			calFreq[1] = 0xC5;
+			return 0xC1C5;
 		}
 		else if (freq > 460000000)
 		{
-			calFreq[0] = 0x75;
-			calFreq[1] = 0x81;
-		}
-		else if (freq > 425000000)
-		{
-			calFreq[0] = 0x6B;
-			calFreq[1] = 0x6F;
+			return 0x7581;
 		}
+		return 0x6B6F;
+	}
+
+	void SX126xCalibrateImage(uint32_t freq)
+	{
+		uint16_t band = SX126xImageBand(freq);
+		uint8_t calFreq[2];
+
+		calFreq[0] = (uint8_t)(band >> 8);
+		calFreq[1] = (uint8_t)(band & 0xFF);
 		SX126xWriteCommand(RADIO_CALIBRATEIMAGE, calFreq, 2);
+		ImageCalBand = band;
 	}
 
 	void SX126xSetPaConfig(uint8_t paDutyCycle, uint8_t hpMax, uint8_t deviceSel, uint8_t paLut)
@@ -444,13 +497,15 @@ extern "C"
 		uint8_t buf[4];
 		uint32_t freq = 0;
 
-		if (ImageCalibrated == false)
+		// Image calibration takes ~3.5ms per band, so only
+		// calibrate again when the new frequency leaves the band
+		if (SX126xImageBand(frequency) != ImageCalBand)
 		{
 			SX126xCalibrateImage(frequency);
-			ImageCalibrated = true;
 		}
 
-		freq = (uint32_t)((double)frequency / (double)FREQ_STEP);
+		// frequency * 2^25 / 32MHz, in integer math
+		freq = (uint32_t)(((uint64_t)frequency << 14) / 15625);
 		buf[0] = (uint8_t)((freq >> 24) & 0xFF);
 		buf[1] = (uint8_t)((freq >> 16) & 0xFF);
 		buf[2] = (uint8_t)((freq >> 8) & 0xFF);
@@ -613,6 +668,8 @@ extern "C"
 			buf[3] = packetParams->Params.LoRa.PayloadLength;
 			buf[4] = packetParams->Params.LoRa.CrcMode;
 			buf[5] = packetParams->Params.LoRa.InvertIQ;
+			LoRaImplicit = (packetParams->Params.LoRa.HeaderType == LORA_PACKET_IMPLICIT);
+			LoRaFixLength = packetParams->Params.LoRa.PayloadLength;
 			break;
 		default:
 		case PACKET_TYPE_NONE:
@@ -634,6 +691,22 @@ extern "C"
 		buf[6] = (uint8_t)(cadTimeout & 0xFF);
 		SX126xWriteCommand(RADIO_SET_CADPARAMS, buf, 7);
 		OperatingMode = MODE_CAD;
+		CadExitMode = cadExitMode;
+	}
+
+	RadioCadExitModes_t SX126xGetCadExitMode(void)
+	{
+		return CadExitMode;
+	}
+
+	void SX126xSetRxHeaderValid(bool valid)
+	{
+		RxHeaderValid = valid;
+	}
+
+	bool SX126xGetRxHeaderValid(void)
+	{
+		return RxHeaderValid;
 	}
 
 	void SX126xSetBufferBaseAddress(uint8_t txBaseAddress, uint8_t rxBaseAddress)
@@ -671,11 +744,11 @@ extern "C"
 
 		SX126xReadCommand(RADIO_GET_RXBUFFERSTATUS, status, 2);
 
-		// In case of LORA fixed header, the payloadLength is obtained by reading
-		// the register REG_LR_PAYLOADLENGTH
-		if ((SX126xGetPacketType() == PACKET_TYPE_LORA) && (SX126xReadRegister(REG_LR_PACKETPARAMS) >> 7 == 1))
+		// In case of LORA fixed header, the payloadLength is the one set
+		// with the packet params, REG_LR_PAYLOADLENGTH holds the same value
+		if ((SX126xGetPacketType() == PACKET_TYPE_LORA) && LoRaImplicit)
 		{
-			*payloadLength = SX126xReadRegister(REG_LR_PAYLOADLENGTH);
+			*payloadLength = LoRaFixLength;
 		}
 		else
 		{
@@ -721,8 +794,11 @@ extern "C"
 	RadioError_t SX126xGetDeviceErrors(void)
 	{
 		RadioError_t error;
+		uint8_t buf[2];
 
-		SX126xReadCommand(RADIO_GET_ERROR, (uint8_t *)&error, 2);
+		// The chip sends the MSB first
+		SX126xReadCommand(RADIO_GET_ERROR, buf, 2);
+		error.Value = (buf[0] << 8) | buf[1];
 		return error;
 	}
 
@@ -750,6 +750,18 @@ extern "C"
  */
 	uint8_t SX126xGetPayload(uint8_t *payload, uint8_t *size, uint8_t maxSize);
 
+	/*!
+ * \brief Reads the buffer status, the payload and the packet status of a
+ *        received packet back to back, the RX done service path.
+ *
+ * \param [out] buffer     A pointer to a buffer into which the payload will be copied
+ * \param [out] size       A pointer to the size of the payload received
+ * \param [in]  maxSize    The maximal size allowed to copy into the buffer
+ * \param [out] pktStatus  A structure of packet status
+ * \retval      status     1 if the payload did not fit, 0 otherwise
+ */
+	uint8_t SX126xGetRxPacket(uint8_t *buffer, uint8_t *size, uint8_t maxSize, PacketStatus_t *pktStatus);
+
 	/*!
  * \brief Sends a payload
  *
@@ -1053,6 +1065,29 @@ extern "C"
  */
 	void SX126xSetCadParams(RadioLoRaCadSymbols_t cadSymbolNum, uint8_t cadDetPeak, uint8_t cadDetMin, RadioCadExitModes_t cadExitMode, uint32_t cadTimeout);
 
+	/*!
+ * \brief Gets the CAD exit mode set with SX126xSetCadParams
+ *
+ * \retval      cadExitMode    [LORA_CAD_ONLY, LORA_CAD_RX, LORA_CAD_LBT]
+ */
+	RadioCadExitModes_t SX126xGetCadExitMode(void);
+
+	/*!
+ * \brief Marks that a valid LoRa header was received and the rest of the
+ *        packet is still coming in
+ *
+ * \param [in]  valid          true from IRQ_HEADER_VALID to the end of the packet
+ */
+	void SX126xSetRxHeaderValid(bool valid);
+
+	/*!
+ * \brief Tells if a packet is being received, see SX126xSetRxHeaderValid.
+ *        Cleared as well when the operating mode changes.
+ *
+ * \retval      valid          true while a packet is being received
+ */
+	bool SX126xGetRxHeaderValid(void);
+
 	/*!
  * \brief Sets the data buffer base address for transmission and reception
  *
@@ -43,6 +43,7 @@
 
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
 
 extern "C"
 {
@@ -65,6 +66,14 @@ extern "C"
 
 #include "aes.h"
 
+#if (LORA_AES_ENGINE == LORA_AES_ESP32_HW)
+#if __has_include("aes/esp_aes.h")
+#include "aes/esp_aes.h"
+#else
+#include "hwcrypto/aes.h"
+#endif
+#endif
+
 	// #if defined( HAVE_UINT_32T )
 	//  typedef unsigned long uint32_t;
 	// #endif
@@ -206,6 +215,13 @@ extern "C"
 	static const uint8_t gfm2_sbox[256] = sb_data(f2);
 	static const uint8_t gfm3_sbox[256] = sb_data(f3);
 
+#if (LORA_AES_ENGINE == LORA_AES_TTABLE)
+	/* S-box and MixColumns of row 0 in one word (2s, s, s, 3s), lowest byte
+	   first. Rows 1 to 3 use the same word rotated left by 8, 16 and 24 bits. */
+#define t_w(p) ((uint32_t)f2(p) | ((uint32_t)(p) << 8) | ((uint32_t)(p) << 16) | ((uint32_t)f3(p) << 24))
+	static const uint32_t t_fn[256] = sb_data(t_w);
+#endif
+
 #if defined(AES_DEC_PREKEYED)
 	static const uint8_t gfmul_9[256] = mm_data(f9);
 	static const uint8_t gfmul_b[256] = mm_data(fb);
@@ -600,7 +616,86 @@ extern "C"
 
 	/*  Encrypt a single block of 16 bytes */
 
-	return_type lora_aes_encrypt(const uint8_t in[N_BLOCK], uint8_t out[N_BLOCK], const lora_aes_context ctx[1])
+#if (LORA_AES_ENGINE == LORA_AES_TTABLE)
+
+#define rotl(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+#define word_in(p) ((uint32_t)(p)[0] | ((uint32_t)(p)[1] << 8) | ((uint32_t)(p)[2] << 16) | ((uint32_t)(p)[3] << 24))
+#define word_out(p, w)               \
+	do                               \
+	{                                \
+		(p)[0] = (uint8_t)(w);       \
+		(p)[1] = (uint8_t)(w >> 8);  \
+		(p)[2] = (uint8_t)(w >> 16); \
+		(p)[3] = (uint8_t)(w >> 24); \
+	} while (0)
+
+/* One column of SubBytes, ShiftRows and MixColumns */
+#define t_col(a, b, c, d) \
+	(t_fn[(a)&0xff] ^ rotl(t_fn[((b) >> 8) & 0xff], 8) ^ rotl(t_fn[((c) >> 16) & 0xff], 16) ^ rotl(t_fn[(d) >> 24], 24))
+
+/* One column of the last round, no MixColumns */
+#define l_col(a, b, c, d) \
+	((uint32_t)s_box((a)&0xff) | ((uint32_t)s_box(((b) >> 8) & 0xff) << 8) | ((uint32_t)s_box(((c) >> 16) & 0xff) << 16) | ((uint32_t)s_box((d) >> 24) << 24))
+
+	static return_type aes_encrypt_fast(const uint8_t in[N_BLOCK], uint8_t out[N_BLOCK], const lora_aes_context ctx[1])
+	{
+		if (!ctx->rnd)
+			return (uint8_t)-1;
+
+		const uint32_t *kw = ctx->kw;
+		uint32_t s0 = word_in(in) ^ kw[0];
+		uint32_t s1 = word_in(in + 4) ^ kw[1];
+		uint32_t s2 = word_in(in + 8) ^ kw[2];
+		uint32_t s3 = word_in(in + 12) ^ kw[3];
+		uint32_t t0, t1, t2, t3;
+		uint8_t r;
+
+		for (r = 1; r < ctx->rnd; ++r)
+		{
+			kw += N_COL;
+			t0 = t_col(s0, s1, s2, s3) ^ kw[0];
+			t1 = t_col(s1, s2, s3, s0) ^ kw[1];
+			t2 = t_col(s2, s3, s0, s1) ^ kw[2];
+			t3 = t_col(s3, s0, s1, s2) ^ kw[3];
+			s0 = t0;
+			s1 = t1;
+			s2 = t2;
+			s3 = t3;
+		}
+		kw += N_COL;
+		t0 = l_col(s0, s1, s2, s3) ^ kw[0];
+		t1 = l_col(s1, s2, s3, s0) ^ kw[1];
+		t2 = l_col(s2, s3, s0, s1) ^ kw[2];
+		t3 = l_col(s3, s0, s1, s2) ^ kw[3];
+		word_out(out, t0);
+		word_out(out + 4, t1);
+		word_out(out + 8, t2);
+		word_out(out + 12, t3);
+		return 0;
+	}
+
+#elif (LORA_AES_ENGINE == LORA_AES_ESP32_HW)
+
+	/* The accelerator expands the key itself, only the key bytes at the
+	   start of ksch are used */
+	static return_type aes_encrypt_fast(const uint8_t in[N_BLOCK], uint8_t out[N_BLOCK], const lora_aes_context ctx[1])
+	{
+		if (!ctx->rnd)
+			return (uint8_t)-1;
+
+		esp_aes_context hw;
+		esp_aes_init(&hw);
+		esp_aes_setkey(&hw, ctx->ksch, (ctx->rnd - 6) * 32);
+		esp_aes_crypt_ecb(&hw, ESP_AES_ENCRYPT, in, out);
+		esp_aes_free(&hw);
+		return 0;
+	}
+
+#endif
+
+	/* The byte engine is always built, it is the fallback when the faster
+	   engine fails its self test, see lora_aes_set_engine() */
+	static return_type aes_encrypt_byte(const uint8_t in[N_BLOCK], uint8_t out[N_BLOCK], const lora_aes_context ctx[1])
 	{
 		if (ctx->rnd)
 		{
@@ -628,6 +723,48 @@ extern "C"
 		return 0;
 	}
 
+	static uint8_t aes_engine = LORA_AES_ENGINE;
+
+	return_type lora_aes_encrypt(const uint8_t in[N_BLOCK], uint8_t out[N_BLOCK], const lora_aes_context ctx[1])
+	{
+#if (LORA_AES_ENGINE != LORA_AES_BYTE)
+		if (aes_engine != LORA_AES_BYTE)
+			return aes_encrypt_fast(in, out, ctx);
+#endif
+		return aes_encrypt_byte(in, out, ctx);
+	}
+
+	uint8_t lora_aes_get_engine(void)
+	{
+		return aes_engine;
+	}
+
+	/* The key schedule does not depend on the engine, contexts set up
+	   before the switch stay valid */
+	return_type lora_aes_set_engine(uint8_t engine)
+	{
+		if (engine != LORA_AES_BYTE && engine != LORA_AES_ENGINE)
+			return (uint8_t)-1;
+		aes_engine = engine;
+		return 0;
+	}
+
+	return_type lora_aes_self_test(void)
+	{
+		static const uint8_t key[N_BLOCK] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+											 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f};
+		static const uint8_t pt[N_BLOCK] = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+											0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff};
+		static const uint8_t ct[N_BLOCK] = {0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30,
+											0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a};
+		lora_aes_context ctx;
+		uint8_t out[N_BLOCK];
+
+		if (lora_aes_set_key(key, 16, &ctx) != 0 || lora_aes_encrypt(pt, out, &ctx) != 0)
+			return (uint8_t)-1;
+		return memcmp(out, ct, N_BLOCK) == 0 ? 0 : (uint8_t)-1;
+	}
+
 	/* CBC encrypt a number of blocks (input and return an IV) */
 
 	return_type lora_aes_cbc_encrypt(const uint8_t *in, uint8_t *out,
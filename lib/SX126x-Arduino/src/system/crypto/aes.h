@@ -65,9 +65,28 @@ extern "C"
 
 	typedef uint8_t length_type;
 
+/*  Engine behind lora_aes_encrypt(), selected at compile time (the byte
+    engine is always built as the fallback, see lora_aes_set_engine()):
+    LORA_AES_BYTE      byte operations only, 768 bytes of tables
+    LORA_AES_TTABLE    one round = 16 lookups in a 1 KB table of 32-bit
+                       words, the key schedule is shared with LORA_AES_BYTE
+    LORA_AES_ESP32_HW  the AES accelerator of the ESP32
+*/
+#define LORA_AES_BYTE 0
+#define LORA_AES_TTABLE 1
+#define LORA_AES_ESP32_HW 2
+
+#ifndef LORA_AES_ENGINE
+#define LORA_AES_ENGINE LORA_AES_TTABLE
+#endif
+
 	typedef struct
 	{
-		uint8_t ksch[(N_MAX_ROUNDS + 1) * N_BLOCK];
+		union
+		{
+			uint8_t ksch[(N_MAX_ROUNDS + 1) * N_BLOCK];
+			uint32_t kw[(N_MAX_ROUNDS + 1) * N_COL]; /* same bytes as round key words */
+		};
 		uint8_t rnd;
 	} lora_aes_context;
 
@@ -97,6 +116,16 @@ extern "C"
 									 int32_t n_block,
 									 uint8_t iv[N_BLOCK],
 									 const lora_aes_context ctx[1]);
+
+	/*  Encrypt the FIPS-197 appendix C.1 vector with the selected engine.
+    Returns 0 when the result is correct. */
+	return_type lora_aes_self_test(void);
+
+	/*  Engine in use, LORA_AES_ENGINE after boot. Only LORA_AES_BYTE and
+    LORA_AES_ENGINE can be selected, so a failing faster engine can fall
+    back to the byte engine. Returns 0 when the engine was selected. */
+	uint8_t lora_aes_get_engine(void);
+	return_type lora_aes_set_engine(uint8_t engine);
 #endif
 
 #if defined(AES_DEC_PREKEYED)
@@ -35,6 +35,7 @@ DEALINGS WITH THE SOFTWARE
 //#include <sys/param.h>
 //#include <sys/systm.h>
 #include <stdint.h>
+#include <string.h>
 #include "aes.h"
 #include "cmac.h"
 #include "system/utilities.h"
@@ -73,6 +74,62 @@ extern "C"
 	{
 		//rijndael_set_key_enc_only(&ctx->rijndael, key, 128);
 		lora_aes_set_key(key, AES_CMAC_KEY_LENGTH, &ctx->rijndael);
+
+		/* generate subkeys K1 and K2 once per key */
+		memset1(ctx->K1, '\0', 16);
+		lora_aes_encrypt(ctx->K1, ctx->K1, &ctx->rijndael);
+		if (ctx->K1[0] & 0x80)
+		{
+			LSHIFT(ctx->K1, ctx->K1);
+			ctx->K1[15] ^= 0x87;
+		}
+		else
+			LSHIFT(ctx->K1, ctx->K1);
+
+		if (ctx->K1[0] & 0x80)
+		{
+			LSHIFT(ctx->K1, ctx->K2);
+			ctx->K2[15] ^= 0x87;
+		}
+		else
+			LSHIFT(ctx->K1, ctx->K2);
+	}
+
+	void AES_CMAC_Reset(AES_CMAC_CTX *ctx)
+	{
+		memset1(ctx->X, 0, sizeof ctx->X);
+		ctx->M_n = 0;
+	}
+
+	static struct
+	{
+		uint8_t key[AES_CMAC_KEY_LENGTH];
+		uint32_t used; /* 0 = free */
+		AES_CMAC_CTX ctx;
+	} cmacCache[AES_CMAC_CACHE_SIZE];
+	static uint32_t cmacClock;
+
+	AES_CMAC_CTX *AES_CMAC_Cached(const uint8_t key[AES_CMAC_KEY_LENGTH])
+	{
+		uint8_t i, lru = 0;
+
+		for (i = 0; i < AES_CMAC_CACHE_SIZE; i++)
+		{
+			if (cmacCache[i].used && memcmp(cmacCache[i].key, key, AES_CMAC_KEY_LENGTH) == 0)
+				break;
+			if (cmacCache[i].used < cmacCache[lru].used)
+				lru = i;
+		}
+		if (i == AES_CMAC_CACHE_SIZE)
+		{
+			i = lru;
+			memcpy1(cmacCache[i].key, key, AES_CMAC_KEY_LENGTH);
+			AES_CMAC_Init(&cmacCache[i].ctx);
+			AES_CMAC_SetKey(&cmacCache[i].ctx, key);
+		}
+		cmacCache[i].used = ++cmacClock;
+		AES_CMAC_Reset(&cmacCache[i].ctx);
+		return &cmacCache[i].ctx;
 	}
 
 	void AES_CMAC_Update(AES_CMAC_CTX *ctx, const uint8_t *data, uint32_t len)
@@ -113,45 +170,21 @@ extern "C"
 
 	void AES_CMAC_Final(uint8_t digest[AES_CMAC_DIGEST_LENGTH], AES_CMAC_CTX *ctx)
 	{
-		uint8_t K[16];
 		uint8_t in[16];
-		/* generate subkey K1 */
-		memset1(K, '\0', 16);
-
-		//rijndael_encrypt(&ctx->rijndael, K, K);
-
-		lora_aes_encrypt(K, K, &ctx->rijndael);
-
-		if (K[0] & 0x80)
-		{
-			LSHIFT(K, K);
-			K[15] ^= 0x87;
-		}
-		else
-			LSHIFT(K, K);
 
 		if (ctx->M_n == 16)
 		{
 			/* last block was a complete block */
-			XOR(K, ctx->M_last);
+			XOR(ctx->K1, ctx->M_last);
 		}
 		else
 		{
-			/* generate subkey K2 */
-			if (K[0] & 0x80)
-			{
-				LSHIFT(K, K);
-				K[15] ^= 0x87;
-			}
-			else
-				LSHIFT(K, K);
-
 			/* padding(M_last) */
 			ctx->M_last[ctx->M_n] = 0x80;
 			while (++ctx->M_n < 16)
 				ctx->M_last[ctx->M_n] = 0;
 
-			XOR(K, ctx->M_last);
+			XOR(ctx->K2, ctx->M_last);
 		}
 		XOR(ctx->M_last, ctx->X);
 
@@ -159,6 +192,42 @@ extern "C"
 
 		memcpy1(in, &ctx->X[0], 16); //Bestela ez du ondo iten
 		lora_aes_encrypt(in, digest, &ctx->rijndael);
-		memset1(K, 0, sizeof K);
+	}
+
+	/* RFC 4493 section 4 (NIST SP 800-38B appendix D.1) examples 1 to 4,
+	   the messages are the first 0, 16, 40 and 64 bytes of msg */
+	uint8_t AES_CMAC_SelfTest(void)
+	{
+		static const uint8_t key[16] = {0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+										0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c};
+		static const uint8_t msg[64] = {0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96,
+										0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a,
+										0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c,
+										0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51,
+										0x30, 0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4, 0x11,
+										0xe5, 0xfb, 0xc1, 0x19, 0x1a, 0x0a, 0x52, 0xef,
+										0xf6, 0x9f, 0x24, 0x45, 0xdf, 0x4f, 0x9b, 0x17,
+										0xad, 0x2b, 0x41, 0x7b, 0xe6, 0x6c, 0x37, 0x10};
+		static const uint8_t len[4] = {0, 16, 40, 64};
+		static const uint8_t mac[4][16] = {
+			{0xbb, 0x1d, 0x69, 0x29, 0xe9, 0x59, 0x37, 0x28, 0x7f, 0xa3, 0x7d, 0x12, 0x9b, 0x75, 0x67, 0x46},
+			{0x07, 0x0a, 0x16, 0xb4, 0x6b, 0x4d, 0x41, 0x44, 0xf7, 0x9b, 0xdd, 0x9d, 0xd0, 0x4a, 0x28, 0x7c},
+			{0xdf, 0xa6, 0x67, 0x47, 0xde, 0x9a, 0xe6, 0x30, 0x30, 0xca, 0x32, 0x61, 0x14, 0x97, 0xc8, 0x27},
+			{0x51, 0xf0, 0xbe, 0xbf, 0x7e, 0x3b, 0x9d, 0x92, 0xfc, 0x49, 0x74, 0x17, 0x79, 0x36, 0x3c, 0xfe}};
+		AES_CMAC_CTX ctx;
+		uint8_t digest[AES_CMAC_DIGEST_LENGTH];
+		uint8_t i;
+
+		AES_CMAC_Init(&ctx);
+		AES_CMAC_SetKey(&ctx, key);
+		for (i = 0; i < 4; i++)
+		{
+			AES_CMAC_Reset(&ctx);
+			AES_CMAC_Update(&ctx, msg, len[i]);
+			AES_CMAC_Final(digest, &ctx);
+			if (memcmp(digest, mac[i], AES_CMAC_DIGEST_LENGTH) != 0)
+				return (uint8_t)-1;
+		}
+		return 0;
 	}
 };
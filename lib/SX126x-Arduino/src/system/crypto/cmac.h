@@ -43,12 +43,19 @@ extern "C"
 #define AES_CMAC_KEY_LENGTH 16
 #define AES_CMAC_DIGEST_LENGTH 16
 
+/* Number of keys AES_CMAC_Cached() keeps expanded */
+#ifndef AES_CMAC_CACHE_SIZE
+#define AES_CMAC_CACHE_SIZE 4
+#endif
+
 	typedef struct _AES_CMAC_CTX
 	{
 		lora_aes_context rijndael;
 		uint8_t X[16];
 		uint8_t M_last[16];
 		uint32_t M_n;
+		uint8_t K1[16]; /* RFC 4493 subkeys, set by AES_CMAC_SetKey() */
+		uint8_t K2[16];
 	} AES_CMAC_CTX;
 
 	//#include <sys/cdefs.h>
@@ -60,6 +67,15 @@ extern "C"
 	//          __attribute__((__bounded__(__string__,2,3)));
 	void AES_CMAC_Final(uint8_t digest[AES_CMAC_DIGEST_LENGTH], AES_CMAC_CTX *ctx);
 	//     __attribute__((__bounded__(__minbytes__,1,AES_CMAC_DIGEST_LENGTH)));
+
+	/* Start a new message, keeps the key schedule and the subkeys */
+	void AES_CMAC_Reset(AES_CMAC_CTX *ctx);
+	/* Keyed context from a small LRU cache, ready for AES_CMAC_Update().
+	   Only a key that is not in the cache is expanded. */
+	AES_CMAC_CTX *AES_CMAC_Cached(const uint8_t key[AES_CMAC_KEY_LENGTH]);
+	/* Check the engine of lora_aes_encrypt() against the RFC 4493 vectors,
+	   returns 0 when all four MACs are correct */
+	uint8_t AES_CMAC_SelfTest(void);
 	//__END_DECLS
 };
 #endif /* _CMAC_H_ */
@@ -87,6 +87,12 @@
 // device and also connect enable dio1 to detect this state.
 #define _CAD 0
 
+// Sniff mode, SX1262 only. Instead of continuous RX the radio listens for
+// short windows and sleeps in between (RX duty cycle), timed so that every
+// preamble of LORA_PREAMBLE_LENGTH symbols spans a window. Saves radio
+// current on solar sites with sparse traffic, only at SF9 and up.
+#define _SNIFF 0
+
 // Definitions for the admin webserver.
 // A_SERVER determines whether or not the admin webpage is included in the sketch.
 // Normally, leave it in!
@@ -162,6 +168,10 @@
 // OLED==2;	1"3 Oled screens for Wemos, 128x64 SH1106
 #define OLED 2
 
+// Maximum number of OLED frames per second. The display is drawn by its own
+// task, frames without changes are not sent at all.
+#define OLED_FPS 4
+
 // Define whether we want to manage the gateway over UDP (next to management
 // thru webinterface).
 // This will allow us to send messages over the UDP connection to manage the gateway
@@ -180,6 +190,14 @@
 // Of course we must store enough records to make the filesystem work
 #define STAT_LOG 1
 
+// Persist the statc counters and the statr message history across reboots.
+// Every _STAT_CHECKPOINT seconds only the counters that changed are appended
+// as small delta records to a journal file in SPIFFS. When the journal grows
+// beyond STATJRNLMAX bytes (see loraFiles.h) it is compacted into a snapshot.
+// Larger values mean less flash wear but more counts lost on a power failure.
+// Set to 0 to keep the statistics in RAM only (old behaviour).
+#define _STAT_CHECKPOINT 300
+
 // Name of he configfile in SPIFFs	filesystem
 // In this file we store the configuration and other relevant info that should
 // survive a reboot of the gateway
@@ -217,6 +235,29 @@
 // in loraModem.cpp and adapt the definition of decodes in loraModem.h
 #define _LOCALSERVER 1 // See server definitions for decodes
 
+// Maximum number of device sessions (DevAddr, NwkSKey, AppSKey) that the
+// _LOCALSERVER can decode. The table is read from SESSIONFILE at boot, decodes[]
+// in loraModem.cpp only fills that file the very first time. Devices are added
+// and removed over /api/sessions. Each session takes ~600 bytes with its
+// expanded keys and the table goes to PSRAM when the board has it.
+// Without PSRAM the table is taken from internal RAM and holds at most
+// SESSION_MAX_DRAM sessions (32 = ~20 KB), which leaves enough heap for
+// WiFi and the web server.
+#define SESSION_MAX 1024
+#define SESSION_MAX_DRAM 32
+
+// The frame counters of the sessions are written to SESSIONFILE at most every
+// _SESSION_SAVE seconds, and only when one of them changed, so after a reboot
+// the gateway continues close to the last FCnt of each device. 0 writes the
+// file only when a device is added or removed.
+#define _SESSION_SAVE 3600
+
+// An ABP device that was reset starts at FCnt 0 again. A frame with an FCnt
+// below _FCNT_RESET that has the right MIC with the plain 16-bit counter is
+// taken as such a reset and the session continues from there. A replay of
+// these first frames is accepted as well, so keep the window small.
+#define _FCNT_RESET 16
+
 // Gateway Ident definitions
 #define _DESCRIPTION "ESP32 GW" // Name of the gateway
 #define _EMAIL "owner@example.com"	 // Owner
@@ -239,7 +280,40 @@
 // as a regular sensor value.
 // Set its LoRa address and key below in this file, See spec. para 4.3.2
 #define GATEWAYNODE 0
+
+// Filter received uplinks before they are turned into a PUSH_DATA message,
+// see rxFilter() in txRx.cpp. Data frames that are too short, that carry a
+// DevAddr outside our network and (with _LOCALSERVER) frames of known
+// devices with a wrong MIC are dropped and counted in statc.
+// _NETID_PREFIX/_NETID_BITS give the DevAddr prefix of our network, for TTN
+// (NetID 0x000013) that is 0x26000000/7. _NETID_BITS 0 accepts every DevAddr.
 #define _CHECK_MIC 0
+#define _NETID_PREFIX 0x26000000
+#define _NETID_BITS 0
+
+// Uplink de-duplication, see dedupCheck() in txRx.cpp. A frame with the same
+// DevAddr, FCnt and MIC as one received less than _DEDUP_WINDOW seconds ago
+// is counted (1) or counted and not forwarded (2). Confirmed uplinks are
+// always forwarded, a repeated one asks the network server for a new ACK.
+// The cache remembers the last _DEDUP_SIZE frames (power of 2), 20 bytes
+// RAM each.
+#define _DEDUP 2
+#define _DEDUP_SIZE 128
+#define _DEDUP_WINDOW 30
+
+// Per device rate limit of the forwarder, see rateLimit.cpp. Every DevAddr
+// may send _RATE_PER_HOUR frames per hour on average and _RATE_BURST in a
+// row. Of the frames above that only every _RATE_SAMPLE-th is forwarded
+// (0: none). _RATE_NODES devices (power of 2) are followed, 20 bytes each.
+// Off by default: frames of devices that send more often than the limit are
+// lost. Set _RATE_LIMIT to 1 and pick _RATE_PER_HOUR and _RATE_BURST above
+// the rate of your busiest device to enable it. The busiest devices are
+// then listed on the web page (Top Talkers) and in /api/talkers.
+#define _RATE_LIMIT 0
+#define _RATE_PER_HOUR 60
+#define _RATE_BURST 10
+#define _RATE_SAMPLE 10
+#define _RATE_NODES 256
 
 #if GATEWAYNODE == 1
 #define _DEVADDR               \
@@ -274,8 +348,10 @@
 // Values:
 // 0: Do not use names for trusted Nodes
 // 1: Use the nodes as a translation table for hex codes to names (in TLN)
-// 2: Same as 1, but is nodes NOT in the nodes list below they are NOT
-//		forwarded or counted! (not yet fully implemented)
+// 2: Same as 1, and frames are only forwarded when their DevAddr is on
+//		the allow list (or that list is empty) and not on the deny list.
+//		The lists live in ALLOWFILE/DENYFILE and can be changed through
+//		/api/lists, see nodeLists.cpp. The first allow list is nodes[].
 #define _TRUSTED_NODES 1
 /// \todo _TRUSTED_DECODE collides with _LOCALSERVER
 #define _TRUSTED_DECODE 1
@@ -311,6 +387,11 @@
 #include <gBase64.h> // https://github.com/adamvr/arduino-base64 (changed the name)
 
 // Local include files
+#if (GATEWAYNODE == 1) || (_LOCALSERVER == 1)
+#include "system/crypto/aes.h"  // lora_aes engine of the SX126x library
+#include "system/crypto/cmac.h" // MIC computation
+#endif
+
 #include "loraModem.h" // For RFM95 modules
 #include "loraFiles.h"
 #include "sensor.h"
@@ -329,10 +410,6 @@ extern "C"
 #include <WiFiManager.h> // Library for ESP WiFi config through an AP
 #endif
 
-#if (GATEWAYNODE == 1) || (_LOCALSERVER == 1)
-#include "AES-128_V10.h"
-#endif
-
 // ----------- Specific ESP32 stuff --------------
 #if ESP32_ARCH == 1 // IF ESP32
 
@@ -416,34 +493,78 @@ void ICACHE_RAM_ATTR Interrupt_0();
 void ICACHE_RAM_ATTR Interrupt_1();
 
 void ftoa(float f, char *val, int p); // main.cpp
+#if (GATEWAYNODE == 1) || (_LOCALSERVER == 1)
+void aesCheck(); // main.cpp
+#endif
 
 int sendPacket(uint8_t *buf, uint8_t length); // txRx.cpp
 int receivePacket();						  // txRx.cpp
+int rxFilter(uint8_t *payLoad, uint8_t payLength); // txRx.cpp
+int dedupCheck(uint8_t *payLoad, uint8_t payLength); // txRx.cpp
 
 void setupWWW();											   // wwwServer.cpp
 void printIP(IPAddress ipa, const char sep, String &response); // wwwServer.cpp
+void wwwEventRx(uint8_t *payLoad, uint8_t payLength, uint8_t sf, int prssi, long snr); // wwwServer.cpp
+void wwwEventTx(uint32_t freq, uint8_t sf, uint8_t len);							   // wwwServer.cpp
+void wwwEventLoop();																   // wwwServer.cpp
+void wwwEventSpec();																   // wwwServer.cpp
 
 void SerialTime();											 // utils.cpp
 void SerialStat(uint8_t intr);								 // utils.cpp
 void printHexDigit(uint8_t digit);							 // utils.cpp
-int inDecodes(char *id);									 // utils.cpp
-void stringTime(time_t t, String &response);				 // utils.cpp
-int SerialName(char *a, String &response);					 // utils.cpp
-void printHEX(char *hexa, const char sep, String &response); // utils.cpp
+void stringTime(time_t t, char *buf, int len);				 // utils.cpp
+int SerialName(char *a, char *buf, int len);				 // utils.cpp
+void printHEX(char *hexa, const char sep, char *buf);		 // utils.cpp
 void printTime();											 // utils.cpp
 
 void init_oLED(void);		// oLED.cpp
 void acti_oLED();			// oLED.cpp
 void addr_oLED();			// oLED.cpp
 void dispWriteHeader(void); // oLED.cpp
+void oledRx(int rssi, long snr, uint8_t len, uint8_t *message); // oLED.cpp
+void oledTask(void *pvParameters);								 // oLED.cpp
 
 void setupOta(char *hostname); // otaServer.cpp
 
+#if _LOCALSERVER == 1
+int sessionInit();																	 // sessions.cpp
+struct session *sessionFind(uint32_t addr);											 // sessions.cpp
+struct session *sessionFrame(const uint8_t *payLoad);								 // sessions.cpp
+struct session *sessionAt(int i);													 // sessions.cpp
+int sessionAdd(uint32_t addr, const char *nm, const uint8_t *nwkKey, const uint8_t *appKey); // sessions.cpp
+int sessionRemove(uint32_t addr);													 // sessions.cpp
+int sessionSave();																	 // sessions.cpp
+uint32_t sessionFcnt(struct session *s, uint16_t fcnt);								 // sessions.cpp
+void sessionSetFcnt(struct session *s, uint32_t fcnt);								 // sessions.cpp
+int sessionCheckpoint();																 // sessions.cpp
+extern int sessionCount;
+extern int sessionMax;
+#endif
+
+#if _RATE_LIMIT >= 1
+int rateCheck(uint32_t addr);					  // rateLimit.cpp
+int rateTop(struct rateNode **top, int n);		  // rateLimit.cpp
+#endif
+
+#if _TRUSTED_NODES >= 2
+void listInit();						 // nodeLists.cpp
+int listCheck(uint32_t addr);			 // nodeLists.cpp
+int listAdd(int which, uint32_t addr);	 // nodeLists.cpp
+int listRemove(int which, uint32_t addr); // nodeLists.cpp
+void listClear(int which);				 // nodeLists.cpp
+int listCount(int which);				 // nodeLists.cpp
+uint32_t listAt(int which, int i);		 // nodeLists.cpp
+int listSave(int which);				 // nodeLists.cpp
+#endif
+
 void addLog(const unsigned char *line, int cnt);		  // loraFiles.cpp
 int writeGwayCfg(const char *fn);						  // loraFiles.cpp
 int initConfig(struct espGwayConfig *c);				  // loraFiles.cpp
 int readConfig(const char *fn, struct espGwayConfig *c);  // loraFiles.cpp
 int writeConfig(const char *fn, struct espGwayConfig *c); // loraFiles.cpp
+int statRestore();										  // loraFiles.cpp
+int statCheckpoint();									  // loraFiles.cpp
+int statCompact();										  // loraFiles.cpp
 
 void initLoraModem();							 // loraModem.cpp
 void rxLoraModem();								 // loraModem.cpp
@@ -456,6 +577,13 @@ void setRate(uint8_t sf, uint8_t crc);			 // loraModem.cpp
 uint8_t receivePkt(uint8_t *payload);			 // loraModem.cpp
 void setFreq(uint32_t freq);					 // loraModem.cpp
 void startReceiver();							 // loraModem.cpp
+void radioWatchdog();							 // loraModem.cpp
+void radioLoopMark();							 // loraModem.cpp
+void radioIdle();								 // loraModem.cpp
+void specStart(uint32_t start, uint32_t stop, uint32_t step); // loraModem.cpp
+void specStop();								 // loraModem.cpp
+uint32_t specFreq(uint16_t bin);				 // loraModem.cpp
+void specLoop();								 // loraModem.cpp
 void txLoraModem(uint8_t *payLoad, uint8_t payLength, uint32_t tmst, uint8_t sfTx,
 				 uint8_t powe, uint32_t freq, uint8_t crc, uint8_t iiq); // loraModem.cpp
 
@@ -472,9 +600,16 @@ void updateOtaa(); // otaServer.cpp
 int WlanReadWpa();			 // wLan.cpp
 int WlanConnect(int maxTry); // wLan.cpp
 
+#if (GATEWAYNODE == 1) || (_LOCALSERVER == 1)
 uint8_t encodePacket(uint8_t *Data, uint8_t DataLength,
 					 uint16_t FrameCount, uint8_t *DevAddr,
 					 uint8_t *AppSKey, uint8_t Direction); // sensor.cpp
+uint8_t encodePacket(uint8_t *Data, uint8_t DataLength,
+					 uint16_t FrameCount, uint8_t *DevAddr,
+					 const lora_aes_context *aes, uint8_t Direction); // sensor.cpp
+void micCompute(AES_CMAC_CTX *cmac, const uint8_t *data, uint8_t len,
+				uint32_t fcnt, uint8_t dir, uint8_t *mic); // sensor.cpp
+#endif
 
 #if MUTEX == 1
 // Forward declarations
@@ -504,6 +639,9 @@ extern char platform[24];
 extern char email[40];
 extern char description[64];
 extern espGwayConfig gwayConfig;
+#if (GATEWAYNODE == 1) || (_LOCALSERVER == 1)
+extern bool aesOk;
+#endif
 
 #if A_SERVER == 1
 #if ESP32_ARCH == 1
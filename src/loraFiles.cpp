@@ -421,6 +421,357 @@ int writeConfig(const char *fn, struct espGwayConfig *c)
 	return (1);
 }
 
+#if (STATISTICS >= 1) && (_STAT_CHECKPOINT > 0)
+// ============================================================================
+// STATISTICS JOURNAL
+//
+// The statc counters are handled as an array of 32-bit words. A checkpoint
+// only appends the words that changed since the last checkpoint, as a
+// (index, delta) pair. Deltas are computed modulo 2^32 so a counter that was
+// reset to 0 from the web interface replays correctly as well.
+// New statr history entries are appended as separate records.
+//
+// Both files start with a statHdr. The layout of stat_c and stat_t depends
+// on the compile flags (_CHECK_MIC, _DEDUP, ...) so a snapshot or journal
+// written by another build is discarded instead of replayed into the wrong
+// counters.
+//
+// Snapshot layout:
+//	statHdr, statSeq, statc, statr, checksum
+// Journal record layout (after the statHdr):
+//	STATJ_CNT, n, n * (index, 4-byte delta), checksum
+//	STATJ_HIST, sizeof(stat_t) bytes of statr entry, checksum
+// A record that is truncated or has a wrong checksum (power loss during the
+// write) ends the replay.
+
+#define STATJ_MAGIC 0x5A
+#define STATJ_VERSION 2 // Increase when the file layout changes
+#define STATJ_CNT 0xA5
+#define STATJ_HIST 0xA6
+#define STATC_WORDS (sizeof(struct stat_c) / sizeof(uint32_t))
+
+struct statHdr
+{
+	uint8_t magic;	 // STATJ_MAGIC
+	uint8_t version; // STATJ_VERSION
+	uint8_t maxStat; // MAX_STAT
+	uint8_t spare;
+	uint16_t sizeC; // sizeof(struct stat_c)
+	uint16_t sizeT; // sizeof(struct stat_t)
+};
+
+static uint32_t statLast[STATC_WORDS]; // statc words as stored in flash
+static unsigned long statHistSeq = 0;  // statSeq of newest statr entry in flash
+
+// ----------------------------------------------------------------------------
+// Fill the header that matches the statc and statr layout of this build
+// ----------------------------------------------------------------------------
+static void statHdrMake(struct statHdr *hdr)
+{
+	memset(hdr, 0, sizeof(struct statHdr));
+	hdr->magic = STATJ_MAGIC;
+	hdr->version = STATJ_VERSION;
+	hdr->maxStat = MAX_STAT;
+	hdr->sizeC = sizeof(struct stat_c);
+	hdr->sizeT = sizeof(struct stat_t);
+}
+
+// ----------------------------------------------------------------------------
+// Read the header of a statistics file and compare it with this build
+// ----------------------------------------------------------------------------
+static bool statHdrCheck(File &f)
+{
+	struct statHdr hdr, cur;
+	statHdrMake(&cur);
+	if (f.read((uint8_t *)&hdr, sizeof(hdr)) != sizeof(hdr))
+	{
+		return (false);
+	}
+	return (memcmp(&hdr, &cur, sizeof(hdr)) == 0);
+}
+
+// ----------------------------------------------------------------------------
+// Simple 8-bit checksum over a buffer used for the journal records
+// ----------------------------------------------------------------------------
+static uint8_t statSum(const uint8_t *buf, int len)
+{
+	uint8_t sum = 0;
+	for (int i = 0; i < len; i++)
+	{
+		sum += buf[i];
+	}
+	return (sum);
+}
+
+// ----------------------------------------------------------------------------
+// Put a history entry in front of statr, like buildPacket() does
+// ----------------------------------------------------------------------------
+static void statPushHist(struct stat_t *h)
+{
+	for (int m = (MAX_STAT - 1); m > 0; m--)
+	{
+		statr[m] = statr[m - 1];
+	}
+	statr[0] = *h;
+	statSeq++;
+}
+
+// ----------------------------------------------------------------------------
+// STATCOMPACT
+// Write statc and statr as one snapshot and remove the journal.
+// The snapshot is first written to a temporary file and then renamed so
+// that a power loss never leaves us without a valid snapshot.
+// Parameters:
+//	<none>
+// Returns:
+//	1 when successful, -1 on error
+// ----------------------------------------------------------------------------
+int statCompact()
+{
+	uint8_t sum;
+	struct statHdr hdr;
+	uint32_t seq = statSeq;
+	File f = SPIFFS.open(STATSNAP ".tmp", "w");
+	if (!f)
+	{
+#if DUSB >= 1
+		if ((debug >= 1) && (pdebug & P_MAIN))
+			Serial.println(F("M ERROR:: statCompact, open failed"));
+#endif
+		return (-1);
+	}
+	statHdrMake(&hdr);
+	f.write((uint8_t *)&hdr, sizeof(hdr));
+	f.write((uint8_t *)&seq, sizeof(seq));
+	f.write((uint8_t *)&statc, sizeof(statc));
+	f.write((uint8_t *)statr, sizeof(statr));
+	sum = statSum((uint8_t *)&seq, sizeof(seq)) + statSum((uint8_t *)&statc, sizeof(statc)) + statSum((uint8_t *)statr, sizeof(statr));
+	f.write(sum);
+	f.close();
+
+	SPIFFS.remove(STATSNAP);
+	if (!SPIFFS.rename(STATSNAP ".tmp", STATSNAP))
+	{
+		return (-1);
+	}
+	SPIFFS.remove(STATJRNL);
+
+	memcpy(statLast, &statc, sizeof(statLast));
+	statHistSeq = seq;
+#if DUSB >= 1
+	if ((debug >= 1) && (pdebug & P_MAIN))
+		Serial.println(F("M statCompact:: done"));
+#endif
+	return (1);
+}
+
+// ----------------------------------------------------------------------------
+// STATCHECKPOINT
+// Append the changes of statc and the new statr entries since the last
+// checkpoint to the journal. Nothing is written if nothing changed.
+// Called from loop() every _STAT_CHECKPOINT seconds.
+// Parameters:
+//	<none>
+// Returns:
+//	0 when nothing to write, 1 when successful, -1 on error
+// ----------------------------------------------------------------------------
+int statCheckpoint()
+{
+	uint32_t cur[STATC_WORDS];
+	uint8_t rec[2 + (5 * STATC_WORDS) + 1];
+	uint8_t n = 0;
+	int len = 2;
+	int newHist = 0;
+
+	memcpy(cur, &statc, sizeof(cur));
+	for (uint8_t i = 0; i < STATC_WORDS; i++)
+	{
+		if (cur[i] != statLast[i])
+		{
+			uint32_t delta = cur[i] - statLast[i];
+			rec[len++] = i;
+			rec[len++] = delta & 0xFF;
+			rec[len++] = (delta >> 8) & 0xFF;
+			rec[len++] = (delta >> 16) & 0xFF;
+			rec[len++] = (delta >> 24) & 0xFF;
+			n++;
+		}
+	}
+	// Count the statr entries that were added since the last write. Entries
+	// that were already pushed out of statr are lost.
+	unsigned long seq = statSeq;
+	if ((seq - statHistSeq) > MAX_STAT)
+	{
+		newHist = MAX_STAT;
+	}
+	else
+	{
+		newHist = seq - statHistSeq;
+	}
+	if ((n == 0) && (newHist == 0))
+	{
+		return (0);
+	}
+
+	File f = SPIFFS.open(STATJRNL, "a");
+	if (!f)
+	{
+#if DUSB >= 1
+		if ((debug >= 1) && (pdebug & P_MAIN))
+			Serial.println(F("M ERROR:: statCheckpoint, open failed"));
+#endif
+		return (-1);
+	}
+	if (f.size() == 0)
+	{
+		struct statHdr hdr;
+		statHdrMake(&hdr);
+		f.write((uint8_t *)&hdr, sizeof(hdr));
+	}
+	if (n > 0)
+	{
+		rec[0] = STATJ_CNT;
+		rec[1] = n;
+		rec[len] = statSum(rec, len);
+		f.write(rec, len + 1);
+	}
+	// Oldest first, so the replay ends with the newest entry in statr[0]
+	for (int i = newHist - 1; i >= 0; i--)
+	{
+		f.write((uint8_t)STATJ_HIST);
+		f.write((uint8_t *)&statr[i], sizeof(struct stat_t));
+		f.write(statSum((uint8_t *)&statr[i], sizeof(struct stat_t)));
+	}
+	size_t jrnlSize = f.size();
+	f.close();
+
+	memcpy(statLast, cur, sizeof(statLast));
+	statHistSeq = seq;
+
+	if (jrnlSize > STATJRNLMAX)
+	{
+		return (statCompact());
+	}
+	return (1);
+}
+
+// ----------------------------------------------------------------------------
+// STATRESTORE
+// Read the snapshot and replay the journal on top of it to restore statc
+// and statr after a (re)boot. Called once from setup().
+// Parameters:
+//	<none>
+// Returns:
+//	Number of journal records replayed, -1 if there was no valid snapshot
+// ----------------------------------------------------------------------------
+int statRestore()
+{
+	int recs = 0;
+	uint8_t rec[2 + (5 * STATC_WORDS) + 1];
+	uint32_t cur[STATC_WORDS];
+	struct stat_t h;
+
+	bool valid = false;
+	File f = SPIFFS.open(STATSNAP, "r");
+	if (f && statHdrCheck(f) && (f.size() == (sizeof(struct statHdr) + sizeof(uint32_t) + sizeof(statc) + sizeof(statr) + 1)))
+	{
+		uint32_t seq;
+		struct stat_c c;
+		struct stat_t r[MAX_STAT];
+		f.read((uint8_t *)&seq, sizeof(seq));
+		f.read((uint8_t *)&c, sizeof(c));
+		f.read((uint8_t *)r, sizeof(r));
+		if (f.read() == (uint8_t)(statSum((uint8_t *)&seq, sizeof(seq)) + statSum((uint8_t *)&c, sizeof(c)) + statSum((uint8_t *)r, sizeof(r))))
+		{
+			statSeq = seq;
+			statc = c;
+			memcpy(statr, r, sizeof(statr));
+			valid = true;
+		}
+	}
+	if (f)
+	{
+		f.close();
+	}
+	if (!valid)
+	{
+		// Missing, damaged or written by another build. The journal deltas
+		// belong to that snapshot so they are dropped as well.
+#if DUSB >= 1
+		if ((debug >= 0) && (pdebug & P_MAIN))
+			Serial.println(F("M statRestore:: no valid snapshot, statistics not restored"));
+#endif
+		SPIFFS.remove(STATJRNL);
+		statCompact();
+		return (-1);
+	}
+	memcpy(cur, &statc, sizeof(cur));
+
+	f = SPIFFS.open(STATJRNL, "r");
+	if (f && !statHdrCheck(f))
+	{
+		f.close(); // Not ours, statCompact() below removes it
+	}
+	while (f && f.available())
+	{
+		int type = f.read();
+		if (type == STATJ_CNT)
+		{
+			rec[0] = type;
+			rec[1] = f.read();
+			int len = 2 + (5 * rec[1]);
+			if ((rec[1] > STATC_WORDS) || (f.read(&rec[2], len - 2 + 1) != (size_t)(len - 2 + 1)) || (rec[len] != statSum(rec, len)))
+			{
+				break; // Torn record, stop here
+			}
+			for (int i = 2; i < len; i += 5)
+			{
+				if (rec[i] < STATC_WORDS)
+				{
+					cur[rec[i]] += (uint32_t)rec[i + 1] | ((uint32_t)rec[i + 2] << 8) | ((uint32_t)rec[i + 3] << 16) | ((uint32_t)rec[i + 4] << 24);
+				}
+			}
+		}
+		else if (type == STATJ_HIST)
+		{
+			if ((f.read((uint8_t *)&h, sizeof(h)) != sizeof(h)) || (f.read() != statSum((uint8_t *)&h, sizeof(h))))
+			{
+				break;
+			}
+			statPushHist(&h);
+		}
+		else
+		{
+			break;
+		}
+		recs++;
+	}
+	if (f)
+	{
+		f.close();
+	}
+	memcpy(&statc, cur, sizeof(cur));
+
+#if DUSB >= 1
+	if ((debug >= 0) && (pdebug & P_MAIN))
+	{
+		Serial.print(F("M statRestore:: msg_ttl="));
+		Serial.print(statc.msg_ttl);
+		Serial.print(F(", records="));
+		Serial.println(recs);
+	}
+#endif
+	// Start with a fresh snapshot so the journal is short again
+	statCompact();
+	return (recs);
+}
+
+#else
+int statRestore() { return (0); }
+int statCheckpoint() { return (0); }
+int statCompact() { return (0); }
+#endif // STATISTICS _STAT_CHECKPOINT
+
 // ----------------------------------------------------------------------------
 // Add a line with statistics to the log.
 //
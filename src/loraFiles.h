@@ -59,6 +59,28 @@
 #define P_GUI 0x40
 #define P_RADIO 0x80
 
+// Files used to keep the statistics over a reboot.
+// STATSNAP holds a full copy of statc and statr, written only on compaction.
+// STATJRNL holds the delta records appended by every checkpoint.
+// Both files start with a header holding the size of stat_c and stat_t, so
+// they are discarded when a build with another layout reads them.
+// Flash wear with the defaults, see tools/statWear.py for other settings:
+// at 60 uplinks/h a checkpoint appends 18 bytes of counters plus 38 bytes per
+// new statr entry, ~60 KB/day. That is ~15 compactions and ~16 SPIFFS block
+// erases a day. A quiet gateway writes nothing at all. A full writeConfig()
+// rewrite every 5 minutes would cost at least 288 block erases a day.
+#define STATSNAP "/statSnap"
+#define STATJRNL "/statJrnl"
+#define STATJRNLMAX 4096
+
+// Device sessions of _LOCALSERVER, one fixed size record per device.
+// Rewritten (via a temporary file) only when a device is added or removed.
+#define SESSIONFILE "/sessions"
+
+// DevAddr allow and deny lists of _TRUSTED_NODES 2, sorted addresses
+#define ALLOWFILE "/allow"
+#define DENYFILE "/deny"
+
 // Define a log record to be written to the log file
 // Keep logfiles SHORT in name! to save memory
 #if STAT_LOG == 1
@@ -31,7 +31,6 @@
 // Author: Bernd Giesecke (https://github.com/beegee-tokyo)
 //
 // Port is work in progress
-// CAD and HOP is not supported for SX1262 chips
 // Downlink is not working
 // Compiles under PlatformIO only
 // ********************************************************************************
@@ -177,9 +176,9 @@ volatile uint8_t _event = 0;
 // so we need to store the current value we like to work with
 uint8_t _rssi;
 
-/// \todo CAD and HOP are not supported by SX1262 (yet)
 bool _cad = (bool)_CAD;  // Set to true for Channel Activity Detection, only when dio 1 connected
 bool _hop = (bool)false; // experimental; frequency hopping. Only use when dio2 connected
+bool _sniff = (bool)_SNIFF; // SX1262 RX duty cycle instead of continuous RX
 
 unsigned long nowTime = 0;
 unsigned long msgTime = 0;
@@ -314,6 +313,7 @@ struct stat_c statc;
 
 // History of received uplink messages from nodes
 struct stat_t statr[MAX_STAT];
+unsigned long statSeq = 0; // Increased for every new statr[0]
 
 #else // STATISTICS==0
 struct stat_t statr[1]; // Always have at least one element to store in
@@ -450,6 +450,118 @@ String gwFreq = "NONE";
 
 static RadioEvents_t RadioEvents;
 
+struct spiTime spiMark = {0, 0, 0, 0, 0};
+struct spiTime spiRx = {0, 0, 0, 0, 0};
+
+// ----------------------------------------------------------------------------
+// RADIO LOOP MARK
+// Called from loop() right before Radio.IrqProcess(). Measures the gap since
+// the previous call, the latency with which a radio event is handled.
+// ----------------------------------------------------------------------------
+struct radioLoop radioLoop = {0, 0, 0};
+
+void radioLoopMark()
+{
+	static uint32_t mark = 0, winStart = 0, peak = 0, sum = 0, n = 0;
+	uint32_t t = micros();
+	if (mark == 0)
+	{
+		mark = t;
+		winStart = t;
+		return;
+	}
+	uint32_t gap = t - mark;
+	mark = t;
+	if (gap > peak)
+		peak = gap;
+	if (gap > radioLoop.max)
+		radioLoop.max = gap;
+	sum += gap;
+	n++;
+	if ((t - winStart) >= RADIO_LOOP_WIN)
+	{
+		radioLoop.win = peak;
+		radioLoop.avg = sum / n;
+		winStart = t;
+		peak = 0;
+		sum = 0;
+		n = 0;
+	}
+}
+
+// ----------------------------------------------------------------------------
+// RADIO IDLE
+// Called by the webserver while a page waits for a slow client, so radio
+// events are handled as if loop() were running.
+// ----------------------------------------------------------------------------
+void radioIdle()
+{
+	radioLoopMark();
+	Radio.IrqProcess();
+}
+
+// CAD scanner. The SX1262 demodulates one SF at a time, so with _cad set
+// the gateway runs CAD over SF7..SF12 and receives on the SF that shows
+// activity. The exit mode LORA_CAD_RX lets the radio go from a detection
+// straight into RX, without a round trip through the ESP32 while the
+// preamble runs out.
+// Symbols and detection peak per SF for 125 kHz, after Semtech AN1200.48.
+// Two symbols keep the slow SFs short enough to come back to SF7 often.
+#define CAD_DET_MIN 10
+#define CAD_RX_SYMBOLS 22 // Rest of the preamble, sync word and header
+
+struct cadParam
+{
+	uint8_t symbols; // RadioLoRaCadSymbols_t
+	uint8_t detPeak;
+};
+
+static const struct cadParam cadParams[6] = {
+	{LORA_CAD_02_SYMBOL, 22}, // SF7
+	{LORA_CAD_02_SYMBOL, 22}, // SF8
+	{LORA_CAD_02_SYMBOL, 23}, // SF9
+	{LORA_CAD_02_SYMBOL, 24}, // SF10
+	{LORA_CAD_02_SYMBOL, 25}, // SF11
+	{LORA_CAD_02_SYMBOL, 28}  // SF12
+};
+
+struct cadStat cadStats[6];
+
+static uint8_t cadSf = SF7; // SF of the running CAD or the RX after it
+static uint8_t cadSlot = 0; // Position in the scan sequence
+
+// Channel hopping. With _hop set the scanner stays on a channel for its
+// dwell time, then hop() tunes to the next of the first NUM_HOPS channels.
+// The dwell follows the detections seen on each channel, so busy channels
+// get more of the time while quiet ones are still visited every round.
+struct hopStat hopStats[NUM_HOPS];
+
+static uint32_t hopDet = 0;				 // Detections on this visit
+static uint16_t hopDwell = HOP_DWELL_MIN; // Dwell of this visit
+
+static uint8_t cadNext();
+static void cadStart(uint8_t sfi);
+
+// Sniff mode. A window has to fit in the preamble wherever the preamble
+// starts, so rx + sleep + rx <= preamble. One symbol of margin keeps it
+// that way with the +-2% drift of the RC64k timer. The wakeup time of the
+// radio (TCXO start) is spent in RX current at the end of each sleep, when
+// the sleep is not longer than that sniffing does not pay off and the
+// radio stays in continuous RX.
+// Currents are SX1262 datasheet typicals for LoRa 125 kHz with DC-DC.
+#define SNIFF_RX_SYMBOLS 2
+#define SNIFF_MARGIN_SYMBOLS 1
+// A window that sees a preamble stops its timer and the radio stays in RX.
+// On a false detection no header ever comes, the symbol timeout ends that
+// RX a few symbols past the preamble and its sync word (4.25 symbols) so
+// OnRxTimeout() starts the duty cycle again.
+#define SNIFF_SYMBOL_TIMEOUT (LORA_PREAMBLE_LENGTH + 5 + 2)
+#define SNIFF_UA_RX 4600 // RX
+#define SNIFF_UA_SLEEP 1 // Sleep with the RTC running
+struct sniffPlan sniff = {0, 0, SNIFF_UA_RX};
+
+static void sniffSchedule(uint8_t sfi);
+
 hw_config hwConfig;
 
 void initLoraModem()
@@ -482,9 +594,11 @@ void initLoraModem()
 
 	// Initialize the Radio
 	Radio.Init(&RadioEvents);
+	// With a TCXO the chip flags XOSC start at power up, see radioWatchdog()
+	SX126xClearDeviceErrors();
 
 	// Set Radio channel
-	Radio.SetChannel(RF_FREQUENCY);
+	setFreq(freqs[ifreq].upFreq);
 
 	// Set Radio TX configuration
 	Radio.SetTxConfig(MODEM_LORA, TX_OUTPUT_POWER, 0, LORA_BANDWIDTH,
@@ -493,7 +607,7 @@ void initLoraModem()
 					  true, 0, 0, LORA_IQ_INVERSION_ON, TX_TIMEOUT_VALUE);
 
 	// Set Radio RX configuration
-	Radio.SetRxConfig(MODEM_LORA, LORA_BANDWIDTH, LORA_SPREADING_FACTOR,
+	Radio.SetRxConfig(MODEM_LORA, LORA_BANDWIDTH, sf,
 					  LORA_CODINGRATE, 0, LORA_PREAMBLE_LENGTH,
 					  LORA_SYMBOL_TIMEOUT, LORA_FIX_LENGTH_PAYLOAD_ON,
 					  0, true, 0, 0, LORA_IQ_INVERSION_ON, true);
@@ -505,6 +619,25 @@ void initLoraModem()
 	Radio.Rx(0);
 }
 
+// ----------------------------------------------------------------------------
+// Back to listening, on the fixed SF or with a new CAD scan
+// ----------------------------------------------------------------------------
+static void rxResume()
+{
+	if ((_cad) || (_hop))
+	{
+		cadScanner();
+	}
+	else if (_sniff)
+	{
+		rxLoraModem();
+	}
+	else
+	{
+		Radio.Rx(0);
+	}
+}
+
 /**@brief Function to be executed on Radio Tx Done event
  */
 void OnTxDone(void)
@@ -531,13 +664,21 @@ void OnTxDone(void)
 	}
 #endif
 	// Back to listening
-	Radio.Rx(0);
+	rxResume();
 }
 
 /**@brief Function to be executed on Radio Rx Done event
  */
 void OnRxDone(uint8_t *payload, uint16_t size, int16_t rssi, int8_t snr)
 {
+	SX126xGetSpiStats(&spiRx.us, &spiRx.calls);
+	spiRx.us -= spiMark.us;
+	spiRx.calls -= spiMark.calls;
+	SX126xGetBusyStats(&spiRx.busy, &spiRx.waits, &spiRx.timeouts);
+	spiRx.busy -= spiMark.busy;
+	spiRx.waits -= spiMark.waits;
+	spiRx.timeouts -= spiMark.timeouts;
+
 	// There should not be an error in the message
 	LoraUp.payLoad[0] = 0x00; // Empty the message
 	LoraUp.payLength = size;
@@ -545,11 +686,23 @@ void OnRxDone(uint8_t *payload, uint16_t size, int16_t rssi, int8_t snr)
 	LoraUp.snr = snr;
 	LoraUp.prssi = rssi;
 	LoraUp.rssicorr = 0;
-	LoraUp.sf = 7;
+	if (_cad)
+	{
+		LoraUp.sf = cadSf;
+		cadStats[cadSf - SF7].rx++;
+	}
+	else
+	{
+		LoraUp.sf = sf;
+	}
+	if ((_hop) && (ifreq < NUM_HOPS))
+	{
+		hopStats[ifreq].rx++;
+	}
 
 	// If read was successful, read the package from the LoRa bus
 	//
-	if (receivePacket() <= 0)
+	if (receivePacket() < 0)
 	{ // read is not successful
 #if DUSB >= 1
 		if ((debug >= 0) && (pdebug & P_RX))
@@ -600,7 +753,7 @@ void OnRxDone(uint8_t *payload, uint16_t size, int16_t rssi, int8_t snr)
 		Radio.Send(LoraDown.payLoad, LoraDown.payLength);
 	}
 	// Back to listening
-	Radio.Rx(0);
+	rxResume();
 }
 
 /**@brief Function to be executed on Radio Tx Timeout event
@@ -614,7 +767,7 @@ void OnTxTimeout(void)
 	}
 #endif
 	// Back to listening
-	Radio.Rx(0);
+	rxResume();
 }
 
 /**@brief Function to be executed on Radio Rx Timeout event
@@ -628,7 +781,7 @@ void OnRxTimeout(void)
 	}
 #endif
 	// Back to listening
-	Radio.Rx(0);
+	rxResume();
 }
 
 /**@brief Function to be executed on Radio Rx Error event
@@ -642,15 +795,38 @@ void OnRxError(void)
 	}
 #endif
 	// Back to listening
-	Radio.Rx(0);
+	rxResume();
 }
 
-/**@brief Function to be executed on Radio Rx Error event
+/**@brief Function to be executed on Radio CAD Done event
  */
 void OnCadDone(bool cadResult)
 {
-	// Back to listening
-	Radio.Rx(0);
+	if ((!_cad) && (!_hop))
+	{
+		Radio.Rx(0);
+		return;
+	}
+	if (cadResult)
+	{
+		// The radio is in RX on cadSf already, see LORA_CAD_RX
+		cadStats[cadSf - SF7].detects++;
+		hopDet++;
+#if DUSB >= 2
+		if ((debug >= 2) && (pdebug & P_CAD))
+		{
+			Serial.print(F("CAD:: detect SF"));
+			Serial.println(cadSf);
+		}
+#endif
+		return;
+	}
+	if ((_hop) && ((uint32_t)(millis() - hopTime) >= hopDwell))
+	{
+		hop();
+		cadSlot = 0;
+	}
+	cadStart(cadNext());
 }
 
 //********************************************************************
@@ -673,8 +849,20 @@ void setRate(uint8_t sf, uint8_t crc)
 {
 }
 
+// ----------------------------------------------------------------------------
+// Tune the SX1262. The driver only calibrates the image again when freq is
+// in another band, so this is cheap within the frequency plan.
+// ----------------------------------------------------------------------------
 void setFreq(uint32_t freq)
 {
+	if (Radio.GetStatus() != RF_IDLE)
+	{
+		Radio.Standby();
+	}
+	Radio.SetChannel(freq);
+	hopTime = millis();
+	hopDet = 0;
+	hopDwell = HOP_DWELL_MIN;
 }
 
 void setPow(uint8_t powe)
@@ -685,8 +873,88 @@ void opmode(uint8_t mode)
 {
 }
 
+// ----------------------------------------------------------------------------
+// Leave the channel ifreq for the next one. The detection rate of the visit
+// goes into a running average per channel (detections per 1000 seconds),
+// and the next channel gets HOP_DWELL_MIN plus its share of the rest.
+// ----------------------------------------------------------------------------
 void hop()
 {
+	uint32_t ms = millis() - hopTime;
+	uint32_t sum = 0;
+
+	if (ifreq < NUM_HOPS)
+	{
+		struct hopStat *h = &hopStats[ifreq];
+		h->ms += ms;
+		h->detects += hopDet;
+		h->rate = (3 * h->rate + (hopDet * 1000000UL) / (ms + 1)) / 4;
+	}
+	ifreq = (ifreq + 1) % NUM_HOPS;
+
+	setFreq(freqs[ifreq].upFreq);
+
+	for (int i = 0; i < NUM_HOPS; i++)
+	{
+		sum += hopStats[i].rate;
+	}
+	if (sum > 0)
+	{
+		hopDwell = HOP_DWELL_MIN +
+				   (uint16_t)(((uint64_t)(HOP_DWELL_MAX - HOP_DWELL_MIN) * hopStats[ifreq].rate) / sum);
+	}
+	hopStats[ifreq].dwell = hopDwell;
+	hopStats[ifreq].visits++;
+#if DUSB >= 2
+	if ((debug >= 2) && (pdebug & P_CAD))
+	{
+		Serial.print(F("HOP:: ch="));
+		Serial.print(ifreq);
+		Serial.print(F(" dwell="));
+		Serial.println(hopDwell);
+	}
+#endif
+}
+
+// ----------------------------------------------------------------------------
+// Next SF of the CAD scan. The preamble of a SF is half as long as the one
+// of the next SF, so SF7 is checked every 2nd CAD, SF8 every 4th and so
+// on up to SF12 every 32nd (a ruler sequence). Without _cad only the
+// SF set in the web interface is scanned.
+// ----------------------------------------------------------------------------
+static uint8_t cadNext()
+{
+	if (!_cad)
+	{
+		return (sf); // Hopping on a fixed SF
+	}
+	cadSlot = (cadSlot % 32) + 1;
+	return (SF7 + __builtin_ctz(cadSlot));
+}
+
+// ----------------------------------------------------------------------------
+// Start one CAD on sfi. The RX after a detection times out after
+// CAD_RX_SYMBOLS symbols (in 15.625 us steps) unless a header was found.
+// The configuration shadow of the driver only sends what changed.
+// ----------------------------------------------------------------------------
+static void cadStart(uint8_t sfi)
+{
+	const struct cadParam *p = &cadParams[sfi - SF7];
+	uint32_t rxTicks = (((uint32_t)CAD_RX_SYMBOLS << sfi) * 64) / 125;
+
+	cadSf = sfi;
+	if (Radio.GetStatus() != RF_IDLE)
+	{
+		Radio.Standby();
+	}
+	Radio.SetRxConfig(MODEM_LORA, LORA_BANDWIDTH, sfi,
+					  LORA_CODINGRATE, 0, LORA_PREAMBLE_LENGTH,
+					  0, LORA_FIX_LENGTH_PAYLOAD_ON,
+					  0, true, 0, 0, LORA_IQ_INVERSION_ON, false);
+	SX126xSetCadParams((RadioLoRaCadSymbols_t)p->symbols, p->detPeak, CAD_DET_MIN, LORA_CAD_RX, rxTicks);
+	SX126xSetDioIrqParams(IRQ_RADIO_ALL, IRQ_RADIO_ALL, IRQ_RADIO_NONE, IRQ_RADIO_NONE);
+	Radio.StartCad();
+	cadStats[sfi - SF7].scans++;
 }
 
 uint8_t receivePkt(uint8_t *payload)
@@ -704,18 +972,338 @@ void txLoraModem(uint8_t *payLoad, uint8_t payLength, uint32_t tmst, uint8_t sfT
 {
 }
 
+// ----------------------------------------------------------------------------
+// RX duty cycle for sfi, see SNIFF_RX_SYMBOLS. The symbol time at 125 kHz
+// is 2^sf * 8 microseconds.
+// ----------------------------------------------------------------------------
+static void sniffSchedule(uint8_t sfi)
+{
+	uint32_t sym = ((uint32_t)1 << sfi) * 8;
+	uint32_t wake = Radio.GetWakeupTime() * 1000;
+	uint32_t rx = SNIFF_RX_SYMBOLS * sym;
+	uint32_t sleep = (LORA_PREAMBLE_LENGTH - 2 * SNIFF_RX_SYMBOLS - SNIFF_MARGIN_SYMBOLS) * sym;
+
+	if (sleep <= wake)
+	{
+		return; // Continuous RX
+	}
+	sniff.rx = rx;
+	sniff.sleep = sleep;
+	sniff.ua = ((uint64_t)SNIFF_UA_RX * (rx + wake) + (uint64_t)SNIFF_UA_SLEEP * (sleep - wake)) / (rx + sleep);
+}
+
+// ----------------------------------------------------------------------------
+// RX on the SF set in the web interface, continuous or in sniff mode
+// ----------------------------------------------------------------------------
 void rxLoraModem()
 {
+	sniff.rx = 0;
+	sniff.sleep = 0;
+	sniff.ua = SNIFF_UA_RX;
+	if (_sniff)
+	{
+		sniffSchedule(sf);
+	}
+	Radio.Standby();
+	Radio.SetRxConfig(MODEM_LORA, LORA_BANDWIDTH, sf,
+					  LORA_CODINGRATE, 0, LORA_PREAMBLE_LENGTH,
+					  (sniff.rx == 0) ? LORA_SYMBOL_TIMEOUT : SNIFF_SYMBOL_TIMEOUT,
+					  LORA_FIX_LENGTH_PAYLOAD_ON,
+					  0, true, 0, 0, LORA_IQ_INVERSION_ON, (sniff.rx == 0));
+	if (sniff.rx == 0)
+	{
+		Radio.Rx(0);
+	}
+	else
+	{
+		SX126xSetDioIrqParams(IRQ_RADIO_ALL, IRQ_RADIO_ALL, IRQ_RADIO_NONE, IRQ_RADIO_NONE);
+		Radio.SetRxDutyCycle((sniff.rx * 64) / 1000, (sniff.sleep * 64) / 1000);
+	}
 }
 
+// ----------------------------------------------------------------------------
+// (Re)start the CAD scan at SF7
+// ----------------------------------------------------------------------------
 void cadScanner()
 {
+	cadSlot = 0;
+	cadStart(cadNext());
 }
 
 void startReceiver()
 {
 }
 
+// ----------------------------------------------------------------------------
+// Radio watchdog, called from loop() when no message came in for a while.
+// It reads status, device errors, the sync word and pending IRQs from the
+// SX1262 (four short SPI reads) and only acts when something is wrong:
+// - BUSY stuck, device errors or a sync word back at its reset value: the
+//   radio is reset and configured again
+// - IRQs still pending since the last check: the DIO1 edge was missed, the
+//   IRQs are cleared and receiving starts again
+// - neither RX nor TX as the driver expects: receiving starts again
+// A healthy radio is never taken out of RX.
+// ----------------------------------------------------------------------------
+struct radioHealth radioHealth;
+
+static uint16_t wdIrq = 0; // IRQs pending at the last check
+
+void radioWatchdog()
+{
+	uint32_t start = micros();
+	uint32_t us, waits, to0, to1;
+	RadioStatus_t st;
+	RadioError_t err;
+	uint8_t sync[2];
+	uint16_t irq;
+	uint8_t mode;
+	uint8_t drv = SX126xGetOperatingMode();
+
+	radioHealth.checks++;
+	SX126xGetBusyStats(&us, &waits, &to0);
+	st = SX126xGetStatus();
+	err = SX126xGetDeviceErrors();
+	SX126xReadRegisters(REG_LR_SYNCWORD, sync, 2); // 2 bytes are never taken from the shadow
+	irq = SX126xGetIrqStatus();
+	SX126xGetBusyStats(&us, &waits, &to1);
+	radioHealth.status = st.Value;
+	mode = st.Fields.ChipMode;
+
+	if ((to1 != to0) || (err.Value != 0) ||
+		(sync[0] != (uint8_t)(LORA_MAC_PUBLIC_SYNCWORD >> 8)) ||
+		(sync[1] != (uint8_t)(LORA_MAC_PUBLIC_SYNCWORD & 0xFF)))
+	{
+		radioHealth.resets++;
+		radioHealth.error = err.Value;
+		initLoraModem();
+		rxResume();
+		wdIrq = 0;
+	}
+	else if ((irq != 0) && (wdIrq != 0))
+	{
+		radioHealth.irqs++;
+		SX126xClearIrqStatus(IRQ_RADIO_ALL);
+		rxResume();
+		wdIrq = 0;
+	}
+	else if (irq != 0)
+	{
+		wdIrq = irq; // Give Radio.IrqProcess() until the next check
+		return;
+	}
+	else if (drv == MODE_RX_DC)
+	{
+		wdIrq = 0;
+		rxResume(); // The reads woke the radio out of its duty cycle
+		return;
+	}
+	else if (((mode == 0x5) && ((drv == MODE_RX) || (drv == MODE_CAD))) ||
+			 ((mode == 0x6) && (drv == MODE_TX)))
+	{
+		wdIrq = 0;
+		return; // Receiving or sending, as expected
+	}
+	else
+	{
+		radioHealth.rearms++;
+		rxResume();
+		wdIrq = 0;
+	}
+	radioHealth.us = micros() - start;
+
+#if DUSB >= 1
+	if ((debug >= 1) && (pdebug & P_MAIN))
+	{
+		Serial.print(F("M WATCHDOG:: status=0x"));
+		Serial.print(st.Value, HEX);
+		Serial.print(F(" errors=0x"));
+		Serial.print(err.Value, HEX);
+		Serial.print(F(" irq=0x"));
+		Serial.print(irq, HEX);
+		Serial.print(F(" us="));
+		Serial.println(radioHealth.us);
+	}
+#endif
+}
+
+// ----------------------------------------------------------------------------
+// SPECTRUM SCANNER
+// Sweeps the channels of freqs[] or a range of frequencies and keeps the
+// min, average and max RSSI per bin. Every completed sweep is pushed to the
+// web interface, which draws it as one line of a waterfall.
+// ----------------------------------------------------------------------------
+struct specScan spec;
+struct specBin specLast[SPEC_BINS];
+
+static struct specBin specCur[SPEC_BINS];
+static uint32_t specTime = 0; // millis() of the last slice
+
+static void specClear()
+{
+	for (int i = 0; i < SPEC_BINS; i++)
+	{
+		specCur[i].min = 0;
+		specCur[i].max = -128;
+		specCur[i].sum = 0;
+	}
+	spec.bin = 0;
+}
+
+// ----------------------------------------------------------------------------
+// Start sweeping from start to stop in steps of step Hz. With start 0 the
+// channels of the frequency plan are swept instead.
+// ----------------------------------------------------------------------------
+void specStart(uint32_t start, uint32_t stop, uint32_t step)
+{
+	if (start == 0)
+	{
+		spec.bins = 0;
+		for (int i = 0; i < (int)(sizeof(freqs) / sizeof(freqs[0])); i++)
+		{
+			if ((freqs[i].upFreq != 0) && (spec.bins < SPEC_BINS))
+			{
+				spec.bins++;
+			}
+		}
+		spec.step = 0;
+	}
+	else
+	{
+		if ((step == 0) || (stop < start))
+		{
+			return;
+		}
+		spec.bins = ((stop - start) / step) + 1;
+		if (spec.bins > SPEC_BINS)
+		{
+			spec.bins = SPEC_BINS;
+		}
+		spec.step = step;
+	}
+	spec.start = start;
+	spec.sweeps = 0;
+	memset(specLast, 0, sizeof(specLast));
+	specClear();
+	spec.on = (spec.bins > 0);
+}
+
+void specStop()
+{
+	spec.on = false;
+}
+
+// ----------------------------------------------------------------------------
+// Frequency of a bin in Hz
+// ----------------------------------------------------------------------------
+uint32_t specFreq(uint16_t bin)
+{
+	if (spec.start != 0)
+	{
+		return (spec.start + bin * spec.step);
+	}
+	for (int i = 0; i < (int)(sizeof(freqs) / sizeof(freqs[0])); i++)
+	{
+		if (freqs[i].upFreq == 0)
+		{
+			continue;
+		}
+		if (bin == 0)
+		{
+			return (freqs[i].upFreq);
+		}
+		bin--;
+	}
+	return (0);
+}
+
+// ----------------------------------------------------------------------------
+// A slice can be taken when no packet is being received or sent and no
+// downlink is waiting. In the CAD scanner and in sniff mode RX means that a
+// packet was detected.
+// ----------------------------------------------------------------------------
+static bool specIdle()
+{
+	if ((_state == S_TX) || SX126xGetRxHeaderValid())
+	{
+		return (false);
+	}
+	switch (SX126xGetOperatingMode())
+	{
+	case MODE_TX:
+		return (false);
+	case MODE_RX:
+		return ((!_cad) && (!_hop) && (!_sniff));
+	default:
+		return (true);
+	}
+}
+
+// ----------------------------------------------------------------------------
+// Sample bins for up to SPEC_SLICE_US, then go back to receiving. The TCXO
+// keeps running in STDBY_XOSC between the bins and the DIO1 IRQs are off,
+// so nothing is received on a scanned frequency.
+// ----------------------------------------------------------------------------
+static void specSlice()
+{
+	uint32_t start = micros();
+
+	SX126xSetStandby(STDBY_XOSC);
+	SX126xSetDioIrqParams(IRQ_RADIO_NONE, IRQ_RADIO_NONE, IRQ_RADIO_NONE, IRQ_RADIO_NONE);
+	do
+	{
+		struct specBin *b = &specCur[spec.bin];
+
+		Radio.SetChannel(specFreq(spec.bin));
+		SX126xSetRx(0xFFFFFF);
+		delayMicroseconds(SPEC_SETTLE_US);
+		for (int i = 0; i < SPEC_SAMPLES; i++)
+		{
+			int8_t rssi = SX126xGetRssiInst();
+			b->sum += rssi;
+			if (rssi < b->min)
+			{
+				b->min = rssi;
+			}
+			if (rssi > b->max)
+			{
+				b->max = rssi;
+			}
+		}
+		SX126xSetStandby(STDBY_XOSC);
+
+		spec.bin++;
+		if (spec.bin == spec.bins)
+		{
+			memcpy(specLast, specCur, sizeof(specLast));
+			spec.sweeps++;
+			specClear();
+#if A_SERVER == 1
+			wwwEventSpec();
+#endif
+			break;
+		}
+	} while ((micros() - start) < SPEC_SLICE_US);
+
+	SX126xClearIrqStatus(IRQ_RADIO_ALL);
+	Radio.SetChannel(freqs[ifreq].upFreq);
+	rxResume();
+	spec.us = micros() - start;
+}
+
+// ----------------------------------------------------------------------------
+// Called from loop(), takes the next slice when it is due
+// ----------------------------------------------------------------------------
+void specLoop()
+{
+	if ((!spec.on) || ((millis() - specTime) < SPEC_PERIOD) || (!specIdle()))
+	{
+		return;
+	}
+	specTime = millis();
+	specSlice();
+}
+
 #else
 //********************************************************************
 // This stuff is for SX127X only.
@@ -1189,7 +1777,7 @@ uint8_t receivePkt(uint8_t *payload)
 			if (debug >= 1)
 			{			   // Must be 1 for operational use
 #if _TRUSTED_DECODE == 2
-				int index; // The index of the codex struct to decode
+				struct session *node; // The session to decode with
 				String response = "";
 
 				uint8_t data[receivedCount];
@@ -1200,10 +1788,10 @@ uint8_t receivePkt(uint8_t *payload)
 				DevAddr[2] = payload[2];
 				DevAddr[3] = payload[1];
 
-				if ((index = inDecodes((char *)(payload + 1))) >= 0)
+				if ((node = sessionFrame(payload)) != NULL)
 				{
-					Serial.print(F(", Ind="));
-					Serial.print(index);
+					Serial.print(F(", Node="));
+					Serial.print(node->nm);
 					//Serial.println();
 				}
 				else if (debug >= 1)
@@ -1231,7 +1819,7 @@ uint8_t receivePkt(uint8_t *payload)
 
 				// The message received has a length, but data starts at byte 9, and stops 4 bytes
 				// before the end since those are MIC bytes
-				uint8_t CodeLength = encodePacket((uint8_t *)(data + 9), receivedCount - 9 - 4, (uint16_t)frameCount, DevAddr, decodes[index].appKey, 0);
+				uint8_t CodeLength = encodePacket((uint8_t *)(data + 9), receivedCount - 9 - 4, (uint16_t)frameCount, DevAddr, &node->app, 0);
 
 				Serial.print(F("- NEW fc="));
 				Serial.print(frameCount);
@@ -63,6 +63,21 @@ struct codex
 };
 
 extern struct codex decodes[KNOWN_NODES];
+
+#if _LOCALSERVER == 1
+// A device session as used at runtime, see sessions.cpp. The keys are kept
+// expanded so decoding and MIC computation never run the key schedule.
+struct session
+{
+	uint32_t addr;		// DevAddr
+	uint32_t fcnt;		// Last frame counter seen, 32 bits
+	char nm[32];		// Name
+	uint8_t nwkKey[16]; // NwkSKey
+	uint8_t appKey[16]; // AppSKey
+	lora_aes_context app; // AppSKey key schedule for the payload
+	AES_CMAC_CTX nwk;	  // NwkSKey key schedule and subkeys for the MIC
+};
+#endif
 #endif
 
 // ----------------------------------------
@@ -77,6 +92,13 @@ extern struct codex decodes[KNOWN_NODES];
 //
 #define NUM_HOPS 3
 
+// Time the SX1262 stays on one channel when hopping, in milliseconds.
+// HOP_DWELL_MIN covers about one full SF7..SF12 CAD sequence, channels
+// with traffic get up to HOP_DWELL_MAX.
+//
+#define HOP_DWELL_MIN 250
+#define HOP_DWELL_MAX 2000
+
 // Do not change these setting for RSSI detection. They are used for CAD
 // Given the correction factor of 157, we can get to -122dB with this rating
 //
@@ -173,9 +195,9 @@ extern volatile uint8_t _event;
 // // rssi is measured at specific moments and reported on others
 // // so we need to store the current value we like to work with
 extern uint8_t _rssi;
-/// \todo CAD and HOP are not supported by SX1262 (yet)
-extern bool _cad; // Set to true for Channel Activity Detection, only when dio 1 connected
-extern bool _hop; // experimental; frequency hopping. Only use when dio2 connected
+extern bool _cad;	// Set to true for Channel Activity Detection, only when dio 1 connected
+extern bool _hop;	// experimental; frequency hopping. Only use when dio2 connected
+extern bool _sniff; // SX1262 RX duty cycle instead of continuous RX
 
 extern unsigned long nowTime;
 extern unsigned long msgTime;
@@ -215,6 +237,23 @@ struct stat_c
 	unsigned long msg_ttl;
 	unsigned long msg_down;
 
+#if _CHECK_MIC == 1
+	unsigned long drop_short; // Uplinks dropped by rxFilter(): too short,
+	unsigned long drop_netid; // DevAddr of another network,
+	unsigned long drop_mic;	  // known device but wrong MIC
+#endif
+
+#if _TRUSTED_NODES >= 2
+	unsigned long drop_list; // Uplinks not allowed by the node lists
+#endif
+#if _RATE_LIMIT >= 1
+	unsigned long drop_rate;	// Uplinks over the rate of their device
+	unsigned long rate_sampled; // Forwarded anyway, 1 in _RATE_SAMPLE
+#endif
+#if _DEDUP >= 1
+	unsigned long msg_dup; // Uplinks seen before, see dedupCheck()
+#endif
+
 #if STATISTICS >= 2		// Only if we explicitly set it higher
 	unsigned long sf7;  // Spreading factor 7 statistics/Count
 	unsigned long sf8;  // Spreading factor 8
@@ -248,6 +287,7 @@ extern struct stat_c statc;
 
 // // History of received uplink messages from nodes
 extern struct stat_t statr[MAX_STAT];
+extern unsigned long statSeq; // Number of entries ever put in statr
 
 #else // STATISTICS==0
 extern struct stat_t statr[1]; // Always have at least one element to store in
@@ -285,6 +325,126 @@ struct LoraUp
 
 extern struct LoraUp LoraUp;
 
+// SPI and BUSY time of the radio driver, see SX126xGetSpiStats() and
+// SX126xGetBusyStats(). spiMark is taken before every Radio.IrqProcess(),
+// spiRx is what the last received packet needed from reading the IRQ
+// status up to OnRxDone().
+struct spiTime
+{
+	uint32_t us;	   // Microseconds NSS low
+	uint32_t calls;	   // SPI transactions
+	uint32_t busy;	   // Microseconds waiting for BUSY low
+	uint32_t waits;	   // BUSY waits
+	uint32_t timeouts; // BUSY waits that timed out
+};
+extern struct spiTime spiMark;
+extern struct spiTime spiRx;
+
+// Time between two Radio.IrqProcess() calls in loop(), see radioLoopMark().
+// Everything else loop() does (web server, UDP, OLED) adds to this gap.
+struct radioLoop
+{
+	uint32_t win; // Longest gap of the last RADIO_LOOP_WIN period in us
+	uint32_t avg; // Average gap of the last period
+	uint32_t max; // Longest gap since boot
+};
+extern struct radioLoop radioLoop;
+#define RADIO_LOOP_WIN 1000000 // us
+
+// Channel activity per SF of the SX1262 CAD scanner, see cadScanner()
+struct cadStat
+{
+	uint32_t scans;	  // CAD runs
+	uint32_t detects; // Activity detected, the radio went on to RX
+	uint32_t rx;	  // Packets received after a detection
+};
+extern struct cadStat cadStats[6]; // SF7..SF12
+
+// Traffic per channel of the SX1262 when hopping, see hop()
+struct hopStat
+{
+	uint32_t visits;  // Times the channel was tuned to
+	uint32_t ms;	  // Time spent on the channel
+	uint32_t detects; // CAD detections on the channel
+	uint32_t rx;	  // Packets received on the channel
+	uint32_t rate;	  // Average detections per 1000 seconds
+	uint16_t dwell;	  // Dwell of the last visit in milliseconds
+};
+extern struct hopStat hopStats[NUM_HOPS];
+
+// What the SX1262 radio watchdog found and did, see radioWatchdog()
+struct radioHealth
+{
+	uint32_t checks; // Watchdog runs
+	uint32_t rearms; // Radio idle, receiving started again
+	uint32_t irqs;	 // Missed DIO1 interrupts, cleared
+	uint32_t resets; // Radio stuck, reset and configured again
+	uint32_t us;	 // Duration of the last recovery
+	uint16_t error;	 // Device errors at the last reset
+	uint8_t status;	 // Status byte of the last check
+};
+extern struct radioHealth radioHealth;
+
+// RX duty cycle of the SX1262 sniff mode for the current SF, see rxLoraModem()
+struct sniffPlan
+{
+	uint32_t rx;	// Listen window in microseconds, 0 for continuous RX
+	uint32_t sleep; // Sleep in microseconds
+	uint32_t ua;	// Estimated average radio current in microamps
+};
+extern struct sniffPlan sniff;
+
+// Spectrum scanner of the SX1262, see specLoop(). A sweep is done in slices
+// of at most SPEC_SLICE_US, one every SPEC_PERIOD milliseconds and only
+// between packets, so reception stops for about 5% of the time while the
+// scanner runs. Every bin holds the min, max and sum of SPEC_SAMPLES RSSI
+// samples over the RX bandwidth (125 kHz).
+#define SPEC_BINS 64
+#define SPEC_SAMPLES 32	   // RSSI samples per bin and sweep
+#define SPEC_SETTLE_US 300 // From retuning to the first sample
+#define SPEC_SLICE_US 5000
+#define SPEC_PERIOD 100
+
+struct specBin
+{
+	int8_t min; // dBm
+	int8_t max;
+	int16_t sum; // Sum of SPEC_SAMPLES samples
+};
+
+struct specScan
+{
+	bool on;
+	uint32_t start;	 // First bin in Hz, 0 for the channels of freqs[]
+	uint32_t step;	 // Bin distance in Hz
+	uint16_t bins;	 // Number of bins
+	uint16_t bin;	 // Next bin to sample
+	uint32_t sweeps; // Completed sweeps
+	uint32_t us;	 // Duration of the last slice
+};
+extern struct specScan spec;
+extern struct specBin specLast[SPEC_BINS]; // Last completed sweep
+
+// Results of rxFilter()
+#define RX_PASS 0  // Forward the frame
+#define RX_SHORT 1 // Too short for the FHDR and MIC
+#define RX_NETID 2 // DevAddr not in _NETID_PREFIX
+#define RX_MIC 3   // Known device, MIC does not match
+#define RX_LIST 4  // Not allowed or denied by the node lists
+#define RX_RATE 5  // Device is over its rate limit
+
+#if _RATE_LIMIT >= 1
+// Token bucket of one device, see rateLimit.cpp
+struct rateNode
+{
+	uint32_t addr;	 // DevAddr
+	uint32_t ms;	 // millis() of the last frame
+	uint32_t tokens; // Tokens left, in 1/1000
+	uint32_t frames; // Frames heard, 0 for a free slot
+	uint32_t excess; // Frames above the rate
+};
+#endif
+
 // ============================================================================
 // Set all definitions for Gateway
 // ============================================================================
@@ -108,6 +108,7 @@ uint32_t sendTime = 0;  // Time that the last message transmitted
 uint32_t doneTime = 0;  // Time to expire when CDDONE takes too long
 uint32_t statTime = 0;  // last time we sent a stat message to server
 uint32_t pulltime = 0;  // last time we sent a pull_data request to server
+uint32_t chkpTime = 0;  // last time we checkpointed the statistics to SPIFFS
 
 #if A_SERVER == 1
 uint32_t wwwtime = 0;
@@ -120,6 +121,10 @@ uint32_t ntptimer = 0;
 uint16_t frameCount = 0; // We write this to SPIFF file
 #endif
 
+#if (GATEWAYNODE == 1) || (_LOCALSERVER == 1)
+bool aesOk = true; // false when no AES engine passed its self test, see aesCheck()
+#endif
+
 // volatile bool inSPI This initial value of mutex is to be free,
 // which means that its value is 1 (!)
 //
@@ -228,6 +233,52 @@ int sendNtpRequest(IPAddress timeServerIP)
 	return (1);
 }
 
+#if (GATEWAYNODE == 1) || (_LOCALSERVER == 1)
+// ----------------------------------------------------------------------------
+// AESCHECK
+// Check the AES engine against the FIPS-197 vector and AES-CMAC against the
+// RFC 4493 vectors. When the engine selected with LORA_AES_ENGINE fails, the
+// byte engine is used instead. When that fails too, aesOk is cleared: the
+// device sessions are not loaded, so no MIC is checked and nothing is
+// decoded, and the gateway node does not send.
+// With debug >= 2 the speed of the engine is measured as well.
+// ----------------------------------------------------------------------------
+void aesCheck()
+{
+	if ((lora_aes_self_test() != 0) || (AES_CMAC_SelfTest() != 0))
+	{
+		aesOk = (lora_aes_get_engine() != LORA_AES_BYTE) &&
+				(lora_aes_set_engine(LORA_AES_BYTE) == 0) &&
+				(lora_aes_self_test() == 0) && (AES_CMAC_SelfTest() == 0);
+	}
+
+#if DUSB >= 1
+	if ((debug >= 0) && (pdebug & P_MAIN))
+	{
+		Serial.print(F("M AES engine="));
+		Serial.print(lora_aes_get_engine());
+		if (lora_aes_get_engine() != LORA_AES_ENGINE)
+		{
+			Serial.print(F(" (fallback)"));
+		}
+		Serial.println(aesOk ? F(", self test OK") : F(", self test FAILED, AES disabled"));
+	}
+	if ((debug >= 2) && (pdebug & P_MAIN))
+	{
+		lora_aes_context aes;
+		uint8_t blk[16] = {0};
+		lora_aes_set_key(blk, 16, &aes);
+		uint32_t cycles = ESP.getCycleCount();
+		for (uint8_t i = 0; i < 64; i++)
+			lora_aes_encrypt(blk, blk, &aes);
+		cycles = (ESP.getCycleCount() - cycles) / 64;
+		Serial.print(F("M AES cycles/block="));
+		Serial.println(cycles);
+	}
+#endif
+}
+#endif
+
 // ----------------------------------------------------------------------------
 // Get the NTP time from one of the time servers
 // Note: As this function is called from SyncINterval in the background
@@ -372,6 +423,10 @@ void setup()
 	Serial.println(F("Do Asserts"));
 #endif
 
+#if (GATEWAYNODE == 1) || (_LOCALSERVER == 1)
+	aesCheck();
+#endif
+
 #if OLED >= 1
 	init_oLED(); // When done display "STARTING" on OLED
 #endif
@@ -559,11 +614,26 @@ void setup()
 
 	delay(100); // Wait after setup
 
+	// Restore the statistics of before the (re)boot
+	statRestore();
+	chkpTime = now();
+
+#if _LOCALSERVER == 1
+	// Load the device sessions we decode for, not when AES cannot be trusted
+	if (aesOk)
+	{
+		sessionInit();
+	}
+#endif
+#if _TRUSTED_NODES >= 2
+	listInit();
+#endif
+
 	// Setup and initialise LoRa state machine of _loramModem.ino
 	_state = S_INIT;
 	initLoraModem();
 
-	if (_cad)
+	if ((_cad) || (_hop))
 	{
 		_state = S_SCAN;
 		sf = SF7;
@@ -636,8 +706,13 @@ void loop()
 		stateMachine(); // do the state machine
 #else
 		// Handle Radio events
+		SX126xGetSpiStats(&spiMark.us, &spiMark.calls);
+		SX126xGetBusyStats(&spiMark.busy, &spiMark.waits, &spiMark.timeouts);
+		radioLoopMark();
 		Radio.IrqProcess();
+		specLoop(); // Spectrum scanner, between packets
 #endif
+#ifndef CFG_sx1262_radio
 		// After a quiet period, make sure we reinit the modem and state machine.
 		// The interval is in seconds (about 15 seconds) as this re-init
 		// is a heavy operation.
@@ -657,7 +732,6 @@ void loop()
 			}
 #endif
 
-#ifndef CFG_sx1262_radio
 			// startReceiver() ??
 			if ((_cad) || (_hop))
 			{
@@ -672,19 +746,27 @@ void loop()
 			}
 			writeRegister(REG_IRQ_FLAGS_MASK, (uint8_t)0x00);
 			writeRegister(REG_IRQ_FLAGS, (uint8_t)0xFF); // Reset all interrupt flags
+			msgTime = nowSeconds;
+		}
 #else
-			Radio.Sleep();
-			delay(100);
-			Radio.Rx(0);
-#endif
+		// After a quiet period, check that the radio is still receiving.
+		// The check is a few SPI reads, the radio is only re-armed or reset
+		// when it is actually stuck, see radioWatchdog().
+		//
+		if (((nowSeconds - statr[0].tmst) > _MSG_INTERVAL) &&
+			((nowSeconds - msgTime) > _MSG_INTERVAL))
+		{
+			radioWatchdog();
 			msgTime = nowSeconds;
 		}
+#endif
 #if A_SERVER == 1
 		// Handle the Web server part of this sketch. Mainly used for administration
 		// and monitoring of the node. This function is important so it is called at the
 		// start of the loop() function.
 		yield();
 		server.handleClient();
+		wwwEventLoop(); // Push queued live events, never blocks
 #endif
 
 		// If event is set, we know that we have a (soft) interrupt.
@@ -773,7 +855,7 @@ void loop()
 			// message but we schedule it in the same frequency.
 			//
 #if GATEWAYNODE == 1
-			if (gwayConfig.isNode)
+			if (gwayConfig.isNode && aesOk)
 			{
 				// Give way to internal some Admin if necessary
 				yield();
@@ -792,6 +874,23 @@ void loop()
 			statTime = nowSeconds;
 		}
 
+#if _STAT_CHECKPOINT > 0
+		// Write the statistics changes to the SPIFFS journal so they
+		// survive a reboot. Only the changed counters are written.
+		//
+		if ((nowSeconds - chkpTime) >= _STAT_CHECKPOINT)
+		{
+			statCheckpoint();
+			chkpTime = nowSeconds;
+		}
+#endif
+
+#if _LOCALSERVER == 1
+		// Write the frame counters of the device sessions, at most every
+		// _SESSION_SAVE seconds
+		sessionCheckpoint();
+#endif
+
 		yield();
 
 		// send PULL_DATA message (*2, par. 4)
@@ -0,0 +1,422 @@
+// 1-channel LoRa Gateway for ESP8266
+// Copyright (c) 2016, 2017, 2018, 2019 Maarten Westenberg version for ESP8266
+// Version 6.1.0
+// Date: 2019-10-20
+// Author: Maarten Westenberg (mw12554@hotmail.com)
+//
+// Based on work done by Thomas Telkamp for Raspberry PI 1-ch gateway and many others.
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License
+// which accompanies this distribution, and is available at
+// https://opensource.org/licenses/mit-license.php
+//
+// NO WARRANTY OF ANY KIND IS PROVIDED
+//
+// The protocols and specifications used for this 1ch gateway:
+// 1. LoRA Specification version V1.0 and V1.1 for Gateway-Node communication
+//
+// 2. Semtech Basic communication protocol between Lora gateway and server version 3.0.0
+//	https://github.com/Lora-net/packet_forwarder/blob/master/PROTOCOL.TXT
+//
+// Notes:
+// - Once call gethostbyname() to get IP for services, after that only use IP
+//	 addresses (too many gethost name makes the ESP unstable)
+// - Only call yield() in main stream (not for background NTP sync).
+//
+//
+// ********************************************************************************
+// ********************************************************************************
+// Ported to use with Semtech SX1262 chips
+// Author: Bernd Giesecke (https://github.com/beegee-tokyo)
+//
+// Port is work in progress
+// CAD and HOP is not supported for SX1262 chips
+// Downlink is not working
+// Compiles under PlatformIO only
+// ********************************************************************************
+// ********************************************************************************
+//
+// This file contains the DevAddr allow and deny lists of _TRUSTED_NODES 2.
+// ========================================================================================
+
+#include "defines.h"
+
+#if _TRUSTED_NODES >= 2
+
+// ----------------------------------------------------------------------------
+// Every list is a sorted array of DevAddr with a Bloom filter in front of it.
+// Most frames come from devices that are not on the deny list, for those
+// the filter answers "not in the list" after a few bit tests. Only when all
+// bits are set the sorted array is searched, so a false positive of the
+// filter never leads to a wrong decision.
+// The filter has about 16 bits per address and LIST_HASHES probes, that
+// keeps false positives well below 1%. It grows with the list.
+// The result for the last LIST_CACHE addresses is kept in a direct mapped
+// cache that is cleared whenever a list changes.
+//
+// ALLOWFILE/DENYFILE layout: the addresses (4 bytes, little endian) in
+// ascending order followed by a 1 byte checksum.
+// ----------------------------------------------------------------------------
+
+#define LIST_HASHES 4
+#define LIST_CACHE 64
+#define LIST_MIN_BITS 256
+
+struct nodeList
+{
+	uint32_t *addr;	 // Sorted DevAddr
+	int count;		 // Addresses in the list
+	int size;		 // Room in addr
+	uint32_t *bloom; // Filter, bits words
+	uint32_t bits;	 // Filter size in bits, a power of 2
+};
+
+static struct nodeList lists[2];
+static const char *listFiles[2] = {ALLOWFILE, DENYFILE};
+
+static struct
+{
+	uint32_t addr;
+	uint8_t used;
+	uint8_t verdict; // RX_PASS or RX_LIST
+} listCache[LIST_CACHE];
+
+// ----------------------------------------------------------------------------
+// Memory for the lists, PSRAM when there is some
+// ----------------------------------------------------------------------------
+static void *listRealloc(void *p, size_t size)
+{
+#if ESP32_ARCH == 1
+	if (psramFound())
+	{
+		return (ps_realloc(p, size));
+	}
+#endif
+	return (realloc(p, size));
+}
+
+// ----------------------------------------------------------------------------
+// Two independent 32-bit hashes of a DevAddr, the probes are h1 + i*h2
+// ----------------------------------------------------------------------------
+static inline uint32_t listMix(uint32_t x)
+{
+	x ^= x >> 16;
+	x *= 0x85EBCA6B;
+	x ^= x >> 13;
+	x *= 0xC2B2AE35;
+	x ^= x >> 16;
+	return (x);
+}
+
+static void listBloomSet(struct nodeList *l, uint32_t addr)
+{
+	uint32_t h1 = listMix(addr);
+	uint32_t h2 = listMix(h1 ^ 0x9E3779B9) | 1;
+	for (int i = 0; i < LIST_HASHES; i++)
+	{
+		uint32_t b = (h1 + i * h2) & (l->bits - 1);
+		l->bloom[b >> 5] |= (1UL << (b & 31));
+	}
+}
+
+static bool listBloomTest(const struct nodeList *l, uint32_t addr)
+{
+	uint32_t h1 = listMix(addr);
+	uint32_t h2 = listMix(h1 ^ 0x9E3779B9) | 1;
+	for (int i = 0; i < LIST_HASHES; i++)
+	{
+		uint32_t b = (h1 + i * h2) & (l->bits - 1);
+		if ((l->bloom[b >> 5] & (1UL << (b & 31))) == 0)
+		{
+			return (false);
+		}
+	}
+	return (true);
+}
+
+// ----------------------------------------------------------------------------
+// Build the filter again, with a size that fits the list. Needed after an
+// address was removed, a Bloom filter can not forget.
+// Returns:
+//	0 when ok, -1 when there was no memory
+// ----------------------------------------------------------------------------
+static int listBloomBuild(struct nodeList *l)
+{
+	uint32_t bits = LIST_MIN_BITS;
+	while (bits < 16UL * l->count)
+	{
+		bits *= 2;
+	}
+	if (bits != l->bits)
+	{
+		uint32_t *bloom = (uint32_t *)listRealloc(l->bloom, bits / 8);
+		if (bloom == NULL)
+		{
+			return (-1);
+		}
+		l->bloom = bloom;
+		l->bits = bits;
+	}
+	memset(l->bloom, 0, l->bits / 8);
+	for (int i = 0; i < l->count; i++)
+	{
+		listBloomSet(l, l->addr[i]);
+	}
+	memset(listCache, 0, sizeof(listCache));
+	return (0);
+}
+
+// ----------------------------------------------------------------------------
+// Position of addr in the sorted array, or where it would be inserted
+// ----------------------------------------------------------------------------
+static int listPos(const struct nodeList *l, uint32_t addr)
+{
+	int lo = 0, hi = l->count;
+	while (lo < hi)
+	{
+		int mid = (lo + hi) / 2;
+		if (l->addr[mid] < addr)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return (lo);
+}
+
+// ----------------------------------------------------------------------------
+// Is addr on list which (LIST_ALLOW or LIST_DENY)
+// ----------------------------------------------------------------------------
+static bool listHas(int which, uint32_t addr)
+{
+	const struct nodeList *l = &lists[which];
+	if ((l->count == 0) || !listBloomTest(l, addr))
+	{
+		return (false);
+	}
+	int i = listPos(l, addr);
+	return ((i < l->count) && (l->addr[i] == addr));
+}
+
+// ----------------------------------------------------------------------------
+// LISTCHECK
+// May a frame of DevAddr addr be forwarded? Not when the address is on the
+// deny list, and not when there is an allow list without it.
+// Parameters:
+//	addr: DevAddr as a number, 0x260211CE for 26 02 11 CE
+// Returns:
+//	RX_PASS or RX_LIST
+// ----------------------------------------------------------------------------
+int listCheck(uint32_t addr)
+{
+	uint8_t c = listMix(addr) & (LIST_CACHE - 1);
+	if (listCache[c].used && (listCache[c].addr == addr))
+	{
+		return (listCache[c].verdict);
+	}
+
+	int verdict = RX_PASS;
+	if (listHas(LIST_DENY, addr) ||
+		((lists[LIST_ALLOW].count > 0) && !listHas(LIST_ALLOW, addr)))
+	{
+		verdict = RX_LIST;
+	}
+	listCache[c].addr = addr;
+	listCache[c].used = 1;
+	listCache[c].verdict = verdict;
+	return (verdict);
+}
+
+// ----------------------------------------------------------------------------
+// LISTADD
+// Put an address on a list. The list is not written to flash, call
+// listSave() for that.
+// Returns:
+//	1 when added, 0 when it was on the list already, -1 when out of memory
+// ----------------------------------------------------------------------------
+int listAdd(int which, uint32_t addr)
+{
+	struct nodeList *l = &lists[which];
+	int i = listPos(l, addr);
+	if ((i < l->count) && (l->addr[i] == addr))
+	{
+		return (0);
+	}
+	if (l->count == l->size)
+	{
+		int size = (l->size == 0) ? 16 : 2 * l->size;
+		uint32_t *a = (uint32_t *)listRealloc(l->addr, size * sizeof(uint32_t));
+		if (a == NULL)
+		{
+			return (-1);
+		}
+		l->addr = a;
+		l->size = size;
+	}
+	memmove(&l->addr[i + 1], &l->addr[i], (l->count - i) * sizeof(uint32_t));
+	l->addr[i] = addr;
+	l->count++;
+
+	if ((l->bits < 16UL * l->count) || (l->bloom == NULL))
+	{
+		if (listBloomBuild(l) != 0)
+		{
+			// The old filter is left as it was, take addr out again so
+			// the array and the filter hold the same addresses
+			l->count--;
+			memmove(&l->addr[i], &l->addr[i + 1], (l->count - i) * sizeof(uint32_t));
+			return (-1);
+		}
+		return (1);
+	}
+	listBloomSet(l, addr);
+	memset(listCache, 0, sizeof(listCache));
+	return (1);
+}
+
+// ----------------------------------------------------------------------------
+// LISTREMOVE
+// Take an address off a list
+// Returns:
+//	1 when removed, 0 when it was not on the list
+// ----------------------------------------------------------------------------
+int listRemove(int which, uint32_t addr)
+{
+	struct nodeList *l = &lists[which];
+	int i = listPos(l, addr);
+	if ((i >= l->count) || (l->addr[i] != addr))
+	{
+		return (0);
+	}
+	l->count--;
+	memmove(&l->addr[i], &l->addr[i + 1], (l->count - i) * sizeof(uint32_t));
+	listBloomBuild(l);
+	return (1);
+}
+
+// ----------------------------------------------------------------------------
+// Empty a list
+// ----------------------------------------------------------------------------
+void listClear(int which)
+{
+	lists[which].count = 0;
+	listBloomBuild(&lists[which]);
+}
+
+// ----------------------------------------------------------------------------
+// Number of addresses on a list and address i of it, for listing
+// ----------------------------------------------------------------------------
+int listCount(int which)
+{
+	return (lists[which].count);
+}
+
+uint32_t listAt(int which, int i)
+{
+	return (lists[which].addr[i]);
+}
+
+// ----------------------------------------------------------------------------
+// LISTSAVE
+// Write a list to its file, via a temporary file like sessionSave()
+// Returns:
+//	Number of addresses written, -1 on error
+// ----------------------------------------------------------------------------
+int listSave(int which)
+{
+	struct nodeList *l = &lists[which];
+	String tmp = String(listFiles[which]) + ".tmp";
+	uint8_t sum = 0;
+
+	File f = SPIFFS.open(tmp.c_str(), "w");
+	if (!f)
+	{
+#if DUSB >= 1
+		if ((debug >= 1) && (pdebug & P_MAIN))
+			Serial.println(F("M ERROR:: listSave, open failed"));
+#endif
+		return (-1);
+	}
+	for (int i = 0; i < l->count; i++)
+	{
+		uint8_t rec[4];
+		memcpy(rec, &l->addr[i], 4);
+		sum += rec[0] + rec[1] + rec[2] + rec[3];
+		f.write(rec, 4);
+	}
+	f.write(&sum, 1);
+	f.close();
+
+	SPIFFS.remove(listFiles[which]);
+	if (!SPIFFS.rename(tmp.c_str(), listFiles[which]))
+	{
+		return (-1);
+	}
+	return (l->count);
+}
+
+// ----------------------------------------------------------------------------
+// Read one list from flash. A damaged file leaves the list empty.
+// Returns:
+//	1 when the file was there, 0 when not
+// ----------------------------------------------------------------------------
+static int listLoad(int which)
+{
+	File f = SPIFFS.open(listFiles[which], "r");
+	if (!f)
+	{
+		return (0);
+	}
+	int n = (f.size() - 1) / 4;
+	uint8_t rec[4], sum = 0, fsum = 0;
+	for (int i = 0; (i < n) && (f.read(rec, 4) == 4); i++)
+	{
+		uint32_t addr;
+		memcpy(&addr, rec, 4);
+		sum += rec[0] + rec[1] + rec[2] + rec[3];
+		listAdd(which, addr);
+	}
+	if ((f.read(&fsum, 1) != 1) || (fsum != sum))
+	{
+#if DUSB >= 1
+		Serial.print(F("M ERROR:: listLoad, bad file "));
+		Serial.println(listFiles[which]);
+#endif
+		listClear(which);
+	}
+	f.close();
+	return (1);
+}
+
+// ----------------------------------------------------------------------------
+// LISTINIT
+// Load the allow and deny lists. Without ALLOWFILE the allow list is made
+// from the nodes[] of sensor.cpp and written to flash.
+// Called once from setup().
+// ----------------------------------------------------------------------------
+void listInit()
+{
+	listBloomBuild(&lists[LIST_ALLOW]);
+	listBloomBuild(&lists[LIST_DENY]);
+	if (!listLoad(LIST_ALLOW))
+	{
+		for (int i = 0; i < (int)(sizeof(nodes) / sizeof(nodex)); i++)
+		{
+			listAdd(LIST_ALLOW, nodes[i].id);
+		}
+		listSave(LIST_ALLOW);
+	}
+	listLoad(LIST_DENY);
+
+#if DUSB >= 1
+	if ((debug >= 0) && (pdebug & P_MAIN))
+	{
+		Serial.print(F("M listInit:: allow="));
+		Serial.print(lists[LIST_ALLOW].count);
+		Serial.print(F(", deny="));
+		Serial.println(lists[LIST_DENY].count);
+	}
+#endif
+}
+
+#endif // _TRUSTED_NODES
@@ -49,6 +49,29 @@
 void dispWriteHeader(void);
 extern String gwFreq;
 
+// --------------------------------------------------------------------
+// The display only shows the latest state below. The RX path and the
+// OTA callback copy a few numbers into it, a low priority task on the
+// other core renders it at most OLED_FPS times per second and skips
+// the I2C transfer when nothing changed since the last frame.
+// --------------------------------------------------------------------
+struct oledState
+{
+	uint32_t seq;	 // Incremented with every change
+	time_t rxTime;	 // Time of the last received message
+	int rssi;		 // Packet RSSI
+	long snr;		 // Packet SNR
+	uint8_t len;	 // Message length
+	uint8_t addr[4]; // DevAddr, MSB first
+	uint32_t up;	 // Messages up
+	uint32_t down;	 // Messages down
+	int8_t ota;		 // OTA progress in %, -1 when no update is running
+};
+
+static oledState oledNow = {0, 0, 0, 0, 0, {0, 0, 0, 0}, 0, 0, -1};
+static portMUX_TYPE oledMux = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t oledHandle = NULL;
+
 // --------------------------------------------------------
 // Define the different OLED versions
 //
@@ -113,6 +136,9 @@ void acti_oLED()
 	display.display();
 
 	delay(4000);
+
+	// From here on only the display task draws
+	xTaskCreatePinnedToCore(oledTask, "oled", 3072, NULL, 1, &oledHandle, 0);
 }
 
 // --------------------------------------------------------------------
@@ -154,15 +180,97 @@ void dispWriteHeader(void)
 
 // --------------------------------------------------------------------
 // Show OTA status
-//
+// Called from the OTA progress callback, the display task shows it.
 // --------------------------------------------------------------------
 void dispOtaStatus(uint8_t percentage)
 {
+	portENTER_CRITICAL(&oledMux);
+	if (oledNow.ota != (int8_t)percentage)
+	{
+		oledNow.ota = percentage;
+		oledNow.seq++;
+	}
+	portEXIT_CRITICAL(&oledMux);
+}
+
+// --------------------------------------------------------------------
+// Store the data of a received message for the display.
+// Called from buildPacket(), only copies, never touches the I2C bus.
+// Parameters:
+//		rssi: Packet RSSI to show
+//		snr: Packet SNR
+//		len: Message length
+//		message: The LoRa message, DevAddr is in bytes 1..4 (LSB first)
+// --------------------------------------------------------------------
+void oledRx(int rssi, long snr, uint8_t len, uint8_t *message)
+{
+	portENTER_CRITICAL(&oledMux);
+	oledNow.rxTime = now();
+	oledNow.rssi = rssi;
+	oledNow.snr = snr;
+	oledNow.len = len;
+	oledNow.addr[0] = message[4];
+	oledNow.addr[1] = message[3];
+	oledNow.addr[2] = message[2];
+	oledNow.addr[3] = message[1];
+	oledNow.up = statc.msg_ok + 1; // msg_ok is incremented after buildPacket()
+	oledNow.down = statc.msg_down;
+	oledNow.seq++;
+	portEXIT_CRITICAL(&oledMux);
+}
+
+// --------------------------------------------------------------------
+// Draw one frame from a copy of the state
+// --------------------------------------------------------------------
+static void oledRender(const oledState &st)
+{
+	char line[40];
+
 	dispWriteHeader();
-	char line[128];
-	sprintf(line, "Progress: %d%%", percentage);
-	display.drawString(20, 24, line);
+	if (st.ota >= 0)
+	{
+		snprintf(line, sizeof(line), "Progress: %d%%", st.ota);
+		display.drawString(20, 24, line);
+		display.display();
+		return;
+	}
+
+	snprintf(line, sizeof(line), "Time: %02i:%02i:%02i", hour(st.rxTime), minute(st.rxTime), second(st.rxTime));
+	display.drawString(0, 11, line);
+	snprintf(line, sizeof(line), "RSSI: %d", st.rssi);
+	display.drawString(0, 21, line);
+	snprintf(line, sizeof(line), "SNR: %ld   - LEN: %u", st.snr, st.len);
+	display.drawString(0, 31, line);
+	snprintf(line, sizeof(line), "Addr: %02X %02X %02X %02X", st.addr[0], st.addr[1], st.addr[2], st.addr[3]);
+	display.drawString(0, 41, line);
+	snprintf(line, sizeof(line), "U %u   D %u", st.up, st.down);
+	display.drawString(0, 51, line);
 	display.display();
 }
 
+// --------------------------------------------------------------------
+// Display task. Wakes up OLED_FPS times per second and renders only
+// when the state changed.
+// --------------------------------------------------------------------
+void oledTask(void *pvParameters)
+{
+	uint32_t shown = 0;
+	oledState st;
+	TickType_t wake = xTaskGetTickCount();
+
+	for (;;)
+	{
+		vTaskDelayUntil(&wake, pdMS_TO_TICKS(1000 / OLED_FPS));
+		if (oledNow.seq == shown)
+			continue;
+
+		portENTER_CRITICAL(&oledMux);
+		st = oledNow;
+		portEXIT_CRITICAL(&oledMux);
+
+		oledRender(st);
+		shown = st.seq;
+	}
+}
+
 #endif
\ No newline at end of file
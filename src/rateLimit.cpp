@@ -0,0 +1,192 @@
+// 1-channel LoRa Gateway for ESP8266
+// Copyright (c) 2016, 2017, 2018, 2019 Maarten Westenberg version for ESP8266
+// Version 6.1.0
+// Date: 2019-10-20
+// Author: Maarten Westenberg (mw12554@hotmail.com)
+//
+// Based on work done by Thomas Telkamp for Raspberry PI 1-ch gateway and many others.
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License
+// which accompanies this distribution, and is available at
+// https://opensource.org/licenses/mit-license.php
+//
+// NO WARRANTY OF ANY KIND IS PROVIDED
+//
+// The protocols and specifications used for this 1ch gateway:
+// 1. LoRA Specification version V1.0 and V1.1 for Gateway-Node communication
+//
+// 2. Semtech Basic communication protocol between Lora gateway and server version 3.0.0
+//	https://github.com/Lora-net/packet_forwarder/blob/master/PROTOCOL.TXT
+//
+// Notes:
+// - Once call gethostbyname() to get IP for services, after that only use IP
+//	 addresses (too many gethost name makes the ESP unstable)
+// - Only call yield() in main stream (not for background NTP sync).
+//
+//
+// ********************************************************************************
+// ********************************************************************************
+// Ported to use with Semtech SX1262 chips
+// Author: Bernd Giesecke (https://github.com/beegee-tokyo)
+//
+// Port is work in progress
+// CAD and HOP is not supported for SX1262 chips
+// Downlink is not working
+// Compiles under PlatformIO only
+// ********************************************************************************
+// ********************************************************************************
+//
+// This file contains the per device rate limiter of the forwarder.
+// ========================================================================================
+
+#include "defines.h"
+
+#if _RATE_LIMIT >= 1
+
+// ----------------------------------------------------------------------------
+// Every DevAddr that is heard gets a token bucket that fills with
+// _RATE_PER_HOUR tokens per hour up to _RATE_BURST tokens. A forwarded
+// frame costs one token. Tokens are counted in thousandths so slow rates
+// do not lose the fraction.
+//
+// The buckets are kept in their own table, the forwarder sees many more
+// devices than the _LOCALSERVER session table holds. The table has
+// _RATE_NODES slots and is probed linearly from the home slot for at most
+// RATE_PROBE slots. A new device takes the first free slot. When there is
+// none it replaces a device that was quiet for RATE_IDLE ms, or else the
+// one with the fewest frames, so a burst of new (or random) addresses does
+// not push the busy devices out. Slots never become free again, so a
+// lookup can stop at the first free slot.
+// ----------------------------------------------------------------------------
+
+#if (_RATE_NODES & (_RATE_NODES - 1)) != 0
+#error "_RATE_NODES must be a power of 2"
+#endif
+#define RATE_PROBE 8
+#define RATE_IDLE 3600000UL // One hour
+#define RATE_FULL (_RATE_BURST * 1000UL)
+
+static struct rateNode rateNodes[_RATE_NODES];
+
+static inline uint16_t rateHash(uint32_t addr)
+{
+	return (((uint32_t)(addr * 2654435761U) >> 16) & (_RATE_NODES - 1));
+}
+
+static inline bool rateIdle(const struct rateNode *r, uint32_t ms)
+{
+	return ((ms - r->ms) > RATE_IDLE);
+}
+
+// ----------------------------------------------------------------------------
+// Bucket of addr, a new (full) one when the device was not heard before
+// ----------------------------------------------------------------------------
+static struct rateNode *rateFind(uint32_t addr, uint32_t ms)
+{
+	uint16_t i = rateHash(addr);
+	struct rateNode *victim = NULL;
+	for (int n = 0; n < RATE_PROBE; n++)
+	{
+		struct rateNode *r = &rateNodes[i];
+		if (r->frames == 0)
+		{
+			victim = r; // Free slot, the device is not known
+			break;
+		}
+		if (r->addr == addr)
+		{
+			return (r);
+		}
+		if ((victim == NULL) ||
+			(!rateIdle(victim, ms) && (rateIdle(r, ms) || (r->frames < victim->frames))))
+		{
+			victim = r;
+		}
+		i = (i + 1) & (_RATE_NODES - 1);
+	}
+	victim->addr = addr;
+	victim->ms = ms;
+	victim->tokens = RATE_FULL;
+	victim->frames = 0;
+	victim->excess = 0;
+	return (victim);
+}
+
+// ----------------------------------------------------------------------------
+// RATECHECK
+// Take a token from the bucket of a device. Without tokens the frame is
+// dropped, only every _RATE_SAMPLE-th excess frame is forwarded so the
+// device can still be watched on the server (0 drops them all).
+// Parameters:
+//	addr: DevAddr as a number, 0x260211CE for 26 02 11 CE
+// Returns:
+//	RX_PASS or RX_RATE
+// ----------------------------------------------------------------------------
+int rateCheck(uint32_t addr)
+{
+	uint32_t ms = millis();
+	struct rateNode *r = rateFind(addr, ms);
+
+	// Refill, rate/3600 thousandths of a token per ms
+	uint64_t add = (uint64_t)(ms - r->ms) * _RATE_PER_HOUR / 3600;
+	r->tokens = ((RATE_FULL - r->tokens) > add) ? r->tokens + add : RATE_FULL;
+	r->ms = ms;
+	r->frames++;
+
+	if (r->tokens >= 1000)
+	{
+		r->tokens -= 1000;
+		return (RX_PASS);
+	}
+
+	r->excess++;
+#if _RATE_SAMPLE > 0
+	if (((r->excess - 1) % _RATE_SAMPLE) == 0)
+	{
+		statc.rate_sampled++;
+		return (RX_PASS);
+	}
+#endif
+	statc.drop_rate++;
+	return (RX_RATE);
+}
+
+// ----------------------------------------------------------------------------
+// RATETOP
+// The devices that sent the most frames
+// Parameters:
+//	top: Array for n pointers, filled with the busiest devices first
+//	n: Size of top
+// Returns:
+//	Number of devices in top
+// ----------------------------------------------------------------------------
+int rateTop(struct rateNode **top, int n)
+{
+	int cnt = 0;
+	for (int i = 0; i < _RATE_NODES; i++)
+	{
+		struct rateNode *r = &rateNodes[i];
+		if (r->frames == 0)
+		{
+			continue;
+		}
+		// Insert into the sorted list, dropping the last one when full
+		int j = (cnt < n) ? cnt++ : n;
+		while ((j > 0) && (top[j - 1]->frames < r->frames))
+		{
+			if (j < n)
+			{
+				top[j] = top[j - 1];
+			}
+			j--;
+		}
+		if (j < n)
+		{
+			top[j] = r;
+		}
+	}
+	return (cnt);
+}
+
+#endif // _RATE_LIMIT
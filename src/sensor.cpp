@@ -187,78 +187,6 @@ static int LoRaSensors(uint8_t *buf)
 	return (tchars); // return the number of bytes added to payload
 }
 
-// ----------------------------------------------------------------------------
-// XOR()
-// perform x-or function for buffer and key
-// Since we do this ONLY for keys and X, Y we know that we need to XOR 16 bytes.
-//
-// ----------------------------------------------------------------------------
-static void mXor(uint8_t *buf, uint8_t *key)
-{
-	for (uint8_t i = 0; i < 16; ++i)
-		buf[i] ^= key[i];
-}
-
-// ----------------------------------------------------------------------------
-// SHIFT-LEFT
-// Shift the buffer buf left one bit
-// Parameters:
-//	- buf: An array of uint8_t bytes
-//	- len: Length of the array in bytes
-// ----------------------------------------------------------------------------
-static void shift_left(uint8_t *buf, uint8_t len)
-{
-	while (len--)
-	{
-		uint8_t next = len ? buf[1] : 0; // len 0 to 15
-
-		uint8_t val = (*buf << 1);
-		if (next & 0x80)
-			val |= 0x01;
-		*buf++ = val;
-	}
-}
-
-// ----------------------------------------------------------------------------
-// generate_subkey
-// RFC 4493, para 2.3
-// ----------------------------------------------------------------------------
-static void generate_subkey(uint8_t *key, uint8_t *k1, uint8_t *k2)
-{
-
-	memset(k1, 0, 16); // Fill subkey1 with 0x00
-
-	// Step 1: Assume k1 is an all zero block
-	AES_Encrypt(k1, key);
-
-	// Step 2: Analyse outcome of Encrypt operation (in k1), generate k1
-	if (k1[0] & 0x80)
-	{
-		shift_left(k1, 16);
-		k1[15] ^= 0x87;
-	}
-	else
-	{
-		shift_left(k1, 16);
-	}
-
-	// Step 3: Generate k2
-	for (uint8_t i = 0; i < 16; i++)
-		k2[i] = k1[i];
-	if (k1[0] & 0x80)
-	{ // use k1(==k2) according rfc
-		shift_left(k2, 16);
-		k2[15] ^= 0x87;
-	}
-	else
-	{
-		shift_left(k2, 16);
-	}
-
-	// step 4: Done, return k1 and k2
-	return;
-}
-
 // ----------------------------------------------------------------------------
 // MICPACKET()
 // Provide a valid MIC 4-byte code (par 2.4 of spec, RFC4493)
@@ -277,176 +205,16 @@ static void generate_subkey(uint8_t *key, uint8_t *k1, uint8_t *k2)
 //	- FrameCount:	16-bit framecounter
 //	- dir:			0=up, 1=down
 //
-// B0 = ( 0x49 | 4 x 0x00 | Dir | 4 x DevAddr | 4 x FCnt |  0x00 | len )
-// MIC is cmac [0:3] of ( aes128_cmac(NwkSKey, B0 | Data )
-//
+// The MIC itself is computed by micCompute() below.
 // ----------------------------------------------------------------------------
 uint8_t micPacket(uint8_t *data, uint8_t len, uint16_t FrameCount, uint8_t *NwkSKey, uint8_t dir)
 {
-
-	//uint8_t NwkSKey[16] = _NWKSKEY;
-	uint8_t Block_B[16];
-	uint8_t X[16];
-	uint8_t Y[16];
-
-	// ------------------------------------
-	// build the B block used by the MIC process
-	Block_B[0] = 0x49; // 1 byte MIC code
-
-	Block_B[1] = 0x00; // 4 byte 0x00
-	Block_B[2] = 0x00;
-	Block_B[3] = 0x00;
-	Block_B[4] = 0x00;
-
-	Block_B[5] = dir; // 1 byte Direction
-
-	Block_B[6] = DevAddr[3]; // 4 byte DevAddr
-	Block_B[7] = DevAddr[2];
-	Block_B[8] = DevAddr[1];
-	Block_B[9] = DevAddr[0];
-
-	Block_B[10] = (FrameCount & 0x00FF); // 4 byte FCNT
-	Block_B[11] = ((FrameCount >> 8) & 0x00FF);
-	Block_B[12] = 0x00; // Frame counter upper Bytes
-	Block_B[13] = 0x00; // These are not used so are 0
-
-	Block_B[14] = 0x00; // 1 byte 0x00
-
-	Block_B[15] = len; // 1 byte len
-
-	// ------------------------------------
-	// Step 1: Generate the subkeys
-	//
-	uint8_t k1[16];
-	uint8_t k2[16];
-	generate_subkey(NwkSKey, k1, k2);
-
-	// ------------------------------------
-	// Copy the data to a new buffer which is prepended with Block B0
-	//
-	uint8_t micBuf[len + 16]; // B0 | data
-	for (uint8_t i = 0; i < 16; i++)
-		micBuf[i] = Block_B[i];
-	for (uint8_t i = 0; i < len; i++)
-		micBuf[i + 16] = data[i];
-
-	// ------------------------------------
-	// Step 2: Calculate the number of blocks for CMAC
-	//
-	uint8_t numBlocks = len / 16 + 1; // Compensate for B0 block
-	if ((len % 16) != 0)
-		numBlocks++; // If we have only a part block, take it all
-
-	// ------------------------------------
-	// Step 3: Calculate padding is necessary
-	//
-	uint8_t restBits = len % 16; // if numBlocks is not a multiple of 16 bytes
-
-	// ------------------------------------
-	// Step 5: Make a buffer of zeros
-	//
-	memset(X, 0, 16);
-
-	// ------------------------------------
-	// Step 6: Do the actual encoding according to RFC
-	//
-	for (uint8_t i = 0x0; i < (numBlocks - 1); i++)
-	{
-		for (uint8_t j = 0; j < 16; j++)
-			Y[j] = micBuf[(i * 16) + j];
-		mXor(Y, X);
-		AES_Encrypt(Y, NwkSKey);
-		for (uint8_t j = 0; j < 16; j++)
-			X[j] = Y[j];
-	}
-
-	// ------------------------------------
-	// Step 4: If there is a rest Block, padd it
-	// Last block. We move step 4 to the end as we need Y
-	// to compute the last block
-	//
-	if (restBits)
-	{
-		for (uint8_t i = 0; i < 16; i++)
-		{
-			if (i < restBits)
-				Y[i] = micBuf[((numBlocks - 1) * 16) + i];
-			if (i == restBits)
-				Y[i] = 0x80;
-			if (i > restBits)
-				Y[i] = 0x00;
-		}
-		mXor(Y, k2);
-	}
-	else
-	{
-		for (uint8_t i = 0; i < 16; i++)
-		{
-			Y[i] = micBuf[((numBlocks - 1) * 16) + i];
-		}
-		mXor(Y, k1);
-	}
-	mXor(Y, X);
-	AES_Encrypt(Y, NwkSKey);
-
-	// ------------------------------------
-	// Step 7: done, return the MIC size.
 	// Only 4 bytes are returned (32 bits), which is less than the RFC recommends.
 	// We return by appending 4 bytes to data, so there must be space in data array.
-	//
-	data[len + 0] = Y[0];
-	data[len + 1] = Y[1];
-	data[len + 2] = Y[2];
-	data[len + 3] = Y[3];
+	micCompute(AES_CMAC_Cached(NwkSKey), data, len, FrameCount, dir, data + len);
 	return 4;
 }
 
-#if _CHECK_MIC == 1
-// ----------------------------------------------------------------------------
-// CHECKMIC
-// Function to check the MIC computed for existing messages and for new messages
-// Parameters:
-//	- buf: LoRa buffer to check in bytes, last 4 bytes contain the MIC
-//	- len: Length of buffer in bytes
-//	- key: Key to use for MIC. Normally this is the NwkSKey
-//
-// ----------------------------------------------------------------------------
-static void checkMic(uint8_t *buf, uint8_t len, uint8_t *key)
-{
-	uint8_t cBuf[len + 1];
-	uint8_t NwkSKey[16] = _NWKSKEY;
-
-	if (debug >= 2)
-	{
-		Serial.print(F("old="));
-		for (uint8_t i = 0; i < len; i++)
-		{
-			printHexDigit(buf[i]);
-			Serial.print(' ');
-		}
-		Serial.println();
-	}
-	for (uint8_t i = 0; i < len - 4; i++)
-		cBuf[i] = buf[i];
-	len -= 4;
-
-	uint16_t FrameCount = (cBuf[7] * 256) + cBuf[6];
-	len += micPacket(cBuf, len, FrameCount, NwkSKey, 0);
-
-	if (debug >= 2)
-	{
-		Serial.print(F("new="));
-		for (uint8_t i = 0; i < len; i++)
-		{
-			printHexDigit(cBuf[i]);
-			Serial.print(' ');
-		}
-		Serial.println();
-	}
-	// Mic is only checked, but len is not corrected
-}
-#endif //_CHECK_MIC
-
 // ----------------------------------------------------------------------------
 // SENSORPACKET
 // The gateway may also have local sensors that need reporting.
@@ -673,9 +441,8 @@ int sensorPacket()
 // ENCODEPACKET
 // In Sensor mode, we have to encode the user payload before sending.
 // The same applies to decoding packages in the payload for _LOCALSERVER.
-// The library files for AES are added to the library directory in AES.
-// For the moment we use the AES library made by ideetron as this library
-// is also used in the LMIC stack and is small in size.
+// AES is the lora_aes engine of the SX126x library, the same one that
+// the CMAC and the LoRaMac code use. The key is expanded once per message.
 //
 // The function below follows the LoRa spec exactly.
 //
@@ -687,24 +454,15 @@ int sensorPacket()
 // the meaningful bytes in the last block. This means that encoded buffer
 // is exactly as big as the original message.
 //
-// NOTE:: Be aware that the LICENSE of the used AES library files
-//	that we call with AES_Encrypt() is GPL3. It is used as-is,
-//  but not part of this code.
-//
 // cmac = aes128_encrypt(K, Block_A[i])
 // ----------------------------------------------------------------------------
 uint8_t encodePacket(uint8_t *Data, uint8_t DataLength, uint16_t FrameCount, uint8_t *DevAddr, uint8_t *AppSKey, uint8_t Direction)
 {
+	lora_aes_context aes;
 
 #if DUSB >= 1
 	if ((debug >= 2) && (pdebug & P_GUI))
 	{
-		Serial.print(F("G encodePacket:: DevAddr="));
-		for (int i = 0; i < 4; i++)
-		{
-			Serial.print(DevAddr[i], HEX);
-			Serial.print(' ');
-		}
 		Serial.print(F("G encodePacket:: AppSKey="));
 		for (int i = 0; i < 16; i++)
 		{
@@ -715,7 +473,30 @@ uint8_t encodePacket(uint8_t *Data, uint8_t DataLength, uint16_t FrameCount, uin
 	}
 #endif
 
-	//unsigned char AppSKey[16] = _APPSKEY ;	// see ESP-sc-gway.h
+	lora_aes_set_key(AppSKey, 16, &aes);
+	return (encodePacket(Data, DataLength, FrameCount, DevAddr, &aes, Direction));
+}
+
+// ----------------------------------------------------------------------------
+// The same with an AppSKey that is already expanded, as the device sessions
+// of the _LOCALSERVER keep it.
+// ----------------------------------------------------------------------------
+uint8_t encodePacket(uint8_t *Data, uint8_t DataLength, uint16_t FrameCount, uint8_t *DevAddr, const lora_aes_context *aes, uint8_t Direction)
+{
+
+#if DUSB >= 1
+	if ((debug >= 2) && (pdebug & P_GUI))
+	{
+		Serial.print(F("G encodePacket:: DevAddr="));
+		for (int i = 0; i < 4; i++)
+		{
+			Serial.print(DevAddr[i], HEX);
+			Serial.print(' ');
+		}
+		Serial.println();
+	}
+#endif
+
 	uint8_t i, j;
 	uint8_t Block_A[16];
 	uint8_t bLen = 16; // Block length is 16 except for last block in message
@@ -751,7 +532,7 @@ uint8_t encodePacket(uint8_t *Data, uint8_t DataLength, uint16_t FrameCount, uin
 		Block_A[15] = i;
 
 		// Encrypt and calculate the S
-		AES_Encrypt(Block_A, AppSKey);
+		lora_aes_encrypt(Block_A, Block_A, aes);
 
 		// Last block? set bLen to rest
 		if ((i == numBlocks) && (restLength > 0))
@@ -767,4 +548,62 @@ uint8_t encodePacket(uint8_t *Data, uint8_t DataLength, uint16_t FrameCount, uin
 	return (DataLength); // or only 16*(numBlocks-1)+bLen;
 }
 
+// ----------------------------------------------------------------------------
+// MICCOMPUTE
+// MIC of a data frame (par 4.4 of the spec, RFC4493)
+// Parameters:
+//	- cmac:	CMAC context with the NwkSKey set, from AES_CMAC_Cached() or
+//			the nwk context of a session
+//	- data:	uint8_t array of bytes = ( MHDR | FHDR | FPort | FRMPayload )
+//	- len:	Length of data without the MIC
+//	- fcnt:	32-bit frame counter
+//	- dir:	0=up, 1=down
+//	- mic:	4 bytes for the result
+//
+// B0 = ( 0x49 | 4 x 0x00 | Dir | 4 x DevAddr | 4 x FCnt |  0x00 | len )
+// MIC is cmac [0:3] of ( aes128_cmac(NwkSKey, B0 | Data )
+//
+// B0 and data are fed to the CMAC one after the other, without copying them
+// into one buffer first.
+// ----------------------------------------------------------------------------
+void micCompute(AES_CMAC_CTX *cmac, const uint8_t *data, uint8_t len,
+				uint32_t fcnt, uint8_t dir, uint8_t *mic)
+{
+	uint8_t Block_B[16];
+	uint8_t Y[AES_CMAC_DIGEST_LENGTH];
+
+	Block_B[0] = 0x49; // 1 byte MIC code
+
+	Block_B[1] = 0x00; // 4 byte 0x00
+	Block_B[2] = 0x00;
+	Block_B[3] = 0x00;
+	Block_B[4] = 0x00;
+
+	Block_B[5] = dir; // 1 byte Direction
+
+	Block_B[6] = data[1]; // 4 byte DevAddr, LSB first as in the FHDR
+	Block_B[7] = data[2];
+	Block_B[8] = data[3];
+	Block_B[9] = data[4];
+
+	Block_B[10] = (fcnt & 0xFF); // 4 byte FCNT, LSB first
+	Block_B[11] = ((fcnt >> 8) & 0xFF);
+	Block_B[12] = ((fcnt >> 16) & 0xFF);
+	Block_B[13] = ((fcnt >> 24) & 0xFF);
+
+	Block_B[14] = 0x00; // 1 byte 0x00
+
+	Block_B[15] = len; // 1 byte len
+
+	AES_CMAC_Reset(cmac);
+	AES_CMAC_Update(cmac, Block_B, 16);
+	AES_CMAC_Update(cmac, data, len);
+	AES_CMAC_Final(Y, cmac);
+
+	mic[0] = Y[0];
+	mic[1] = Y[1];
+	mic[2] = Y[2];
+	mic[3] = Y[3];
+}
+
 #endif
\ No newline at end of file
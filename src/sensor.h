@@ -55,6 +55,10 @@ struct nodex
 
 // Add all your named and trusted nodes to this list
 extern struct nodex nodes[2];
+
+// The lists of _TRUSTED_NODES 2, see nodeLists.cpp
+#define LIST_ALLOW 0
+#define LIST_DENY 1
 #endif //_TRUSTED_NODES
 
 #endif // SENSOR_H
\ No newline at end of file
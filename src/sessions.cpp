@@ -0,0 +1,440 @@
+// 1-channel LoRa Gateway for ESP8266
+// Copyright (c) 2016, 2017, 2018, 2019 Maarten Westenberg version for ESP8266
+// Version 6.1.0
+// Date: 2019-10-20
+// Author: Maarten Westenberg (mw12554@hotmail.com)
+//
+// Based on work done by Thomas Telkamp for Raspberry PI 1-ch gateway and many others.
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License
+// which accompanies this distribution, and is available at
+// https://opensource.org/licenses/mit-license.php
+//
+// NO WARRANTY OF ANY KIND IS PROVIDED
+//
+// The protocols and specifications used for this 1ch gateway:
+// 1. LoRA Specification version V1.0 and V1.1 for Gateway-Node communication
+//
+// 2. Semtech Basic communication protocol between Lora gateway and server version 3.0.0
+//	https://github.com/Lora-net/packet_forwarder/blob/master/PROTOCOL.TXT
+//
+// Notes:
+// - Once call gethostbyname() to get IP for services, after that only use IP
+//	 addresses (too many gethost name makes the ESP unstable)
+// - Only call yield() in main stream (not for background NTP sync).
+//
+//
+// ********************************************************************************
+// ********************************************************************************
+// Ported to use with Semtech SX1262 chips
+// Author: Bernd Giesecke (https://github.com/beegee-tokyo)
+//
+// Port is work in progress
+// CAD and HOP is not supported for SX1262 chips
+// Downlink is not working
+// Compiles under PlatformIO only
+// ********************************************************************************
+// ********************************************************************************
+//
+// This file contains the device session table of the _LOCALSERVER.
+// ========================================================================================
+
+#include "defines.h"
+
+#if _LOCALSERVER == 1
+
+// ----------------------------------------------------------------------------
+// The sessions are kept in one array without gaps, a removed session is
+// replaced by the last one. An open addressing hash index with linear
+// probing maps the DevAddr to the array position, so a lookup costs one
+// multiplication and (nearly always) one or two compares, no matter how
+// many devices are known. The index has at least twice as many slots as
+// the table can hold, which keeps the probe sequences short.
+//
+// SESSIONFILE record layout (little endian):
+//	addr(4), fcnt(4), nm(32), nwkKey(16), appKey(16), checksum(1)
+// ----------------------------------------------------------------------------
+
+#if (SESSION_MAX_DRAM < KNOWN_NODES) || (SESSION_MAX < SESSION_MAX_DRAM)
+#error "KNOWN_NODES <= SESSION_MAX_DRAM <= SESSION_MAX is needed"
+#endif
+
+#define SESSION_FREE 0xFFFF
+#define SESSION_REC (4 + 4 + 32 + 16 + 16)
+
+static struct session *sessions = NULL; // The table, SESSION_MAX entries at most
+static uint16_t *sessionIdx = NULL;		// Hash index, positions in sessions
+static uint8_t sessionBits = 0;			// The index has 2^sessionBits slots
+int sessionCount = 0;					// Sessions in use
+int sessionMax = 0;						// Sessions that fit in the table
+static bool sessionDirty = false;		// A frame counter changed since sessionSave()
+static time_t sessionSaved = 0;			// Time of the last sessionSave()
+
+// ----------------------------------------------------------------------------
+// Home slot of a DevAddr (Fibonacci hashing)
+// ----------------------------------------------------------------------------
+static inline uint16_t sessionHash(uint32_t addr)
+{
+	return ((uint32_t)(addr * 2654435761U) >> (32 - sessionBits));
+}
+
+// ----------------------------------------------------------------------------
+// Slot of addr in the index, or of the free slot where it would go
+// ----------------------------------------------------------------------------
+static uint16_t sessionSlot(uint32_t addr)
+{
+	uint16_t mask = (1 << sessionBits) - 1;
+	uint16_t i = sessionHash(addr);
+	while ((sessionIdx[i] != SESSION_FREE) && (sessions[sessionIdx[i]].addr != addr))
+	{
+		i = (i + 1) & mask;
+	}
+	return (i);
+}
+
+// ----------------------------------------------------------------------------
+// Memory for the table. PSRAM when the board has it, else internal RAM.
+// ----------------------------------------------------------------------------
+static void *sessionAlloc(size_t size)
+{
+#if ESP32_ARCH == 1
+	if (psramFound())
+	{
+		return (ps_malloc(size));
+	}
+#endif
+	return (malloc(size));
+}
+
+// ----------------------------------------------------------------------------
+// Simple 8-bit checksum over a session record
+// ----------------------------------------------------------------------------
+static uint8_t sessionSum(const uint8_t *buf, int len)
+{
+	uint8_t sum = 0;
+	for (int i = 0; i < len; i++)
+	{
+		sum += buf[i];
+	}
+	return (sum);
+}
+
+// ----------------------------------------------------------------------------
+// SESSIONFIND
+// Find the session of a DevAddr
+// Parameters:
+//	addr: DevAddr as a number, 0x260211CE for 26 02 11 CE
+// Returns:
+//	The session or NULL when the device is not known
+// ----------------------------------------------------------------------------
+struct session *sessionFind(uint32_t addr)
+{
+	if (sessionCount == 0)
+	{
+		return (NULL);
+	}
+	uint16_t i = sessionIdx[sessionSlot(addr)];
+	return ((i == SESSION_FREE) ? NULL : &sessions[i]);
+}
+
+// ----------------------------------------------------------------------------
+// SESSIONFRAME
+// Find the session of the DevAddr in the FHDR of a LoRa frame
+// Parameters:
+//	payLoad: The frame, DevAddr is in bytes 1..4 (LSB first)
+// ----------------------------------------------------------------------------
+struct session *sessionFrame(const uint8_t *payLoad)
+{
+	return (sessionFind((uint32_t)payLoad[1] | ((uint32_t)payLoad[2] << 8) |
+						((uint32_t)payLoad[3] << 16) | ((uint32_t)payLoad[4] << 24)));
+}
+
+// ----------------------------------------------------------------------------
+// Session number i, for listing the table. NULL when i is out of range.
+// ----------------------------------------------------------------------------
+struct session *sessionAt(int i)
+{
+	return (((i >= 0) && (i < sessionCount)) ? &sessions[i] : NULL);
+}
+
+// ----------------------------------------------------------------------------
+// SESSIONFCNT
+// Extend the 16-bit FCnt of a frame to 32 bits with the upper half of the
+// last frame counter of the device. A counter that is lower than the last
+// one wrapped around.
+// ----------------------------------------------------------------------------
+uint32_t sessionFcnt(struct session *s, uint16_t fcnt)
+{
+	uint32_t full = (s->fcnt & 0xFFFF0000) | fcnt;
+	if (full < s->fcnt)
+	{
+		full += 0x10000;
+	}
+	return (full);
+}
+
+// ----------------------------------------------------------------------------
+// SESSIONSETFCNT
+// Take the 32-bit FCnt of an accepted frame. The table is written to flash
+// later by sessionCheckpoint().
+// ----------------------------------------------------------------------------
+void sessionSetFcnt(struct session *s, uint32_t fcnt)
+{
+	if (s->fcnt != fcnt)
+	{
+		s->fcnt = fcnt;
+		sessionDirty = true;
+	}
+}
+
+// ----------------------------------------------------------------------------
+// Fill one session and expand its keys
+// ----------------------------------------------------------------------------
+static void sessionSet(struct session *s, uint32_t addr, const char *nm,
+					   const uint8_t *nwkKey, const uint8_t *appKey)
+{
+	s->addr = addr;
+	strncpy(s->nm, nm, sizeof(s->nm) - 1);
+	s->nm[sizeof(s->nm) - 1] = 0;
+	memcpy(s->nwkKey, nwkKey, 16);
+	memcpy(s->appKey, appKey, 16);
+	lora_aes_set_key(s->appKey, 16, &s->app);
+	AES_CMAC_Init(&s->nwk);
+	AES_CMAC_SetKey(&s->nwk, s->nwkKey);
+}
+
+// ----------------------------------------------------------------------------
+// SESSIONADD
+// Add a device, or change name and keys of a device that is already known.
+// The frame counter starts at 0 again, so a device that was reset can be
+// added once more. The table is not written to flash, call sessionSave()
+// for that.
+// Parameters:
+//	addr: DevAddr
+//	nm: Name, truncated to 31 characters
+//	nwkKey, appKey: NwkSKey and AppSKey, 16 bytes each
+// Returns:
+//	The position of the session, -1 when the table is full
+// ----------------------------------------------------------------------------
+int sessionAdd(uint32_t addr, const char *nm, const uint8_t *nwkKey, const uint8_t *appKey)
+{
+	if (sessionMax == 0)
+	{
+		return (-1);
+	}
+	uint16_t slot = sessionSlot(addr);
+	uint16_t i = sessionIdx[slot];
+	if (i == SESSION_FREE)
+	{
+		if (sessionCount >= sessionMax)
+		{
+			return (-1);
+		}
+		i = sessionCount++;
+		sessionIdx[slot] = i;
+	}
+	sessions[i].fcnt = 0;
+	sessionSet(&sessions[i], addr, nm, nwkKey, appKey);
+	return (i);
+}
+
+// ----------------------------------------------------------------------------
+// SESSIONREMOVE
+// Remove a device. The index is repaired with backward shift deletion so
+// no tombstones are needed, the last session moves into the freed position.
+// Returns:
+//	1 when the device was removed, 0 when it was not known
+// ----------------------------------------------------------------------------
+int sessionRemove(uint32_t addr)
+{
+	if (sessionCount == 0)
+	{
+		return (0);
+	}
+	uint16_t mask = (1 << sessionBits) - 1;
+	uint16_t hole = sessionSlot(addr);
+	uint16_t pos = sessionIdx[hole];
+	if (pos == SESSION_FREE)
+	{
+		return (0);
+	}
+
+	// Close the gap in the probe sequence
+	for (uint16_t j = (hole + 1) & mask; sessionIdx[j] != SESSION_FREE; j = (j + 1) & mask)
+	{
+		uint16_t home = sessionHash(sessions[sessionIdx[j]].addr);
+		// Move j into the hole unless its home lies cyclically in (hole, j]
+		if (((j - home) & mask) >= ((j - hole) & mask))
+		{
+			sessionIdx[hole] = sessionIdx[j];
+			hole = j;
+		}
+	}
+	sessionIdx[hole] = SESSION_FREE;
+
+	// Keep the table without gaps
+	sessionCount--;
+	if (pos != sessionCount)
+	{
+		sessions[pos] = sessions[sessionCount];
+		sessionIdx[sessionSlot(sessions[pos].addr)] = pos;
+	}
+	return (1);
+}
+
+// ----------------------------------------------------------------------------
+// SESSIONSAVE
+// Write all sessions to SESSIONFILE. A temporary file is written first and
+// renamed so a power loss never leaves a half written table.
+// Returns:
+//	Number of sessions written, -1 on error
+// ----------------------------------------------------------------------------
+int sessionSave()
+{
+	uint8_t rec[SESSION_REC + 1];
+	File f = SPIFFS.open(SESSIONFILE ".tmp", "w");
+	if (!f)
+	{
+#if DUSB >= 1
+		if ((debug >= 1) && (pdebug & P_MAIN))
+			Serial.println(F("M ERROR:: sessionSave, open failed"));
+#endif
+		return (-1);
+	}
+	for (int i = 0; i < sessionCount; i++)
+	{
+		struct session *s = &sessions[i];
+		memcpy(rec, &s->addr, 4);
+		memcpy(rec + 4, &s->fcnt, 4);
+		memcpy(rec + 8, s->nm, 32);
+		memcpy(rec + 40, s->nwkKey, 16);
+		memcpy(rec + 56, s->appKey, 16);
+		rec[SESSION_REC] = sessionSum(rec, SESSION_REC);
+		f.write(rec, sizeof(rec));
+	}
+	f.close();
+	sessionDirty = false;
+	sessionSaved = now();
+
+	SPIFFS.remove(SESSIONFILE);
+	if (!SPIFFS.rename(SESSIONFILE ".tmp", SESSIONFILE))
+	{
+		return (-1);
+	}
+	return (sessionCount);
+}
+
+// ----------------------------------------------------------------------------
+// SESSIONCHECKPOINT
+// Write the table when a frame counter changed and the last write is at
+// least _SESSION_SAVE seconds ago. Called from loop().
+// Returns:
+//	Number of sessions written, 0 when nothing was written, -1 on error
+// ----------------------------------------------------------------------------
+int sessionCheckpoint()
+{
+#if _SESSION_SAVE > 0
+	if (sessionDirty && ((now() - sessionSaved) >= _SESSION_SAVE))
+	{
+		return (sessionSave());
+	}
+#endif
+	return (0);
+}
+
+// ----------------------------------------------------------------------------
+// SESSIONINIT
+// Allocate the table and read the sessions from SESSIONFILE. Without that
+// file the decodes[] of loraModem.cpp are taken and written to flash.
+// Called once from setup().
+// Returns:
+//	Number of sessions loaded
+// ----------------------------------------------------------------------------
+int sessionInit()
+{
+	// A table of SESSION_MAX sessions only goes to PSRAM, internal RAM gets
+	// SESSION_MAX_DRAM at most. Smaller tables are tried until one fits.
+	int first = SESSION_MAX_DRAM;
+#if ESP32_ARCH == 1
+	if (psramFound())
+	{
+		first = SESSION_MAX;
+	}
+#endif
+	for (int max = first; (max >= KNOWN_NODES) && (sessions == NULL); max /= 2)
+	{
+		sessionBits = 1;
+		while ((1 << sessionBits) < 2 * max)
+		{
+			sessionBits++;
+		}
+		sessions = (struct session *)sessionAlloc(max * sizeof(struct session));
+		sessionIdx = (uint16_t *)malloc((1 << sessionBits) * sizeof(uint16_t));
+		if ((sessions == NULL) || (sessionIdx == NULL))
+		{
+			free(sessions);
+			free(sessionIdx);
+			sessions = NULL;
+			sessionIdx = NULL;
+			continue;
+		}
+		sessionMax = max;
+	}
+	if (sessions == NULL)
+	{
+#if DUSB >= 1
+		Serial.println(F("M ERROR:: sessionInit, no memory"));
+#endif
+		return (0);
+	}
+	memset(sessionIdx, 0xFF, (1 << sessionBits) * sizeof(uint16_t));
+	sessionCount = 0;
+
+	File f = SPIFFS.open(SESSIONFILE, "r");
+	if (f)
+	{
+		uint8_t rec[SESSION_REC + 1];
+		while (f.read(rec, sizeof(rec)) == sizeof(rec))
+		{
+			if (rec[SESSION_REC] != sessionSum(rec, SESSION_REC))
+			{
+				break; // Damaged record, keep what we have
+			}
+			uint32_t addr, fcnt;
+			memcpy(&addr, rec, 4);
+			memcpy(&fcnt, rec + 4, 4);
+			rec[39] = 0; // Terminate the name
+			int i = sessionAdd(addr, (char *)(rec + 8), rec + 40, rec + 56);
+			if (i < 0)
+			{
+				break;
+			}
+			sessions[i].fcnt = fcnt;
+		}
+		f.close();
+	}
+	else
+	{
+		for (int i = 0; i < KNOWN_NODES; i++)
+		{
+			sessionAdd(decodes[i].id, decodes[i].nm, decodes[i].nwkKey, decodes[i].appKey);
+		}
+		sessionSave();
+	}
+
+	sessionSaved = now();
+
+#if DUSB >= 1
+	if ((debug >= 0) && (pdebug & P_MAIN))
+	{
+		Serial.print(F("M sessionInit:: sessions="));
+		Serial.print(sessionCount);
+		Serial.print(F(", max="));
+		Serial.println(sessionMax);
+	}
+#endif
+	return (sessionCount);
+}
+
+#endif // _LOCALSERVER
@@ -743,7 +743,7 @@ void stateMachine()
 
 			// If read was successful, read the package from the LoRa bus
 			//
-			if (receivePacket() <= 0)
+			if (receivePacket() < 0)
 			{ // read is not successful
 #if DUSB >= 1
 				if ((debug >= 0) && (pdebug & P_RX))
@@ -43,7 +43,6 @@
 
 #include "defines.h"
 
-extern struct codex decodes[2];
 
 // ----------------------------------------------------------------------------
 // DOWN DOWN DOWN DOWN DOWN DOWN DOWN DOWN DOWN DOWN DOWN DOWN DOWN DOWN DOWN
@@ -306,6 +305,10 @@ int sendPacket(uint8_t *buf, uint8_t length)
 	}
 #endif // DUSB
 
+#if A_SERVER == 1
+	wwwEventTx(LoraDown.fff, LoraDown.sfTx, LoraDown.payLength);
+#endif
+
 	// All data is in Payload and parameters and need to be transmitted.
 	// The function is called in user-space
 	_state = S_TX; // _state set to transmit
@@ -342,11 +345,6 @@ int buildPacket(uint32_t tmst, uint8_t *buff_up, struct LoraUp LoraUp, bool inte
 	uint8_t *message = LoraUp.payLoad;
 	char messageLength = LoraUp.payLength;
 
-#if _CHECK_MIC == 1
-	unsigned char NwkSKey[16] = _NWKSKEY;
-	checkMic(message, messageLength, NwkSKey);
-#endif // _CHECK_MIC
-
 	// Read SNR and RSSI from the register. Note: Not for internal sensors!
 	// For internal sensor we fake these values as we cannot read a register
 	if (internal)
@@ -369,15 +367,17 @@ int buildPacket(uint32_t tmst, uint8_t *buff_up, struct LoraUp LoraUp, bool inte
 	//
 	for (int m = (MAX_STAT - 1); m > 0; m--)
 		statr[m] = statr[m - 1];
+	statSeq++; // New entry for the statistics journal
 
 		// From now on we can fill start[0] with sensor data
 #if _LOCALSERVER == 1
 	statr[0].datal = 0;
-	int index;
-	if ((index = inDecodes((char *)(LoraUp.payLoad + 1))) >= 0)
+	struct session *node;
+	if ((node = sessionFrame(LoraUp.payLoad)) != NULL)
 	{
 
 		uint16_t frameCount = LoraUp.payLoad[7] * 256 + LoraUp.payLoad[6];
+		sessionSetFcnt(node, sessionFcnt(node, frameCount));
 
 		for (int k = 0; (k < LoraUp.payLength) && (k < 23); k++)
 		{
@@ -397,7 +397,7 @@ int buildPacket(uint32_t tmst, uint8_t *buff_up, struct LoraUp LoraUp, bool inte
 									  LoraUp.payLength - 9 - 4,
 									  (uint16_t)frameCount,
 									  DevAddr,
-									  decodes[index].appKey,
+									  &node->app,
 									  0);
 	}
 #endif //_LOCALSERVER
@@ -556,33 +556,13 @@ int buildPacket(uint32_t tmst, uint8_t *buff_up, struct LoraUp LoraUp, bool inte
 	}
 #endif // DUSB
 
-// Show received message status on OLED display
+// Show received message status on OLED display, the display task draws it
 #if OLED >= 1
-	char timBuff[20];
-	sprintf(timBuff, "%02i:%02i:%02i", hour(), minute(), second());
-
-	dispWriteHeader();
-
-	display.drawString(0, 11, "Time: " + String(timBuff));
-
 #ifdef CFG_sx1262_radio
-	display.drawString(0, 21, "RSSI: " + String(prssi));
+	oledRx(prssi, SNR, messageLength, message);
 #else
-	display.drawString(0, 21, "RSSI: " + String(prssi - rssicorr));
+	oledRx(prssi - rssicorr, SNR, messageLength, message);
 #endif
-
-	display.drawString(0, 31, "SNR: " + String(SNR) + "   - LEN: " + String((int)messageLength));
-
-	char devAddr[128];
-
-	snprintf(devAddr, 128, "Addr: %02X %02X %02X %02X", message[4], message[3], message[2], message[1]);
-	display.drawString(0, 41, devAddr);
-
-	display.drawString(0, 51, "U " + String(statc.msg_ok + 1) + "   D " + String(statc.msg_down));
-
-	display.display();
-	//yield();
-
 #endif //OLED>=1
 
 	int j;
@@ -732,6 +712,234 @@ int buildPacket(uint32_t tmst, uint8_t *buff_up, struct LoraUp LoraUp, bool inte
 	return (buff_index);
 } // buildPacket
 
+#if _CHECK_MIC == 1
+// ----------------------------------------------------------------------------
+// RXFILTER
+// Decide whether a received frame is forwarded at all. Only data uplinks
+// (unconfirmed and confirmed) are checked, join requests and proprietary
+// frames have no DevAddr and always pass.
+// - The frame must hold MHDR, FHDR with its FOpts and the MIC
+// - With _NETID_BITS > 0 the DevAddr must start with _NETID_PREFIX
+// - With _LOCALSERVER the MIC of a device in the session table is checked
+//	 with the 32-bit FCnt inferred from the last one. A replayed frame has a
+//	 lower FCnt and is taken for the next roll over, so its MIC fails too.
+//	 Unless its FCnt is below _FCNT_RESET and the MIC matches the plain
+//	 16-bit FCnt: that is taken as a reset of an ABP device.
+// Parameters:
+//	payLoad: The PHYPayload as received
+//	payLength: Its length including the MIC
+// Returns:
+//	RX_PASS or the reason to drop the frame, see loraModem.h
+// ----------------------------------------------------------------------------
+int rxFilter(uint8_t *payLoad, uint8_t payLength)
+{
+	uint8_t mtype = payLoad[0] >> 5;
+	if ((mtype != 0x02) && (mtype != 0x04))
+	{
+		return (RX_PASS); // Not a data uplink
+	}
+
+	int reason = RX_PASS;
+	uint32_t addr = (uint32_t)payLoad[1] | ((uint32_t)payLoad[2] << 8) |
+					((uint32_t)payLoad[3] << 16) | ((uint32_t)payLoad[4] << 24);
+
+	if (payLength < 12 + (payLoad[5] & 0x0F))
+	{
+		statc.drop_short++;
+		reason = RX_SHORT;
+	}
+#if _NETID_BITS > 0
+	else if (((addr ^ _NETID_PREFIX) >> (32 - _NETID_BITS)) != 0)
+	{
+		statc.drop_netid++;
+		reason = RX_NETID;
+	}
+#endif
+#if _LOCALSERVER == 1
+	else
+	{
+		struct session *node = sessionFind(addr);
+		if (node != NULL)
+		{
+			uint8_t mic[4];
+			uint16_t fc = payLoad[7] * 256 + payLoad[6];
+			uint32_t fcnt = sessionFcnt(node, fc);
+			micCompute(&node->nwk, payLoad, payLength - 4, fcnt, 0, mic);
+			if ((memcmp(mic, payLoad + payLength - 4, 4) != 0) && (fcnt != fc) && (fc < _FCNT_RESET))
+			{
+				// An ABP device that was reset counts from 0 again, which
+				// looks like a roll over. When the MIC matches the 16-bit
+				// FCnt the device restarted, continue from there.
+				micCompute(&node->nwk, payLoad, payLength - 4, fc, 0, mic);
+				if (memcmp(mic, payLoad + payLength - 4, 4) == 0)
+				{
+#if DUSB >= 1
+					if ((debug >= 1) && (pdebug & P_RX))
+					{
+						Serial.print(F("R rxFilter:: FCnt reset, addr="));
+						Serial.print(addr, HEX);
+						Serial.print(F(", fcnt="));
+						Serial.println(fc);
+					}
+#endif
+					fcnt = fc;
+				}
+			}
+			if (memcmp(mic, payLoad + payLength - 4, 4) != 0)
+			{
+				statc.drop_mic++;
+				reason = RX_MIC;
+			}
+			else
+			{
+				sessionSetFcnt(node, fcnt);
+			}
+		}
+	}
+#endif
+
+#if DUSB >= 1
+	if ((reason != RX_PASS) && (debug >= 1) && (pdebug & P_RX))
+	{
+		Serial.print(F("R rxFilter:: drop reason="));
+		Serial.print(reason);
+		Serial.print(F(", addr="));
+		Serial.println(addr, HEX);
+	}
+#endif
+	return (reason);
+}
+#endif // _CHECK_MIC
+
+#if _DEDUP >= 1
+// ----------------------------------------------------------------------------
+// The last _DEDUP_SIZE frames are kept in a ring, the oldest one is
+// overwritten. An open addressing index with twice as many slots finds a
+// frame with one or two compares. A slot holds the ring position + 1,
+// 0 is a free slot. The full key is compared, so there are no false hits.
+// ----------------------------------------------------------------------------
+#if (_DEDUP_SIZE & (_DEDUP_SIZE - 1)) != 0
+#error "_DEDUP_SIZE must be a power of 2"
+#endif
+#define DEDUP_SLOTS (2 * _DEDUP_SIZE)
+
+struct dedupEntry
+{
+	uint32_t addr; // DevAddr bytes of the FHDR
+	uint32_t mic;  // Last 4 bytes of the frame
+	uint32_t ms;   // millis() when the frame was last seen
+	uint16_t fcnt; // 16-bit FCnt of the FHDR
+	uint8_t len;   // Frame length
+};
+
+static struct dedupEntry dedupRing[_DEDUP_SIZE];
+static uint16_t dedupIdx[DEDUP_SLOTS];
+static uint16_t dedupHead = 0; // Next ring position to write
+
+static inline uint16_t dedupHash(uint32_t addr, uint32_t mic)
+{
+	return (((uint32_t)((addr ^ mic) * 2654435761U) >> 16) & (DEDUP_SLOTS - 1));
+}
+
+// ----------------------------------------------------------------------------
+// Index slot of a key, or the free slot where it would go
+// ----------------------------------------------------------------------------
+static uint16_t dedupSlot(uint32_t addr, uint32_t mic, uint16_t fcnt, uint8_t len)
+{
+	uint16_t i = dedupHash(addr, mic);
+	while (dedupIdx[i] != 0)
+	{
+		struct dedupEntry *e = &dedupRing[dedupIdx[i] - 1];
+		if ((e->mic == mic) && (e->addr == addr) && (e->fcnt == fcnt) && (e->len == len))
+		{
+			break;
+		}
+		i = (i + 1) & (DEDUP_SLOTS - 1);
+	}
+	return (i);
+}
+
+// ----------------------------------------------------------------------------
+// Take ring position pos out of the index (backward shift deletion)
+// ----------------------------------------------------------------------------
+static void dedupDrop(uint16_t pos)
+{
+	struct dedupEntry *e = &dedupRing[pos];
+	uint16_t hole = dedupHash(e->addr, e->mic);
+	while (dedupIdx[hole] != pos + 1)
+	{
+		hole = (hole + 1) & (DEDUP_SLOTS - 1);
+	}
+	for (uint16_t j = (hole + 1) & (DEDUP_SLOTS - 1); dedupIdx[j] != 0; j = (j + 1) & (DEDUP_SLOTS - 1))
+	{
+		struct dedupEntry *m = &dedupRing[dedupIdx[j] - 1];
+		uint16_t home = dedupHash(m->addr, m->mic);
+		if (((j - home) & (DEDUP_SLOTS - 1)) >= ((j - hole) & (DEDUP_SLOTS - 1)))
+		{
+			dedupIdx[hole] = dedupIdx[j];
+			hole = j;
+		}
+	}
+	dedupIdx[hole] = 0;
+}
+
+// ----------------------------------------------------------------------------
+// DEDUPCHECK
+// Look a received frame up in the cache and remember it. Frames shorter
+// than an FHDR and MIC are not cached.
+// Parameters:
+//	payLoad: The PHYPayload as received
+//	payLength: Its length including the MIC
+// Returns:
+//	1 when the same frame was seen less than _DEDUP_WINDOW seconds ago,
+//	0 otherwise
+// ----------------------------------------------------------------------------
+int dedupCheck(uint8_t *payLoad, uint8_t payLength)
+{
+	if (payLength < 12)
+	{
+		return (0);
+	}
+	uint32_t ms = millis();
+	uint32_t addr = (uint32_t)payLoad[1] | ((uint32_t)payLoad[2] << 8) |
+					((uint32_t)payLoad[3] << 16) | ((uint32_t)payLoad[4] << 24);
+	uint8_t *m = payLoad + payLength - 4;
+	uint32_t mic = (uint32_t)m[0] | ((uint32_t)m[1] << 8) |
+				   ((uint32_t)m[2] << 16) | ((uint32_t)m[3] << 24);
+	uint16_t fcnt = payLoad[7] * 256 + payLoad[6];
+
+	uint16_t slot = dedupSlot(addr, mic, fcnt, payLength);
+	if (dedupIdx[slot] != 0)
+	{
+		struct dedupEntry *e = &dedupRing[dedupIdx[slot] - 1];
+		uint32_t age = ms - e->ms;
+		e->ms = ms;
+		if (age < (_DEDUP_WINDOW * 1000UL))
+		{
+			statc.msg_dup++;
+			return (1);
+		}
+		return (0); // Same frame, but long ago
+	}
+
+	// New frame, it replaces the oldest one
+	struct dedupEntry *e = &dedupRing[dedupHead];
+	if (e->len != 0)
+	{
+		dedupDrop(dedupHead);
+		slot = dedupSlot(addr, mic, fcnt, payLength);
+	}
+	e->addr = addr;
+	e->mic = mic;
+	e->ms = ms;
+	e->fcnt = fcnt;
+	e->len = payLength;
+	dedupIdx[slot] = dedupHead + 1;
+	dedupHead = (dedupHead + 1) & (_DEDUP_SIZE - 1);
+	return (0);
+}
+#endif // _DEDUP
+
 // ----------------------------------------------------------------------------
 // UP UP UP UP UP UP UP UP UP UP UP UP UP UP UP UP UP UP UP UP UP UP UP UP UP
 // Receive a LoRa package over the air, LoRa and deliver to server(s)
@@ -740,6 +948,8 @@ int buildPacket(uint32_t tmst, uint8_t *buff_up, struct LoraUp LoraUp, bool inte
 // returns values:
 // - returns the length of string returned in buff_up
 // - returns -1 or -2 when no message arrived, depending connection.
+// - returns 0 when the node lists, rxFilter(), dedupCheck() or rateCheck()
+//   dropped the message
 //
 // This is the "highlevel" function called by loop()
 // ----------------------------------------------------------------------------
@@ -764,8 +974,73 @@ int receivePacket()
 	if (LoraUp.payLength > 0)
 	{
 
+#if (_TRUSTED_NODES >= 2) || (_RATE_LIMIT >= 1)
+		// Only data uplinks carry a DevAddr
+		uint8_t mtype = LoraUp.payLoad[0] >> 5;
+		bool dataUp = ((mtype == 0x02) || (mtype == 0x04)) && (LoraUp.payLength >= 5);
+		uint32_t addr = (uint32_t)LoraUp.payLoad[1] | ((uint32_t)LoraUp.payLoad[2] << 8) |
+						((uint32_t)LoraUp.payLoad[3] << 16) | ((uint32_t)LoraUp.payLoad[4] << 24);
+#endif
+
+#if _TRUSTED_NODES >= 2
+		// Allow and deny lists first, a rejected frame costs a few hashes
+		if (dataUp && (listCheck(addr) != RX_PASS))
+		{
+			statc.drop_list++;
+			LoraUp.payLength = 0;
+			LoraUp.payLoad[0] = 0x00;
+			return (0); // Nothing forwarded
+		}
+#endif
+
+#if _CHECK_MIC == 1
+		// Drop unwanted frames before any JSON or base64 work is done
+		if (rxFilter(LoraUp.payLoad, LoraUp.payLength) != RX_PASS)
+		{
+			LoraUp.payLength = 0;
+			LoraUp.payLoad[0] = 0x00;
+			return (0); // Nothing forwarded
+		}
+#endif
+
+#if _DEDUP >= 1
+		// Retransmissions and frames that a repeater sent once more
+		if (dedupCheck(LoraUp.payLoad, LoraUp.payLength))
+		{
+#if DUSB >= 1
+			if ((debug >= 1) && (pdebug & P_RX))
+			{
+				Serial.println(F("R receivePacket:: duplicate"));
+			}
+#endif
+#if _DEDUP == 2
+			// A confirmed uplink is sent again when the node missed the
+			// ACK, the network server must see it to send the ACK again
+			if ((LoraUp.payLoad[0] >> 5) != 0x04)
+			{
+				LoraUp.payLength = 0;
+				LoraUp.payLoad[0] = 0x00;
+				return (0); // Nothing forwarded
+			}
+#endif
+		}
+#endif
+
+#if _RATE_LIMIT >= 1
+		// Last, so duplicates and rejected frames do not use up tokens
+		if (dataUp && (rateCheck(addr) != RX_PASS))
+		{
+			LoraUp.payLength = 0;
+			LoraUp.payLoad[0] = 0x00;
+			return (0); // Nothing forwarded
+		}
+#endif
+
 		// externally received packet, so last parameter is false (==LoRa external)
 		int build_index = buildPacket(tmst, buff_up, LoraUp, false);
+#if A_SERVER == 1
+		wwwEventRx(LoraUp.payLoad, LoraUp.payLength, LoraUp.sf, LoraUp.prssi - LoraUp.rssicorr, LoraUp.snr);
+#endif
 
 		// REPEATER is a special function where we retransmit received
 		// message on _ICHANN to _OCHANN.
@@ -818,8 +1093,8 @@ int receivePacket()
 		//
 		// 4 bytes MIC trailer
 
-		int index = 0;
-		if ((index = inDecodes((char *)(LoraUp.payLoad + 1))) >= 0)
+		struct session *node;
+		if ((node = sessionFrame(LoraUp.payLoad)) != NULL)
 		{
 
 			uint8_t DevAddr[4];
@@ -832,8 +1107,8 @@ int receivePacket()
 #if DUSB >= 1
 			if ((debug >= 1) && (pdebug & P_RX))
 			{
-				Serial.print(F("R receivePacket:: Ind="));
-				Serial.print(index);
+				Serial.print(F("R receivePacket:: Node="));
+				Serial.print(node->nm);
 				Serial.print(F(", Len="));
 				Serial.print(LoraUp.payLength);
 				Serial.print(F(", A="));
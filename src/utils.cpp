@@ -45,47 +45,39 @@
 // ==================== STRING STRING STRING ==================================
 
 // ----------------------------------------------------------------------------
-// Fill a HEXadecimal String  from a 4-byte char array
-//
+// Fill a HEXadecimal string from a 4-byte char array
+// Parameters:
+//	hexa; 4 bytes to print
+//	sep; separator character printed after every byte
+//	buf; output buffer of at least 13 characters
 // ----------------------------------------------------------------------------
-void printHEX(char *hexa, const char sep, String &response)
+void printHEX(char *hexa, const char sep, char *buf)
 {
-	char m;
-	m = hexa[0];
-	if (m < 016)
-		response += '0';
-	response += String(m, HEX);
-	response += sep;
-	m = hexa[1];
-	if (m < 016)
-		response += '0';
-	response += String(m, HEX);
-	response += sep;
-	m = hexa[2];
-	if (m < 016)
-		response += '0';
-	response += String(m, HEX);
-	response += sep;
-	m = hexa[3];
-	if (m < 016)
-		response += '0';
-	response += String(m, HEX);
-	response += sep;
+	for (int i = 0; i < 4; i++)
+	{
+		sprintf(&buf[3 * i], "%02x%c", (uint8_t)hexa[i], sep);
+	}
 }
 
 // ----------------------------------------------------------------------------
 // stringTime
-// Print the time t into the String reponse. t is of type time_t in seconds.
+// Print the time t into the buffer buf. t is of type time_t in seconds.
 // Only when RTC is present we print real time values
 // t contains number of seconds since system started that the event happened.
 // So a value of 100 would mean that the event took place 1 minute and 40 seconds ago
+// Parameters:
+//	t; time to print
+//	buf; output buffer, 32 characters is enough for every date
+//	len; size of buf
 // ----------------------------------------------------------------------------
-void stringTime(time_t t, String &response)
+void stringTime(time_t t, char *buf, int len)
 {
+	static const char *days[] = {"", "Sunday", "Monday", "Tuesday", "Wednesday",
+								 "Thursday", "Friday", "Saturday"};
 
 	if (t == 0)
 	{
-		response += "--";
+		snprintf(buf, len, "--");
 		return;
 	}
 
@@ -95,47 +87,9 @@ void stringTime(time_t t, String &response)
 	time_t eTime = t;
 
 	// Rest is standard
-	byte _hour = hour(eTime);
-	byte _minute = minute(eTime);
-	byte _second = second(eTime);
-
-	switch (weekday(eTime))
-	{
-	case 1:
-		response += "Sunday ";
-		break;
-	case 2:
-		response += "Monday ";
-		break;
-	case 3:
-		response += "Tuesday ";
-		break;
-	case 4:
-		response += "Wednesday ";
-		break;
-	case 5:
-		response += "Thursday ";
-		break;
-	case 6:
-		response += "Friday ";
-		break;
-	case 7:
-		response += "Saturday ";
-		break;
-	}
-	response += String() + day(eTime) + "-";
-	response += String() + month(eTime) + "-";
-	response += String() + year(eTime) + " ";
-
-	if (_hour < 10)
-		response += "0";
-	response += String() + _hour + ":";
-	if (_minute < 10)
-		response += "0";
-	response += String() + _minute + ":";
-	if (_second < 10)
-		response += "0";
-	response += String() + _second;
+	snprintf(buf, len, "%s %d-%d-%d %02d:%02d:%02d", days[weekday(eTime)],
+			 day(eTime), month(eTime), year(eTime),
+			 hour(eTime), minute(eTime), second(eTime));
 }
 
 // ============== SERIAL SERIAL SERIAL ========================================
@@ -307,12 +261,13 @@ void SerialStat(uint8_t intr)
 }
 
 // ----------------------------------------------------------------------------
-// SerialName(id, response)
+// SerialName(id, buf, len)
 // Check whether for address a (4 bytes in Unsigned Long) there is a name
+// and copy it to buf.
 // This function only works if _TRUSTED_NODES is set
 // ----------------------------------------------------------------------------
 
-int SerialName(char *a, String &response)
+int SerialName(char *a, char *buf, int len)
 {
 #if _TRUSTED_NODES >= 1
 	uint32_t id = ((a[0] << 24) | (a[1] << 16) | (a[2] << 8) | a[3]);
@@ -333,7 +288,7 @@ int SerialName(char *a, String &response)
 				Serial.println();
 			}
 #endif
-			response += nodes[i].nm;
+			snprintf(buf, len, "%s", nodes[i].nm);
 			return (i);
 		}
 	}
@@ -342,28 +297,3 @@ int SerialName(char *a, String &response)
 	return (-1); // If no success OR is TRUSTED NODES not defined
 }
 
-#if _LOCALSERVER == 1
-// ----------------------------------------------------------------------------
-// inDecodes(id)
-// Find the id in Decodes array, and return the index of the item
-// Parameters:
-//		id: The first field in the array (normally DevAddr id). Must be char[4]
-// Returns:
-//		The index of the ID in the Array. Returns -1 if not found
-// ----------------------------------------------------------------------------
-int inDecodes(char *id)
-{
-
-	uint32_t ident = ((id[3] << 24) | (id[2] << 16) | (id[1] << 8) | id[0]);
-
-	int i;
-	for (i = 0; i < (sizeof(decodes) / sizeof(codex)); i++)
-	{
-		if (ident == decodes[i].id)
-		{
-			return (i);
-		}
-	}
-	return (-1);
-}
-#endif
@@ -0,0 +1,204 @@
+// Generated by tools/wwwGzip.py from www/index.html, do not edit
+#ifndef WWWINDEX_H
+#define WWWINDEX_H
+
+#define WWW_INDEX_ETAG "\"3b4fe24d\""
+
+static const uint8_t wwwIndexGz[3090] PROGMEM = {
+	0x1f,0x8b,0x08,0x00,0x00,0x00,0x00,0x00,0x02,0x03,0x95,0x59,0x7b,0x53,0xdb,0xc6,
+	0x16,0xff,0x1b,0x7f,0x8a,0x8d,0x6f,0x8b,0xe4,0x62,0x0b,0xdb,0x69,0x93,0xd4,0xaf,
+	0x0c,0x01,0x1c,0xb8,0x25,0xc0,0xc5,0xd0,0xdc,0x4e,0xca,0xdc,0x91,0xa5,0x95,0xa5,
+	0x22,0xaf,0x14,0xed,0xda,0x86,0x52,0xbe,0xfb,0x3d,0xe7,0xec,0x4a,0x96,0x8c,0x49,
+	0xa7,0x99,0x89,0xa5,0xdd,0x3d,0xaf,0x3d,0x8f,0xdf,0x9e,0x15,0x83,0x57,0x47,0x17,
+	0x87,0xd7,0xbf,0x5d,0x1e,0xb3,0x93,0xeb,0x4f,0x67,0xa3,0xda,0x20,0x54,0xf3,0x18,
+	0x1f,0xdc,0xf5,0xe1,0x31,0xe7,0xca,0x65,0x5e,0xe8,0x66,0x92,0xab,0x61,0xfd,0xe6,
+	0x7a,0xdc,0x7a,0x57,0xcf,0xa7,0x85,0x3b,0xe7,0xc3,0xfa,0x32,0xe2,0xab,0x34,0xc9,
+	0x54,0x9d,0x79,0x89,0x50,0x5c,0x00,0xd9,0x2a,0xf2,0x55,0x38,0xf4,0xf9,0x32,0xf2,
+	0x78,0x8b,0x06,0x4d,0x16,0x89,0x48,0x45,0x6e,0xdc,0x92,0x9e,0x1b,0xf3,0x61,0x07,
+	0x85,0xa8,0x48,0xc5,0x7c,0x74,0x3c,0xb9,0x7c,0xdd,0x65,0x1d,0x2f,0x64,0x1f,0x5d,
+	0xc5,0x57,0xee,0xc3,0x60,0x5f,0x2f,0xd4,0x06,0x52,0x3d,0xe0,0x73,0x9a,0xf8,0x0f,
+	0xec,0x31,0x00,0xe9,0xad,0xc0,0x9d,0x47,0xf1,0x43,0x4f,0xba,0x42,0xb6,0x24,0xcf,
+	0xa2,0xa0,0xcf,0xe6,0x6e,0x36,0x8b,0x44,0xef,0x5d,0x7a,0xdf,0x7f,0xaa,0x29,0x77,
+	0x1a,0x73,0xf6,0x38,0x8f,0x84,0xd6,0xdb,0xfb,0xb1,0xdd,0x86,0x05,0xa6,0x07,0x3f,
+	0xbf,0xfb,0xbe,0xcf,0xa6,0x49,0xe6,0xf3,0xac,0xd7,0x49,0xef,0x99,0x4c,0xe2,0xc8,
+	0x67,0xd3,0xd8,0xf5,0xee,0xf2,0xf9,0x96,0x97,0xc4,0xb1,0x9b,0x4a,0xde,0xcb,0x5f,
+	0x72,0x0d,0xad,0x69,0xa2,0x54,0x32,0xef,0x75,0xba,0x5a,0x53,0xc8,0x1e,0xa7,0xc0,
+	0x38,0xcb,0x92,0x85,0xf0,0x91,0x2d,0xc9,0x7a,0xb3,0x8c,0x73,0xd1,0x67,0x7a,0xb0,
+	0x0a,0x23,0x05,0xdc,0x8a,0xdf,0xab,0x96,0x1b,0x47,0x33,0xd1,0x8b,0x79,0xa0,0x90,
+	0xd5,0x6f,0x32,0x62,0x7f,0xc1,0x92,0xd4,0xf5,0xfd,0x48,0xcc,0x7a,0xa0,0x88,0xfd,
+	0x48,0xca,0x9c,0x44,0x6c,0xd1,0x76,0x16,0xcd,0x42,0xf5,0x91,0x54,0x22,0x49,0x10,
+	0x6c,0xa1,0x49,0x32,0x57,0xcc,0x38,0xac,0xcb,0xb9,0x1b,0xc7,0xc6,0x8b,0x32,0xfa,
+	0x93,0xf7,0x3a,0x6d,0x12,0x3d,0xd8,0x37,0x5e,0x1e,0xec,0x9b,0x90,0xa3,0xbb,0x31,
+	0x01,0x3a,0x18,0x9a,0x3c,0x28,0xec,0x30,0x11,0x41,0x34,0x03,0xa2,0x0e,0x06,0x86,
+	0x84,0x45,0x3e,0x44,0x9f,0x67,0xf5,0x11,0xc8,0xc0,0x89,0x51,0x0d,0xb8,0xba,0xa3,
+	0x4b,0xb0,0xc1,0x9d,0x71,0x36,0x51,0xae,0x8a,0xa4,0x8a,0x3c,0x09,0x5c,0x5d,0x8c,
+	0x37,0x05,0x07,0xb9,0x24,0x2c,0x49,0xe4,0xa3,0x29,0xc3,0xf7,0x89,0x4b,0x89,0x7c,
+	0x27,0xc0,0x94,0x64,0x0f,0xcf,0x98,0x42,0x98,0xdf,0xe4,0xc9,0xad,0x9b,0x70,0xa5,
+	0xc0,0x65,0xcf,0x35,0x79,0xc1,0x6c,0x93,0xe7,0x17,0x91,0xac,0x04,0x3b,0x4f,0x7c,
+	0xfe,0x9c,0x5c,0xe0,0xec,0x26,0xc3,0x24,0xe5,0x9e,0xca,0x16,0x73,0x43,0x9d,0x8e,
+	0x06,0xd3,0x05,0xa4,0x82,0x60,0x89,0xf0,0xe2,0xc8,0xbb,0x83,0xfd,0x00,0x85,0x6d,
+	0xa5,0xb1,0x2b,0x86,0x1d,0xab,0x51,0x1f,0x1d,0x86,0xae,0x10,0x3c,0x06,0xf9,0x9a,
+	0x12,0xb8,0x22,0x91,0x2e,0x14,0xe9,0x08,0xda,0x75,0x86,0x11,0x18,0xd6,0x7f,0xae,
+	0xb3,0xa5,0x1b,0x2f,0xe0,0xed,0xdd,0x9b,0xd7,0x6d,0xfa,0x57,0x1f,0x31,0x95,0xb0,
+	0x32,0x75,0x67,0x0b,0xf5,0xdb,0x76,0x41,0x7d,0xf2,0x67,0x93,0x49,0xc5,0xd3,0x0a,
+	0x4f,0x37,0xe7,0x79,0x53,0xf0,0x74,0x0c,0x43,0xed,0x05,0xe3,0x21,0x24,0x99,0x1a,
+	0x5a,0x6c,0x8f,0x7d,0x67,0x5b,0x41,0xdb,0x6a,0x38,0xc4,0x08,0x63,0x6b,0x17,0xe2,
+	0x91,0x16,0x4b,0x9d,0x8d,0x25,0xbe,0x5e,0xea,0xe6,0x4b,0xe0,0x82,0x2b,0xcc,0xbb,
+	0xd2,0xfe,0xb7,0x6b,0x85,0xa4,0xd5,0x1e,0xbb,0x08,0x82,0x82,0x98,0x95,0xf2,0x0b,
+	0xc9,0xd6,0x09,0x36,0xd8,0x4f,0x41,0x94,0xe7,0x8a,0xa5,0x2b,0x69,0x79,0x15,0xd4,
+	0x75,0x6d,0x0f,0xeb,0x3f,0x75,0x60,0xd7,0x21,0xc7,0x9a,0x18,0xd6,0xbb,0x6d,0x74,
+	0x32,0x26,0xb6,0x41,0x23,0x5d,0xfb,0x7a,0xb9,0xd7,0xd5,0xa0,0xf0,0x42,0xfd,0xa1,
+	0x3a,0xad,0x02,0xe3,0x0f,0xd1,0x36,0xba,0x5d,0x16,0x66,0x3c,0x18,0xd6,0xf7,0x11,
+	0x28,0x21,0xc6,0xb1,0x2b,0x65,0xe4,0x41,0xb5,0xe2,0x3e,0xdd,0x11,0xfb,0xab,0xb6,
+	0x26,0x71,0xd3,0x68,0xdf,0xa3,0x8a,0xa9,0x8f,0x3c,0x53,0x39,0x48,0xc2,0xaa,0x24,
+	0xa6,0x0e,0xe8,0xb1,0x55,0x46,0xa8,0x6b,0xa1,0x3e,0x0a,0xf3,0xa2,0xd8,0x22,0xc5,
+	0x24,0xad,0xd0,0x19,0xbd,0x45,0x8a,0x34,0x09,0x0c,0x9a,0x8a,0x54,0x76,0xab,0x4e,
+	0x85,0x9a,0xf6,0xb2,0x28,0x55,0xa3,0xda,0xd2,0xcd,0xd8,0x77,0x6c,0xc8,0x82,0x85,
+	0xf0,0x54,0x04,0x21,0xb3,0x23,0xbf,0xc1,0x1e,0x59,0xc6,0xd5,0x22,0x13,0xcc,0x4f,
+	0xbc,0xc5,0x1c,0x50,0xde,0x99,0x71,0x75,0x1c,0x73,0x7c,0xfd,0xf0,0x70,0xea,0x23,
+	0x51,0x9f,0x3d,0xf5,0x6b,0xb5,0x82,0x0f,0x08,0xec,0x45,0x16,0x37,0x59,0x20,0x80,
+	0xbf,0xb6,0x13,0x70,0xe5,0x85,0x7a,0xe6,0xd1,0x73,0xbd,0x90,0xf7,0x98,0x25,0x92,
+	0x16,0xee,0x8b,0x5b,0x4f,0x0d,0x47,0x85,0x5c,0xd8,0x6b,0xad,0x59,0x49,0x69,0xe6,
+	0xfc,0x21,0x13,0x61,0xa3,0x86,0x9c,0x4e,0x34,0xfa,0xb5,0xa7,0x5a,0x6d,0x7f,0x1f,
+	0x6a,0x5f,0xf8,0x90,0x57,0x9c,0x49,0x0d,0x02,0x58,0x40,0x40,0xc3,0x66,0x1a,0x1b,
+	0x9a,0x8c,0x3b,0x33,0x07,0x17,0x6d,0x6b,0x32,0xb6,0x9a,0xac,0xd3,0x58,0xdb,0x88,
+	0xb3,0x77,0x4d,0xb6,0x2c,0x19,0x68,0x95,0x82,0xf7,0x1e,0x33,0xfb,0x0e,0x13,0x9d,
+	0x72,0x9c,0x0b,0x0f,0x7c,0x7c,0x73,0x75,0x7a,0x98,0xcc,0x53,0xd0,0x28,0x94,0xbd,
+	0x6c,0xc0,0x6e,0xe0,0x34,0x0c,0x13,0x1f,0xb6,0x73,0x79,0x31,0xb9,0x86,0xad,0xd4,
+	0x76,0x76,0xfe,0xd9,0x6e,0x64,0x98,0xac,0x0e,0x83,0x99,0xde,0x52,0xc1,0x94,0x26,
+	0xd2,0x78,0xf0,0x2b,0xd9,0x17,0x05,0xcc,0x26,0xbb,0xb2,0xb9,0xfd,0xb5,0xd1,0x60,
+	0x65,0x87,0x6e,0x9a,0xa0,0xe5,0x42,0x0a,0x64,0x5c,0x86,0x85,0xab,0xae,0xe1,0x2c,
+	0x62,0x41,0x96,0xcc,0xcb,0x0e,0x62,0x50,0x4b,0x98,0xd2,0x4d,0xa6,0x4f,0x6c,0x3a,
+	0xd7,0x25,0x83,0x12,0x60,0x53,0x72,0x2a,0x9b,0x02,0x8d,0x78,0x40,0x17,0x83,0x55,
+	0xc8,0x79,0x76,0x70,0xbe,0x36,0x93,0x4b,0xcf,0x56,0x64,0xa0,0xd9,0xdf,0x44,0x65,
+	0x10,0x06,0x98,0x73,0x32,0x0e,0x98,0xe8,0x71,0x7b,0xff,0xcb,0xee,0x60,0x54,0xb7,
+	0x6e,0xf7,0x67,0xcd,0x52,0x5e,0x79,0xc4,0x94,0x73,0x3d,0x5a,0xbb,0x16,0xd8,0xbf,
+	0xeb,0xce,0xd3,0x3e,0x44,0xc9,0x1a,0xd0,0x28,0x56,0x34,0x18,0xd1,0x60,0xa6,0x07,
+	0x75,0x1a,0x7c,0x5d,0x24,0x34,0xac,0x5b,0x75,0x1c,0xfe,0xeb,0xf5,0xcf,0x7d,0xeb,
+	0xe9,0x8b,0x77,0xdb,0xaf,0xed,0x3c,0x6d,0x38,0x32,0x4b,0x56,0xb6,0xc7,0xe3,0x58,
+	0xc2,0xb9,0xeb,0xce,0x48,0x2b,0x3c,0x21,0xc7,0xf1,0xf7,0xaf,0xbf,0x98,0xa5,0x7c,
+	0xab,0x5f,0x98,0x6f,0x0d,0x54,0x36,0xc2,0x70,0x13,0x8b,0x33,0x77,0x53,0xbb,0x6a,
+	0x33,0x2b,0x08,0x91,0x0a,0x65,0xec,0xa1,0x85,0xc8,0x81,0x6f,0x83,0xfd,0xca,0x34,
+	0x45,0xf9,0x8f,0x24,0x12,0xb6,0x65,0x35,0xf4,0x3a,0xca,0xaf,0x5a,0x38,0x55,0x82,
+	0xf2,0x10,0x0c,0xac,0x28,0x78,0x86,0x9a,0x90,0xaf,0xbf,0x5b,0x45,0x56,0xfe,0x6e,
+	0x35,0xf5,0x68,0xa9,0x47,0x00,0xa4,0xa4,0x5b,0xab,0x31,0x70,0x8a,0x16,0x94,0x54,
+	0x25,0x02,0xb0,0x16,0x95,0x25,0xa2,0x1c,0x34,0x6b,0x20,0x53,0x88,0xb8,0x87,0xa8,
+	0x36,0xac,0xa3,0x14,0x1b,0x88,0xdf,0x33,0x2b,0x11,0x16,0x03,0x07,0x03,0x52,0x6b,
+	0xf3,0xb5,0x0a,0xb3,0x78,0x71,0x4e,0x8b,0x17,0xe3,0x71,0xbe,0x37,0x94,0x32,0x62,
+	0x40,0x02,0x91,0x35,0xbb,0xea,0x34,0x89,0x10,0x09,0xcc,0x4c,0xbb,0x69,0x78,0xaa,
+	0x5e,0x30,0x65,0x60,0x12,0x03,0x81,0x28,0xf5,0x21,0x4a,0x5f,0xac,0xc9,0xe1,0xc1,
+	0x39,0x46,0xfe,0xf0,0xe0,0x08,0x1f,0x57,0xff,0xc5,0xdf,0x6b,0xfa,0xbd,0xbc,0x3a,
+	0xc6,0xc7,0xa7,0x83,0x53,0xa2,0xf8,0x78,0x73,0x4a,0x14,0x07,0x47,0xa7,0x17,0xd6,
+	0xed,0x46,0xf0,0x04,0xb4,0xa1,0x95,0x9c,0x2b,0x1c,0x5c,0xde,0xb6,0xed,0x39,0xa9,
+	0xcf,0xa7,0x8b,0x19,0x1b,0x8d,0x90,0x7e,0x97,0x75,0xb6,0xfa,0x61,0x33,0x2a,0x97,
+	0x47,0xc7,0x1f,0x6e,0x3e,0x16,0x21,0x11,0x95,0x90,0x88,0x8d,0x90,0x60,0x92,0x16,
+	0x59,0x01,0x23,0x38,0x3e,0xa1,0x95,0x82,0xf3,0x33,0x82,0xc6,0x21,0xc3,0x72,0x84,
+	0x8d,0x5b,0xbf,0xf2,0x4c,0x82,0xe5,0x3d,0x46,0xc9,0xe5,0x2c,0xf5,0x90,0x44,0x4d,
+	0xb3,0xd1,0x4d,0xaa,0xa2,0x39,0xcf,0x17,0x17,0x34,0xc2,0x35,0x26,0x2d,0x2d,0x11,
+	0x9a,0x9f,0x0d,0x89,0x58,0x09,0xe0,0x4e,0x0d,0x94,0xe8,0xa8,0x5f,0xf1,0xb8,0xb6,
+	0x6e,0xe1,0x4d,0x85,0xb8,0x2f,0xf4,0x0d,0xd1,0x68,0x57,0xeb,0x64,0x31,0x03,0xcf,
+	0xf1,0x5c,0xbf,0x71,0x5b,0xa6,0x3a,0xb9,0xb8,0x5c,0x53,0xe9,0x81,0xe7,0x84,0x49,
+	0x5a,0xa5,0x9a,0x8c,0xd9,0x5a,0xa5,0x4d,0x62,0xd0,0xa3,0x07,0x37,0xd7,0x17,0xe8,
+	0x53,0xcf,0x91,0x01,0xd9,0x6d,0x99,0x0c,0xd1,0x38,0xdd,0xc2,0xbc,0x69,0x15,0x69,
+	0x63,0xc0,0x1b,0xe6,0xf6,0xac,0x46,0x55,0xbe,0x69,0xb7,0xb4,0x70,0xd0,0x5e,0x15,
+	0x0e,0x37,0x0b,0x14,0x6e,0x6b,0x37,0x01,0x20,0x7e,0xc5,0x71,0x63,0xad,0x6d,0x7c,
+	0x75,0xfc,0x9f,0x2d,0xfa,0xcc,0xf4,0x56,0x8d,0x47,0x94,0x1f,0x31,0x5f,0x92,0x56,
+	0xcf,0xd1,0xf9,0x52,0xd9,0x03,0x65,0xc3,0x16,0xb1,0xf9,0xbc,0x91,0xbb,0x45,0x6c,
+	0xea,0x2a,0xc5,0x33,0x01,0x34,0xa9,0x5f,0x59,0xfe,0xfc,0xf9,0x33,0xbb,0xd2,0x90,
+	0xbe,0xf6,0xfa,0xd5,0xf1,0xf8,0x8a,0x6c,0xc8,0xc1,0xbe,0xc2,0x72,0x8d,0x39,0x71,
+	0x98,0x64,0x19,0x37,0x35,0xb0,0x98,0x70,0xaf,0x41,0xf4,0xea,0xfe,0x88,0xc7,0x00,
+	0xff,0x1b,0x56,0x9f,0x1d,0xfc,0xb6,0xd5,0x6a,0x3d,0xbf,0xcd,0xea,0x75,0xa3,0x4f,
+	0xb8,0xbd,0x89,0x59,0x74,0x8c,0xfd,0xae,0x8f,0x55,0x30,0x90,0x2b,0x2a,0x91,0xa3,
+	0x84,0x3d,0x24,0x0b,0x40,0x3a,0x68,0x41,0x1e,0xd8,0xca,0x15,0x0a,0xcf,0x6d,0x5a,
+	0x67,0xb2,0x10,0xf8,0x9e,0x0a,0xe8,0xea,0x78,0x72,0x7c,0xbd,0x2e,0x9e,0x8a,0xf2,
+	0x0f,0x49,0xa2,0x24,0xed,0x67,0x8a,0x6f,0xb4,0x9b,0x6f,0x9a,0x80,0x64,0x65,0x0b,
+	0xaa,0xaa,0x49,0xc8,0x0b,0x5a,0x09,0xac,0x10,0x95,0x26,0x50,0x49,0x62,0x11,0xc3,
+	0xb9,0x7b,0x82,0xf0,0x04,0xd5,0x73,0x0e,0xcf,0xc7,0x4a,0xf7,0x83,0x58,0x86,0x8e,
+	0x91,0xb6,0x24,0xc8,0x41,0x1e,0xd9,0xd7,0xa8,0x16,0x16,0x95,0x78,0x08,0x57,0x35,
+	0x88,0x35,0x01,0xd9,0xdd,0x4c,0x6e,0x2b,0x44,0x73,0x9d,0x92,0xec,0x08,0xae,0x2d,
+	0x71,0x24,0xee,0x80,0x18,0x4e,0x25,0x39,0xfb,0x9f,0x0f,0x13,0xb7,0x5b,0x49,0x6f,
+	0x52,0x24,0x64,0xd7,0x89,0x72,0xe3,0x82,0x5c,0xa9,0xf8,0x9b,0xd4,0x17,0xbf,0x14,
+	0xa4,0xc9,0x1d,0xee,0x96,0x1a,0x0e,0x09,0xc5,0xa9,0x31,0x13,0xdf,0x9c,0x20,0xc9,
+	0x8e,0xa1,0x77,0x7b,0x0e,0xaa,0xb0,0xa9,0xbd,0x02,0x5f,0xc6,0x04,0xa4,0x11,0xfc,
+	0xbc,0x25,0xac,0x64,0x99,0xb7,0xf4,0x41,0x3a,0x98,0x8b,0xc7,0x21,0xa2,0x5f,0x2e,
+	0xdd,0xcf,0x92,0x14,0x3c,0x54,0xe2,0x3e,0x8b,0x96,0x1c,0x7a,0x1b,0xee,0x33,0x5a,
+	0x23,0xa3,0xe8,0xed,0xd6,0x00,0x25,0xb5,0xcb,0x1b,0xc0,0x16,0x3e,0x3f,0x49,0xf0,
+	0x1e,0x69,0xc7,0x64,0x3b,0x86,0x29,0x7e,0xe6,0x7c,0xac,0x0d,0xf4,0x3c,0x5e,0x05,
+	0xf1,0x79,0xe4,0x2a,0x97,0x4e,0x19,0xac,0x2e,0x6b,0x0c,0x40,0x81,0x4f,0x82,0x1d,
+	0x2b,0xbd,0x9a,0x4c,0x4e,0x8b,0xf0,0x80,0xa8,0x78,0x8b,0x2b,0xe6,0xda,0x51,0xeb,
+	0xbd,0x08,0xbe,0x62,0x20,0x95,0xdb,0x73,0x47,0xcd,0xa5,0x62,0x3f,0x30,0xbc,0x86,
+	0x41,0x73,0x96,0x9c,0x25,0xf8,0x1d,0xc4,0x74,0x4a,0xd0,0x43,0x62,0x13,0x35,0x77,
+	0xb0,0xf3,0xc2,0x86,0xe4,0xfc,0x0b,0xbc,0x83,0x55,0xb7,0x38,0xd0,0xaf,0xd4,0xa7,
+	0x58,0x05,0xa5,0x0f,0xb6,0xe6,0x53,0xa0,0x72,0x47,0xcf,0x7a,0x61,0x41,0x80,0x38,
+	0x57,0x0c,0x20,0x84,0xf9,0x6b,0x9a,0xc1,0xad,0xa5,0x41,0xae,0x7c,0x32,0xfe,0xc4,
+	0xbb,0xc5,0xdf,0xbb,0x93,0x2e,0xcc,0xc6,0x9f,0x55,0x3f,0x1e,0xf1,0xe5,0x81,0xef,
+	0x53,0x12,0x9f,0xc3,0x06,0xfe,0xce,0x4b,0xd8,0x76,0xc0,0x0e,0x85,0x13,0xf9,0xb7,
+	0x58,0x48,0xb4,0xeb,0x7e,0x29,0x03,0xd0,0x50,0x5c,0x35,0x36,0x6b,0x82,0x46,0x91,
+	0x3a,0x60,0x31,0x5d,0x75,0xb6,0x9a,0x8c,0xf7,0x01,0x73,0xc7,0x81,0xca,0x86,0xd2,
+	0x0a,0x00,0x5f,0x7a,0x74,0x3d,0x80,0x24,0xe7,0x2c,0xe5,0x19,0x93,0x2b,0xce,0xd3,
+	0x26,0x35,0xb2,0x10,0x20,0x0e,0x71,0xc1,0xb6,0x36,0x49,0x1d,0x76,0x0d,0x53,0xf8,
+	0xdd,0x64,0x91,0xb1,0x48,0xa2,0x2c,0xa4,0x71,0xe1,0xd8,0xc5,0xef,0x12,0x98,0x01,
+	0x2c,0x09,0x68,0x6e,0x1a,0x41,0xda,0x4f,0xf1,0x12,0xec,0x2a,0xc0,0xca,0xd7,0x6d,
+	0xe6,0x7f,0x98,0x6b,0x14,0xf1,0x69,0xea,0x0d,0xcd,0x38,0xec,0x73,0x04,0x7d,0xf9,
+	0x42,0xe5,0xb2,0xe2,0x22,0xb7,0x69,0xe4,0x82,0x6e,0xb2,0x06,0xd4,0x41,0xbb,0x1f,
+	0xc7,0xdc,0x77,0x08,0x61,0xc6,0x06,0x61,0x2a,0x88,0x82,0x37,0xe6,0xaf,0xcf,0x6e,
+	0x2a,0xf9,0x95,0x8e,0xee,0x2a,0x5f,0x5f,0xbc,0x0a,0xfc,0x93,0xab,0x08,0x7a,0x70,
+	0xa3,0x35,0xf3,0xa7,0x73,0x3b,0x34,0x95,0x6e,0x78,0x5b,0x29,0x7e,0x15,0x3c,0x85,
+	0x4b,0x50,0xe8,0xc8,0xc5,0x54,0xaa,0xcc,0xee,0x42,0x86,0x47,0x4d,0xd6,0x85,0xc8,
+	0x75,0xde,0x34,0xaa,0x7d,0x67,0x2e,0xd8,0xe0,0xe1,0xd8,0xe0,0x21,0xd6,0x33,0xcc,
+	0x6e,0x04,0x53,0x3a,0xd4,0x5f,0x4a,0x87,0x9a,0x1d,0x74,0x37,0xf4,0xee,0xb8,0x41,
+	0x49,0x89,0xfd,0xa5,0x7d,0xcb,0xf6,0x59,0x87,0xbf,0xa1,0xd5,0x56,0x79,0x05,0x59,
+	0x5a,0xac,0x53,0x5e,0xff,0x74,0xf2,0x67,0xd1,0xba,0x15,0xa8,0x06,0xf2,0x77,0x77,
+	0xd9,0xab,0x55,0x24,0x00,0x46,0x1d,0x40,0xc1,0xd2,0x48,0xaa,0x39,0x38,0xa9,0x34,
+	0x40,0x8b,0xb8,0x3a,0x45,0xa8,0x5e,0xba,0x71,0xc9,0x97,0xe8,0x0e,0xbc,0xe7,0x56,
+	0x43,0x81,0x90,0x85,0x51,0x45,0x0f,0x80,0x37,0xb0,0xe4,0x8d,0xde,0x57,0xb9,0xe2,
+	0x8a,0xa6,0x47,0xe8,0x3f,0xb9,0x9b,0x15,0xf2,0xcb,0x8b,0xfd,0x0d,0x3b,0xda,0xe8,
+	0xd5,0x8a,0x5f,0x51,0x93,0xed,0x17,0x37,0xc4,0x57,0x63,0xc4,0x85,0x57,0x63,0x54,
+	0x04,0x2f,0xbe,0x43,0x04,0x92,0x0d,0x87,0x6c,0x9c,0xbf,0xd3,0xbc,0x60,0xaf,0x70,
+	0x0a,0xca,0x51,0x07,0x14,0x4c,0x2c,0x08,0x86,0x05,0x9f,0x41,0x4d,0x0f,0xa6,0x20,
+	0x54,0xab,0x00,0x21,0xe8,0x1e,0x06,0x1e,0x7e,0x00,0x38,0xc4,0x2f,0xbe,0xf7,0xb0,
+	0xfd,0xae,0x8f,0xf3,0x2b,0x9a,0xa7,0xef,0x2d,0xe0,0x7e,0xd0,0x00,0x1d,0x0c,0x99,
+	0x5c,0xdb,0xb9,0x07,0x08,0x77,0x57,0xa7,0x73,0x28,0x24,0xdb,0xa3,0x0b,0x40,0x07,
+	0x7d,0x02,0xe8,0xc0,0x6c,0x94,0x1f,0xe9,0xad,0x45,0x6c,0x80,0x7c,0xf0,0xb2,0xb7,
+	0xa7,0xc1,0x14,0x17,0x97,0xb0,0xf8,0xc9,0x55,0x21,0xb4,0xf3,0xf7,0x36,0xb0,0xea,
+	0x77,0xe8,0x9d,0xa1,0x1b,0xb1,0x31,0x33,0x7d,0xc7,0x5d,0xce,0x28,0x3b,0xf7,0x18,
+	0x14,0x63,0x03,0xb4,0xbf,0x6d,0x37,0x50,0x01,0x28,0x0e,0xa2,0x38,0x9e,0xe0,0xa7,
+	0x20,0xec,0xa8,0x43,0x19,0x53,0x23,0x48,0x22,0xe8,0x43,0xa9,0xdd,0xfd,0xb1,0x0d,
+	0x19,0x83,0xbf,0x3f,0xe0,0x87,0x00,0xc8,0x98,0x26,0xa0,0xf4,0xf7,0xcd,0x9f,0xda,
+	0xdf,0x37,0xac,0xb5,0x88,0x2b,0x88,0xad,0x4d,0x6c,0x41,0x9c,0x24,0x19,0x9c,0x6e,
+	0x3f,0xb0,0x55,0x83,0xb6,0x42,0xb3,0x1e,0x8f,0x20,0x72,0x0d,0xb3,0x31,0x0a,0x85,
+	0x36,0x0d,0x8c,0x26,0xd3,0x46,0xac,0x34,0x4e,0xe1,0xfe,0x8e,0xbe,0x89,0xf4,0x59,
+	0xb8,0xbd,0x0a,0xfc,0x4a,0xfa,0x6b,0xa0,0x40,0xe3,0x8b,0x98,0xa2,0xad,0x00,0x69,
+	0xee,0x9d,0x9e,0x2e,0x8b,0x27,0x46,0x04,0x25,0x40,0x23,0x5c,0x1c,0xeb,0xf2,0x48,
+	0x37,0x0b,0x23,0x47,0xcd,0xe2,0xd4,0xd5,0x60,0x09,0x9d,0x2d,0xb4,0x45,0x88,0x96,
+	0x41,0x86,0x87,0x92,0x2b,0x7c,0x40,0x46,0x6a,0x56,0x98,0xcf,0x63,0xe5,0x4a,0x24,
+	0xc9,0x1e,0x80,0x65,0x05,0xb5,0xe1,0x25,0xc2,0x97,0x0e,0xca,0xf9,0x0c,0x20,0x52,
+	0xf9,0xba,0x10,0x02,0xa9,0x48,0x40,0x0c,0xe7,0x4c,0xc6,0x89,0x62,0x2b,0xd0,0x83,
+	0x9f,0xf7,0xf0,0x5b,0x35,0x42,0x26,0xe2,0x1e,0x9c,0x82,0xce,0x3a,0xa5,0x11,0x25,
+	0xed,0xe2,0xa0,0xe1,0x98,0x8e,0x78,0x92,0x1e,0xa3,0x4d,0x13,0x00,0x67,0x8f,0x9b,
+	0x82,0x23,0x2b,0x25,0x9d,0x34,0x5c,0x3a,0xae,0xef,0x13,0xc9,0x19,0x9c,0x67,0x1c,
+	0xbc,0x68,0x5b,0xd9,0xbd,0x55,0xfe,0xe0,0xc0,0xd7,0x29,0x35,0x07,0x99,0xff,0x9e,
+	0x5c,0x9c,0x3b,0x04,0x62,0x36,0xa7,0x03,0x95,0x02,0x77,0xe2,0x2c,0x84,0x0c,0xa3,
+	0x40,0xc1,0x71,0x8e,0xe3,0xa2,0x95,0x38,0x71,0x24,0x74,0x93,0x1c,0x13,0xb0,0x6b,
+	0x92,0x0b,0x83,0x3c,0xc1,0x72,0x9e,0xe0,0x15,0x06,0x9e,0x78,0xd4,0xb2,0xd1,0x90,
+	0xbd,0x2d,0x06,0x83,0x21,0xeb,0x74,0xb1,0xc4,0x91,0xe4,0x0b,0x4d,0xb5,0xd8,0xdb,
+	0xdb,0xbd,0xbd,0x7e,0xa9,0x45,0x9c,0x10,0x56,0xea,0x03,0x79,0xeb,0x46,0x28,0x39,
+	0x36,0xb7,0x62,0x4a,0xff,0xf9,0x36,0xf2,0x93,0x72,0xbb,0x28,0xd0,0xf8,0x92,0x57,
+	0xfc,0x17,0xbd,0x42,0xc8,0x32,0x29,0x41,0xc5,0xce,0xc4,0x74,0x8a,0x78,0x6c,0xfb,
+	0xe6,0xbd,0xcf,0x26,0x79,0xab,0xb9,0x9e,0x86,0x41,0x3e,0x8f,0x1d,0xeb,0x7a,0x01,
+	0x47,0xb8,0x42,0xcd,0x1d,0xa5,0x3b,0xbd,0xe5,0x4e,0x2f,0x5c,0xb3,0x76,0x0c,0x64,
+	0x66,0x96,0x25,0x59,0xe5,0xeb,0xa4,0xb6,0x1e,0xed,0x03,0x02,0xb8,0x4e,0xf8,0x0f,
+	0xc8,0xc8,0x11,0xef,0xba,0x65,0x50,0x2f,0x63,0xfa,0x73,0x48,0x37,0x97,0xa7,0x66,
+	0x4e,0x11,0xc1,0x64,0xde,0xae,0xa1,0x01,0xf0,0x7f,0x7d,0x54,0x0c,0x21,0x27,0x37,
+	0xbe,0x30,0x69,0x76,0x6d,0xcc,0xfa,0x40,0xd0,0x5f,0x11,0xad,0x2d,0x1f,0xbd,0xd6,
+	0x9f,0x3a,0x70,0xbb,0x65,0xa5,0x08,0xa1,0x91,0x31,0x2b,0xf7,0x7c,0x71,0xb9,0xab,
+	0x9e,0x59,0x0d,0x53,0x29,0x45,0x80,0x2a,0x74,0x25,0xb2,0xc7,0xf5,0xc0,0xf1,0xe2,
+	0x44,0x22,0x0f,0x2b,0xef,0x87,0x4e,0x95,0x6f,0x08,0xf9,0xd6,0x31,0x55,0x39,0xa5,
+	0x4a,0x87,0x94,0x8e,0x5a,0xe9,0x74,0xa4,0xb6,0xbd,0xb9,0x4e,0xfb,0xea,0xb2,0xf9,
+	0xc2,0x6d,0x08,0xb0,0xe2,0x74,0x0b,0xb2,0xa6,0xd0,0x5d,0x5f,0x73,0xdd,0x8d,0x02,
+	0xc1,0xf6,0xc3,0x77,0xdd,0xc3,0x14,0x81,0xe9,0xe3,0x5f,0xba,0xcc,0x27,0x6e,0xb8,
+	0xd4,0xe9,0xbf,0x71,0xed,0xeb,0x3f,0x76,0xfe,0x1f,0x6e,0x3f,0xef,0x76,0x04,0x1d,
+	0x00,0x00,
+};
+
+#endif // WWWINDEX_H
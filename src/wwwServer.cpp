@@ -31,7 +31,6 @@
 // Author: Bernd Giesecke (https://github.com/beegee-tokyo)
 //
 // Port is work in progress
-// CAD and HOP is not supported for SX1262 chips
 // Downlink is not working
 // Compiles under PlatformIO only
 // ********************************************************************************
@@ -44,13 +43,17 @@
 // Care must be taken that not all data is output to the webserver in one string
 // as this will use a LOT of memory and possibly kill the heap (cause system
 // crash or other unreliable behaviour.
-// Instead, output of the various tables on the webpage should be displayed in
-// chunks so that strings are limited in size.
 // Be aware that using no strings but only sendContent() calls has its own
 // disadvantage that these calls take a lot of time and cause the page to be
 // displayed like an old typewriter.
-// So, the trick is to make chucks that are sent to the website by using
-// a response String but not make those Strings too big.
+// So, all pages are written through a small renderer (wwwOut) instead. The
+// fixed HTML fragments are copied from flash (F() strings) and numbers are
+// formatted directly into one fixed buffer of WWW_CHUNK bytes. Every time the
+// buffer is full it is handed to the webserver as one chunk. No String objects
+// are made while rendering. The webserver queues at most HTTP_MAX_OUT bytes per
+// connection in a few reused segments and pauses the page while the client
+// reads, so a page never sits in RAM as a whole. The render time, size and
+// heap used of the last page are shown in the System Status table.
 //
 // Also, selecting too many options for Statistics, display, Hopping channels
 // etc makes the gateway more sluggish and may impact the available memory and
@@ -58,11 +61,10 @@
 //
 
 #include "defines.h"
-
-void wifiConfig();
-void systemStatus();
-void interruptData();
-void websiteFooter();
+#if A_SERVER == 1
+#include "wwwIndex.h" // Generated by tools/wwwGzip.py
+#include <lwip/sockets.h>
+#endif
 
 // --------------------------------------------------------------------------------
 // PRINT IP
@@ -89,7 +91,168 @@ void printIP(IPAddress ipa, const char sep, String &response)
 // WEBSERVER DECLARATIONS
 // ================================================================================
 
-// None at the moment
+// Size of the render buffer. Every full buffer is sent as one HTTP chunk.
+#define WWW_CHUNK 512
+
+struct wwwOut
+{
+	char buf[WWW_CHUNK]; // Chunk being built
+	uint16_t len;		 // Number of bytes in buf
+	uint16_t chunks;	 // Number of chunks sent for this page
+	uint32_t bytes;		 // Number of bytes sent for this page
+};
+
+// Render statistics of the last page, shown in the System Status table
+struct wwwRender
+{
+	uint32_t us;	   // Render time in microseconds
+	uint32_t bytes;	// Page size
+	uint16_t chunks;   // Number of chunks
+	uint32_t heapLow;  // Lowest free heap seen while rendering
+	uint32_t heapPre;  // Free heap before rendering
+} wwwLast;
+
+static void wifiConfig(wwwOut &o);
+static void systemStatus(wwwOut &o);
+static void interruptData(wwwOut &o);
+static void websiteFooter(wwwOut &o);
+
+// Fixed script fragments, also sent stand alone by the /DOCU handler
+static const char ynScript[] PROGMEM =
+	"<script>"
+	"var ch = \"\"; "
+	"function ynDialog(s,y) {"
+	"  try { adddlert(s); }"
+	"  catch(err) {"
+	"    ch  = \" \" + s + \".\\n\\n\"; "
+	"    ch += \"Click OK to continue,\\n\"; "
+	"    ch += \"or Cancel\\n\\n\"; "
+	"    if(!confirm(ch)) { "
+	"      javascript:window.location.reload(true);"
+	"    } "
+	"    else { "
+	"      document.location.href = '/'+y; "
+	"    } "
+	"  }"
+	"}"
+	"</script>";
+
+static const char docuScript[] PROGMEM =
+	"<script>"
+	"var txt = \"\";"
+	"function showDocu() {"
+	"  try { adddlert(\"Welcome,\"); }"
+	"  catch(err) {"
+	"    txt  = \"Do you want the documentation page.\\n\\n\"; "
+	"    txt += \"Click OK to continue viewing documentation,\\n\"; "
+	"    txt += \"or Cancel to return to the home page.\\n\\n\"; "
+	"    if(confirm(txt)) { "
+	"      document.location.href = \"https://things4u.github.io/UserGuide/One%20Channel%20Gateway/Introduction%205.html\"; "
+	"    }"
+	"  }"
+	"}"
+	"</script>";
+
+// ================================================================================
+// RENDERER FUNCTIONS
+// ================================================================================
+
+// --------------------------------------------------------------------------------
+// Send the render buffer to the client as one chunk.
+// An empty buffer is never sent as an empty chunk ends the page.
+// --------------------------------------------------------------------------------
+static void wFlush(wwwOut &o)
+{
+	if (o.len == 0)
+		return;
+	server.sendContent_P(o.buf, o.len);
+	o.bytes += o.len;
+	o.chunks++;
+	o.len = 0;
+
+	uint32_t heap = ESP.getFreeHeap();
+	if (heap < wwwLast.heapLow)
+		wwwLast.heapLow = heap;
+}
+
+// --------------------------------------------------------------------------------
+// Append len bytes to the render buffer, flushing when it fills up.
+// The source may be in flash, so copy with memcpy_P.
+// --------------------------------------------------------------------------------
+static void wPut(wwwOut &o, PGM_P s, size_t len)
+{
+	while (len > 0)
+	{
+		size_t n = WWW_CHUNK - o.len;
+		if (n > len)
+			n = len;
+		memcpy_P(&o.buf[o.len], s, n);
+		o.len += n;
+		s += n;
+		len -= n;
+		if (o.len == WWW_CHUNK)
+			wFlush(o);
+	}
+}
+
+// Strings in RAM
+static void wStr(wwwOut &o, const char *s)
+{
+	wPut(o, s, strlen(s));
+}
+
+// Template fragments in flash, use with F("...")
+static void wStr(wwwOut &o, const __FlashStringHelper *s)
+{
+	wPut(o, (PGM_P)s, strlen_P((PGM_P)s));
+}
+
+static void wChr(wwwOut &o, char c)
+{
+	o.buf[o.len++] = c;
+	if (o.len == WWW_CHUNK)
+		wFlush(o);
+}
+
+// Signed and unsigned decimal numbers
+static void wNum(wwwOut &o, long v)
+{
+	char tmp[12];
+	wPut(o, tmp, snprintf(tmp, sizeof(tmp), "%ld", v));
+}
+
+static void wUns(wwwOut &o, unsigned long v)
+{
+	char tmp[12];
+	wPut(o, tmp, snprintf(tmp, sizeof(tmp), "%lu", v));
+}
+
+// Two digit lowercase hex value
+static void wHex2(wwwOut &o, uint8_t v)
+{
+	char tmp[3];
+	wPut(o, tmp, snprintf(tmp, sizeof(tmp), "%02x", v));
+}
+
+// Date and time as "Weekday d-m-yyyy hh:mm:ss"
+static void wTime(wwwOut &o, time_t t)
+{
+	char tmp[32];
+	stringTime(t, tmp, sizeof(tmp));
+	wStr(o, tmp);
+}
+
+static void wIP(wwwOut &o, IPAddress ipa)
+{
+	char tmp[16];
+	wPut(o, tmp, snprintf(tmp, sizeof(tmp), "%u.%u.%u.%u", ipa[0], ipa[1], ipa[2], ipa[3]));
+}
+
+// "LightGreen" or "orange" background for ON/OFF settings
+static void wOnOff(wwwOut &o, bool on)
+{
+	wStr(o, on ? F("LightGreen") : F("orange"));
+}
 
 // ================================================================================
 // WEBSERVER FUNCTIONS
@@ -107,34 +270,12 @@ void printIP(IPAddress ipa, const char sep, String &response)
 //	o: The OK tab for the webpage where to go to
 //	c: The Cancel string (optional)
 // --------------------------------------------------------------------------------
-boolean YesNo()
-{
-	boolean ret = false;
-	String response = "";
-	response += "<script>";
-
-	response += "var ch = \"\"; "; // Init choice
-	response += "function ynDialog(s,y) {";
-	response += "  try { adddlert(s); }";
-	response += "  catch(err) {";
-	response += "    ch  = \" \" + s + \".\\n\\n\"; ";
-	response += "    ch += \"Click OK to continue,\\n\"; ";
-	response += "    ch += \"or Cancel\\n\\n\"; ";
-	response += "    if(!confirm(ch)) { ";
-	response += "      javascript:window.location.reload(true);";
-	response += "    } ";
-	response += "    else { ";
-	response += "      document.location.href = '/'+y; ";
-	response += "    } ";
-	response += "  }";
-	response += "}";
-	response += "</script>";
-	server.sendContent(response);
+static void YesNo(wwwOut &o)
+{
+	wStr(o, FPSTR(ynScript));
 
 	// Put something like this in the ESP program
-	//	response += "<input type=\"button\" value=\"YesNo\" onclick=\"ynDialog()\" />";
-
-	return (ret);
+	//	<input type=\"button\" value=\"YesNo\" onclick=\"ynDialog()\" />
 }
 
 // --------------------------------------------------------------------------------
@@ -192,25 +333,7 @@ void wwwFile(String fn)
 // --------------------------------------------------------------------------------
 void buttonDocu()
 {
-
-	String response = "";
-	response += "<script>";
-
-	response += "var txt = \"\";";
-	response += "function showDocu() {";
-	response += "  try { adddlert(\"Welcome,\"); }";
-	response += "  catch(err) {";
-	response += "    txt  = \"Do you want the documentation page.\\n\\n\"; ";
-	response += "    txt += \"Click OK to continue viewing documentation,\\n\"; ";
-	response += "    txt += \"or Cancel to return to the home page.\\n\\n\"; ";
-	response += "    if(confirm(txt)) { ";
-	response += "      document.location.href = \"https://things4u.github.io/UserGuide/One%20Channel%20Gateway/Introduction%205.html\"; ";
-	response += "    }";
-	response += "  }";
-	response += "}";
-
-	response += "</script>";
-	server.sendContent(response);
+	server.sendContent_P(docuScript);
 }
 
 // --------------------------------------------------------------------------------
@@ -219,8 +342,6 @@ void buttonDocu()
 // --------------------------------------------------------------------------------
 void buttonLog()
 {
-
-	String response = "";
 	String fn = "";
 	int i = 0;
 
@@ -230,8 +351,6 @@ void buttonLog()
 		wwwFile(fn); // Display the file contents in the browser
 		i++;
 	}
-
-	server.sendContent(response);
 }
 
 // --------------------------------------------------------------------------------
@@ -239,20 +358,117 @@ void buttonLog()
 // - Less time/cpu usage
 // - Less memory usage		<a href=\"SPEED=160\">
 // --------------------------------------------------------------------------------
-static void wwwButtons()
+static void wwwButtons(wwwOut &o)
 {
-	String response = "";
-	String mode = (gwayConfig.expert ? "Basic Mode" : "Expert Mode");
+	YesNo(o); // Init the Yes/No function
+	wStr(o, FPSTR(docuScript));
 
-	YesNo(); // Init the Yes/No function
-	buttonDocu();
+	wStr(o, F("<input type=\"button\" value=\"Documentation\" onclick=\"showDocu()\" >"));
+
+	wStr(o, F("<a href=\"EXPERT\" download><button type=\"button\">"));
+	wStr(o, gwayConfig.expert ? F("Basic Mode") : F("Expert Mode"));
+	wStr(o, F("</button></a>"));
+	wStr(o, F("<a href=\"LOG\" download><button type=\"button\">Log Files</button></a>"));
+}
+
+// --------------------------------------------------------------------------------
+// RESET STATS
+// Reset all package statistics, used by /RESET and POST /api/reset
+// --------------------------------------------------------------------------------
+static void resetStats()
+{
+	Serial.println(F("RESET"));
+	startTime = now() - 1; // Reset all timers too
+
+	statc.msg_ttl = 0; // Reset package statistics
+	statc.msg_ok = 0;
+	statc.msg_down = 0;
+#if _DEDUP >= 1
+	statc.msg_dup = 0;
+#endif
+#if _TRUSTED_NODES >= 2
+	statc.drop_list = 0;
+#endif
+#if _RATE_LIMIT >= 1
+	statc.drop_rate = 0;
+	statc.rate_sampled = 0;
+#endif
+#if _CHECK_MIC == 1
+	statc.drop_short = 0;
+	statc.drop_netid = 0;
+	statc.drop_mic = 0;
+#endif
+#ifdef CFG_sx1262_radio
+	memset(cadStats, 0, sizeof(cadStats));
+	memset(hopStats, 0, sizeof(hopStats));
+#endif
 
-	response += "<input type=\"button\" value=\"Documentation\" onclick=\"showDocu()\" >";
+#if STATISTICS >= 3
+	statc.msg_ttl_0 = 0;
+	statc.msg_ttl_1 = 0;
+	statc.msg_ttl_2 = 0;
+	statc.msg_ok_0 = 0;
+	statc.msg_ok_1 = 0;
+	statc.msg_ok_2 = 0;
+	statc.msg_down_0 = 0;
+	statc.msg_down_1 = 0;
+	statc.msg_down_2 = 0;
+#endif
 
-	response += "<a href=\"EXPERT\" download><button type=\"button\">" + mode + "</button></a>";
-	response += "<a href=\"LOG\" download><button type=\"button\">Log Files</button></a>";
+#if STATISTICS >= 1
+	for (int i = 0; i < MAX_STAT; i++)
+	{
+		statr[i].sf = 0;
+	}
+#if STATISTICS >= 2
+	statc.sf7 = 0;
+	statc.sf8 = 0;
+	statc.sf9 = 0;
+	statc.sf10 = 0;
+	statc.sf11 = 0;
+	statc.sf12 = 0;
+
+	statc.resets = 0;
+	writeGwayCfg(CONFIGFILE);
+#if STATISTICS >= 3
+	statc.sf7_0 = 0;
+	statc.sf7_1 = 0;
+	statc.sf7_2 = 0;
+	statc.sf8_0 = 0;
+	statc.sf8_1 = 0;
+	statc.sf8_2 = 0;
+	statc.sf9_0 = 0;
+	statc.sf9_1 = 0;
+	statc.sf9_2 = 0;
+	statc.sf10_0 = 0;
+	statc.sf10_1 = 0;
+	statc.sf10_2 = 0;
+	statc.sf11_0 = 0;
+	statc.sf11_1 = 0;
+	statc.sf11_2 = 0;
+	statc.sf12_0 = 0;
+	statc.sf12_1 = 0;
+	statc.sf12_2 = 0;
+#endif
+#endif
+#endif
+	statCompact(); // Store the cleared statistics
+}
 
-	server.sendContent(response); // Send to the screen
+// --------------------------------------------------------------------------------
+// Restart reception after a radio setting changed. A running CAD or hop scan
+// is restarted as such, otherwise the radio goes back to RX.
+// --------------------------------------------------------------------------------
+static void wwwRestartRx()
+{
+#ifdef CFG_sx1262_radio
+	if ((_cad) || (_hop))
+	{
+		cadScanner();
+		return;
+	}
+#endif
+	rxLoraModem();
 }
 
 // --------------------------------------------------------------------------------
@@ -290,12 +506,37 @@ static void setVariables(const char *cmd, const char *arg)
 	if (strcmp(cmd, "CAD") == 0)
 	{ // Set -cad on=1 or off=0
 		_cad = (bool)atoi(arg);
+#ifdef CFG_sx1262_radio
+		if (_cad)
+		{
+			cadScanner();
+		}
+		else
+		{
+			rxLoraModem();
+		}
+#endif
 		writeGwayCfg(CONFIGFILE); // Save configuration to file
 	}
 
 	if (strcmp(cmd, "HOP") == 0)
 	{ // Set -hop on=1 or off=0
 		_hop = (bool)atoi(arg);
+#ifdef CFG_sx1262_radio
+		if (!_hop)
+		{
+			ifreq = 0;
+		}
+		setFreq(freqs[ifreq].upFreq);
+		if ((_cad) || (_hop))
+		{
+			cadScanner();
+		}
+		else
+		{
+			rxLoraModem();
+		}
+#else
 		if (!_hop)
 		{
 			ifreq = 0;
@@ -304,6 +545,7 @@ static void setVariables(const char *cmd, const char *arg)
 			sf = SF7;
 			cadScanner();
 		}
+#endif
 		writeGwayCfg(CONFIGFILE); // Save configuration to file
 	}
 
@@ -330,7 +572,7 @@ static void setVariables(const char *cmd, const char *arg)
 			else
 				sf = (sf_t)((int)sf - 1);
 		}
-		rxLoraModem();			  // Reset the radio with the new spreading factor
+		wwwRestartRx();			  // Reset the radio with the new spreading factor
 		writeGwayCfg(CONFIGFILE); // Save configuration to file
 	}
 
@@ -356,7 +598,7 @@ static void setVariables(const char *cmd, const char *arg)
 				ifreq--;
 		}
 		setFreq(freqs[ifreq].upFreq);
-		rxLoraModem();			  // Reset the radio with the new frequency
+		wwwRestartRx();			  // Reset the radio with the new frequency
 		writeGwayCfg(CONFIGFILE); // Save configuration to file
 	}
 
@@ -364,6 +606,25 @@ static void setVariables(const char *cmd, const char *arg)
 
 	//if (strcmp(cmd, "SETTIME")==0) { Serial.println(F("settime tbd")); }	// Set the local time
 
+	// PDEBUG; toggle one bit of the debug pattern by name
+	if (strcmp(cmd, "PDEBUG") == 0)
+	{
+		static const char *pnames[] = {"SCAN", "CAD", "RX", "TX", "PRE", "MAIN", "GUI", "RADIO"};
+		for (int i = 0; i < 8; i++)
+		{
+			if (strcmp(arg, pnames[i]) == 0)
+			{
+				pdebug ^= (1 << i); // P_SCAN is bit 0 ... P_RADIO is bit 7
+			}
+		}
+		writeGwayCfg(CONFIGFILE); // Save configuration to file
+	}
+
+	if (strcmp(cmd, "EXPERT") == 0)
+	{
+		gwayConfig.expert = (bool)atoi(arg);
+	}
+
 	if (strcmp(cmd, "HELP") == 0)
 	{
 		Serial.println(F("Display Help Topics"));
@@ -419,13 +680,12 @@ static void setVariables(const char *cmd, const char *arg)
 //	This is the init function for opening the webpage
 //
 // --------------------------------------------------------------------------------
-static void openWebPage()
+static void openWebPage(wwwOut &o)
 {
 	++gwayConfig.views; // increment number of views
 #if A_REFRESH == 1
 	//server.client().stop();							// Experimental, stop webserver in case something is still running!
 #endif
-	String response = "";
 
 	server.sendHeader("Cache-Control", "no-cache, no-store, must-revalidate");
 	server.sendHeader("Pragma", "no-cache");
@@ -439,56 +699,82 @@ static void openWebPage()
 #if A_REFRESH == 1
 	if (gwayConfig.refresh)
 	{
-		response += String() + "<!DOCTYPE HTML><HTML><HEAD><meta http-equiv='refresh' content='" + _WWW_INTERVAL + ";http://";
-		printIP((IPAddress)WiFi.localIP(), '.', response);
-		response += "'><TITLE>ESP32 1ch Gateway</TITLE>";
+		// Reload when the live feed reports a frame, but not more often than
+		// every _WWW_INTERVAL seconds. Without a feed fall back to a timed reload.
+		wStr(o, F("<!DOCTYPE HTML><HTML><HEAD><TITLE>ESP32 1ch Gateway</TITLE><script>"
+				  "var t0=Date.now(),t=0,w="));
+		wNum(o, _WWW_INTERVAL * 1000);
+		wStr(o, F(";function r(){if(!t)t=setTimeout(function(){location.reload();},Math.max(1000,w-(Date.now()-t0)));}"
+				  "var es=new EventSource('/api/events');"
+				  "es.addEventListener('rx',r);es.addEventListener('tx',r);"
+				  "es.onerror=function(){if(es.readyState==2)r();};</script>"));
 	}
 	else
 	{
-		response += String() + "<!DOCTYPE HTML><HTML><HEAD><TITLE>ESP8266 1ch Gateway</TITLE>";
+		wStr(o, F("<!DOCTYPE HTML><HTML><HEAD><TITLE>ESP8266 1ch Gateway</TITLE>"));
 	}
 #else
-	response += String() + "<!DOCTYPE HTML><HTML><HEAD><TITLE>ESP8266 1ch Gateway</TITLE>";
+	wStr(o, F("<!DOCTYPE HTML><HTML><HEAD><TITLE>ESP8266 1ch Gateway</TITLE>"));
 #endif
-	response += "<META HTTP-EQUIV='CONTENT-TYPE' CONTENT='text/html; charset=UTF-8'>";
-	response += "<META NAME='AUTHOR' CONTENT='M. Westenberg (mw1554@hotmail.com)'>";
-
-	response += "<style>.thead {background-color:green; color:white;} ";
-	response += ".cell {border: 1px solid black;}";
-	response += ".config_table {max_width:100%; min-width:400px; width:98%; border:1px solid black; border-collapse:collapse;}";
-	response += "</style></HEAD><BODY>";
+	wStr(o, F("<META HTTP-EQUIV='CONTENT-TYPE' CONTENT='text/html; charset=UTF-8'>"
+			  "<META NAME='AUTHOR' CONTENT='M. Westenberg (mw1554@hotmail.com)'>"
+			  "<style>.thead {background-color:green; color:white;} "
+			  ".cell {border: 1px solid black;}"
+			  ".config_table {max_width:100%; min-width:400px; width:98%; border:1px solid black; border-collapse:collapse;}"
+			  "</style></HEAD><BODY>"
+			  "<h1>ESP Gateway Config</h1>"
+			  "<p style='font-size:10px;'>"
+			  "Version: " VERSION
+			  "<br>ESP alive since ")); // STARTED ON
+	wTime(o, startTime);
+
+	wStr(o, F(", Uptime: ")); // UPTIME
+	char tmp[24];
+	uint32_t secs = millis() / 1000;
+	snprintf(tmp, sizeof(tmp), "%u-%02u:%02u:%02u", (unsigned)(secs / 86400),
+			 (unsigned)hour(secs), (unsigned)minute(secs), (unsigned)second(secs));
+	wStr(o, tmp);
 
-	response += "<h1>ESP Gateway Config</h1>";
+	wStr(o, F("<br>Current time    ")); // CURRENT TIME
+	wTime(o, now());
+	wStr(o, F("<br></p>"));
+}
 
-	response += "<p style='font-size:10px;'>";
-	response += "Version: ";
-	response += VERSION;
-	response += "<br>ESP alive since "; // STARTED ON
-	stringTime(startTime, response);
+// --------------------------------------------------------------------------------
+// One table row with an ON/OFF value and two buttons to change it
+// Parameters:
+//	label; Name of the setting in the first column
+//	on; Current value
+//	cmd; Command for the buttons, "=1" and "=0" are added
+// --------------------------------------------------------------------------------
+static void wOnOffRow(wwwOut &o, const __FlashStringHelper *label, bool on, const __FlashStringHelper *cmd)
+{
+	wStr(o, F("<tr><td class=\"cell\">"));
+	wStr(o, label);
+	wStr(o, F("</td><td colspan=\"2\" style=\"border: 1px solid black; background-color: "));
+	wOnOff(o, on);
+	wStr(o, F("\">"));
+	wStr(o, on ? F("ON") : F("OFF"));
+	wStr(o, F("</td><td style=\"border: 1px solid black; width:40px;\"><a href=\""));
+	wStr(o, cmd);
+	wStr(o, F("=1\"><button>ON</button></a></td>"
+			  "<td style=\"border: 1px solid black; width:40px;\"><a href=\""));
+	wStr(o, cmd);
+	wStr(o, F("=0\"><button>OFF</button></a></td></tr>"));
+}
 
-	response += ", Uptime: "; // UPTIME
-	uint32_t secs = millis() / 1000;
-	uint16_t days = secs / 86400; // Determine number of days
-	uint8_t _hour = hour(secs);
-	uint8_t _minute = minute(secs);
-	uint8_t _second = second(secs);
-	response += String() + days + "-";
-	if (_hour < 10)
-		response += "0";
-	response += String() + _hour + ":";
-	if (_minute < 10)
-		response += "0";
-	response += String() + _minute + ":";
-	if (_second < 10)
-		response += "0";
-	response += String() + _second;
-
-	response += "<br>Current time    "; // CURRENT TIME
-	stringTime(now(), response);
-	response += "<br>";
-	response += "</p>";
-
-	server.sendContent(response);
+// --------------------------------------------------------------------------------
+// One toggle button of the debug pattern
+// --------------------------------------------------------------------------------
+static void wPdebug(wwwOut &o, uint8_t bit, const __FlashStringHelper *cmd, const __FlashStringHelper *label)
+{
+	wStr(o, F("<td class=\"cell\" style=\"border: 1px solid black; width:20px; background-color: "));
+	wOnOff(o, pdebug & bit);
+	wStr(o, F("\"><a href=\"PDEBUG="));
+	wStr(o, cmd);
+	wStr(o, F("\"><button>"));
+	wStr(o, label);
+	wStr(o, F("</button></a></td>"));
 }
 
 // --------------------------------------------------------------------------------
@@ -498,212 +784,156 @@ static void openWebPage()
 // allowing the user to set CAD, HOP, Debug and several other operating parameters
 //
 // --------------------------------------------------------------------------------
-static void gatewaySettings()
-{
-	String response = "";
-	String bg = "";
-
-	response += "<h2>Gateway Settings</h2>";
-
-	response += "<table class=\"config_table\">";
-	response += "<tr>";
-	response += "<th class=\"thead\">Setting</th>";
-	response += "<th colspan=\"2\" style=\"background-color: green; color: white; width:120px;\">Value</th>";
-	response += "<th colspan=\"4\" style=\"background-color: green; color: white; width:100px;\">Set</th>";
-	response += "</tr>";
-
-	bg = " background-color: ";
-	bg += (_cad ? "LightGreen" : "orange");
-	response += "<tr><td class=\"cell\">CAD</td>";
-	response += "<td colspan=\"2\" style=\"border: 1px solid black;";
-	response += bg;
-	response += "\">";
-	response += (_cad ? "ON" : "OFF");
-	response += "<td style=\"border: 1px solid black; width:40px;\"><a href=\"CAD=1\"><button>ON</button></a></td>";
-	response += "<td style=\"border: 1px solid black; width:40px;\"><a href=\"CAD=0\"><button>OFF</button></a></td>";
-	response += "</tr>";
-
-	bg = " background-color: ";
-	bg += (_hop ? "LightGreen" : "orange");
-	response += "<tr><td class=\"cell\">HOP</td>";
-	response += "<td colspan=\"2\" style=\"border: 1px solid black;";
-	response += bg;
-	response += "\">";
-	response += (_hop ? "ON" : "OFF");
-	response += "<td style=\"border: 1px solid black; width:40px;\"><a href=\"HOP=1\"><button>ON</button></a></td>";
-	response += "<td style=\"border: 1px solid black; width:40px;\"><a href=\"HOP=0\"><button>OFF</button></a></td>";
-	response += "</tr>";
-
-	response += "<tr><td class=\"cell\">SF Setting</td><td class=\"cell\" colspan=\"2\">";
+static void gatewaySettings(wwwOut &o)
+{
+	wStr(o, F("<h2>Gateway Settings</h2>"
+			  "<table class=\"config_table\">"
+			  "<tr>"
+			  "<th class=\"thead\">Setting</th>"
+			  "<th colspan=\"2\" style=\"background-color: green; color: white; width:120px;\">Value</th>"
+			  "<th colspan=\"4\" style=\"background-color: green; color: white; width:100px;\">Set</th>"
+			  "</tr>"));
+
+	wOnOffRow(o, F("CAD"), _cad, F("CAD"));
+	wOnOffRow(o, F("HOP"), _hop, F("HOP"));
+#ifdef CFG_sx1262_radio
+	wOnOffRow(o, F("SNIFF"), _sniff, F("SNIFF"));
+#endif
+
+	wStr(o, F("<tr><td class=\"cell\">SF Setting</td><td class=\"cell\" colspan=\"2\">"));
 	if (_cad)
 	{
-		response += "AUTO</td>";
+		wStr(o, F("AUTO</td>"));
 	}
 	else
 	{
-		response += sf;
-		response += "<td class=\"cell\"><a href=\"SF=-1\"><button>-</button></a></td>";
-		response += "<td class=\"cell\"><a href=\"SF=1\"><button>+</button></a></td>";
+		wNum(o, sf);
+		wStr(o, F("</td><td class=\"cell\"><a href=\"SF=-1\"><button>-</button></a></td>"
+				  "<td class=\"cell\"><a href=\"SF=1\"><button>+</button></a></td>"));
 	}
-	response += "</tr>";
+	wStr(o, F("</tr>"));
 
 	// Channel
-	response += "<tr><td class=\"cell\">Channel</td>";
-	response += "<td class=\"cell\" colspan=\"2\">";
+	wStr(o, F("<tr><td class=\"cell\">Channel</td><td class=\"cell\" colspan=\"2\">"));
 	if (_hop)
 	{
-		response += "AUTO</td>";
+		wStr(o, F("AUTO</td>"));
 	}
 	else
 	{
-		response += String() + ifreq;
-		response += "</td>";
-		response += "<td class=\"cell\"><a href=\"FREQ=-1\"><button>-</button></a></td>";
-		response += "<td class=\"cell\"><a href=\"FREQ=1\"><button>+</button></a></td>";
+		wNum(o, ifreq);
+		wStr(o, F("</td><td class=\"cell\"><a href=\"FREQ=-1\"><button>-</button></a></td>"
+				  "<td class=\"cell\"><a href=\"FREQ=1\"><button>+</button></a></td>"));
 	}
-	response += "</tr>";
+	wStr(o, F("</tr>"));
 
 	// Debugging options, only when DUSB is set, otherwise no
 	// serial activity
 #if DUSB >= 1
-	response += "<tr><td class=\"cell\">Debug level</td><td class=\"cell\" colspan=\"2\">";
-	response += debug;
-	response += "</td>";
-	response += "<td class=\"cell\"><a href=\"DEBUG=-1\"><button>-</button></a></td>";
-	response += "<td class=\"cell\"><a href=\"DEBUG=1\"><button>+</button></a></td>";
-	response += "</tr>";
-
-	response += "<tr><td class=\"cell\">Debug pattern</td>";
-
-	bg = ((pdebug & P_SCAN) ? "LightGreen" : "orange");
-	response += "<td class=\"cell\" style=\"border: 1px solid black; width:20px; background-color: ";
-	response += bg;
-	response += "\">";
-	response += "<a href=\"PDEBUG=SCAN\">";
-	response += "<button>SCN</button></a></td>";
-
-	bg = ((pdebug & P_CAD) ? "LightGreen" : "orange");
-	response += "<td class=\"cell\" style=\"border: 1px solid black; width:20px; background-color: ";
-	response += bg;
-	response += "\">";
-	response += "<a href=\"PDEBUG=CAD\">";
-	response += "<button>CAD</button></a></td>";
-
-	bg = ((pdebug & P_RX) ? "LightGreen" : "orange");
-	response += "<td class=\"cell\" style=\"border: 1px solid black; width:20px; background-color: ";
-	response += bg;
-	response += "\">";
-	response += "<a href=\"PDEBUG=RX\">";
-	response += "<button>RX</button></a></td>";
-
-	bg = ((pdebug & P_TX) ? "LightGreen" : "orange");
-	response += "<td class=\"cell\" style=\"border: 1px solid black; width:20px; background-color: ";
-	response += bg;
-	response += "\">";
-	response += "<a href=\"PDEBUG=TX\">";
-	response += "<button>TX</button></a></td>";
-	response += "</tr>";
+	wStr(o, F("<tr><td class=\"cell\">Debug level</td><td class=\"cell\" colspan=\"2\">"));
+	wNum(o, debug);
+	wStr(o, F("</td><td class=\"cell\"><a href=\"DEBUG=-1\"><button>-</button></a></td>"
+			  "<td class=\"cell\"><a href=\"DEBUG=1\"><button>+</button></a></td></tr>"));
+
+	wStr(o, F("<tr><td class=\"cell\">Debug pattern</td>"));
+	wPdebug(o, P_SCAN, F("SCAN"), F("SCN"));
+	wPdebug(o, P_CAD, F("CAD"), F("CAD"));
+	wPdebug(o, P_RX, F("RX"), F("RX"));
+	wPdebug(o, P_TX, F("TX"), F("TX"));
+	wStr(o, F("</tr>"));
 
 	// Use a second Line
-	response += "<tr><td class=\"cell\"></td>";
-	bg = ((pdebug & P_PRE) ? "LightGreen" : "orange");
-	response += "<td class=\"cell\" style=\"border: 1px solid black; width:20px; background-color: ";
-	response += bg;
-	response += "\">";
-	response += "<a href=\"PDEBUG=PRE\">";
-	response += "<button>PRE</button></a></td>";
-
-	bg = ((pdebug & P_MAIN) ? "LightGreen" : "orange");
-	response += "<td class=\"cell\" style=\"border: 1px solid black; width:20px; background-color: ";
-	response += bg;
-	response += "\">";
-	response += "<a href=\"PDEBUG=MAIN\">";
-	response += "<button>MAI</button></a></td>";
-
-	bg = ((pdebug & P_GUI) ? "LightGreen" : "orange");
-	response += "<td class=\"cell\" style=\"border: 1px solid black; width:20px; background-color: ";
-	response += bg;
-	response += "\">";
-	response += "<a href=\"PDEBUG=GUI\">";
-	response += "<button>GUI</button></a></td>";
-
-	bg = ((pdebug & P_RADIO) ? "LightGreen" : "orange");
-	response += "<td class=\"cell\" style=\"border: 1px solid black; width:20px; background-color: ";
-	response += bg;
-	response += "\">";
-	response += "<a href=\"PDEBUG=RADIO\">";
-	response += "<button>RDIO</button></a></td>";
-	response += "</tr>";
+	wStr(o, F("<tr><td class=\"cell\"></td>"));
+	wPdebug(o, P_PRE, F("PRE"), F("PRE"));
+	wPdebug(o, P_MAIN, F("MAIN"), F("MAI"));
+	wPdebug(o, P_GUI, F("GUI"), F("GUI"));
+	wPdebug(o, P_RADIO, F("RADIO"), F("RDIO"));
+	wStr(o, F("</tr>"));
 #endif
 	// Serial Debugging
-	response += "<tr><td class=\"cell\">Usb Debug</td><td class=\"cell\" colspan=\"2\">";
-	response += DUSB;
-	response += "</td>";
-	//response +="<td class=\"cell\"> </td>";
-	//response +="<td class=\"cell\"> </td>";
-	response += "</tr>";
+	wStr(o, F("<tr><td class=\"cell\">Usb Debug</td><td class=\"cell\" colspan=\"2\">"));
+	wNum(o, DUSB);
+	wStr(o, F("</td></tr>"));
 
 #if GATEWAYNODE == 1
-	response += "<tr><td class=\"cell\">Framecounter Internal Sensor</td>";
-	response += "<td class=\"cell\" colspan=\"2\">";
-	response += frameCount;
-	response += "</td><td colspan=\"2\" style=\"border: 1px solid black;\">";
-	response += "<button><a href=\"/FCNT\">RESET</a></button></td>";
-	response += "</tr>";
-
-	bg = " background-color: ";
-	bg += ((gwayConfig.isNode == 1) ? "LightGreen" : "orange");
-	response += "<tr><td class=\"cell\">Gateway Node</td>";
-	response += "<td class=\"cell\" style=\"border: 1px solid black;" + bg + "\">";
-	response += ((gwayConfig.isNode == true) ? "ON" : "OFF");
-	response += "<td style=\"border: 1px solid black; width:40px;\"><a href=\"NODE=1\"><button>ON</button></a></td>";
-	response += "<td style=\"border: 1px solid black; width:40px;\"><a href=\"NODE=0\"><button>OFF</button></a></td>";
-	response += "</tr>";
+	wStr(o, F("<tr><td class=\"cell\">Framecounter Internal Sensor</td><td class=\"cell\" colspan=\"2\">"));
+	wUns(o, frameCount);
+	wStr(o, F("</td><td colspan=\"2\" style=\"border: 1px solid black;\">"
+			  "<button><a href=\"/FCNT\">RESET</a></button></td></tr>"));
+
+	wOnOffRow(o, F("Gateway Node"), gwayConfig.isNode, F("NODE"));
 #endif
 
 #if A_REFRESH == 1
-	bg = " background-color: ";
-	bg += ((gwayConfig.refresh == 1) ? "LightGreen" : "orange");
-	response += "<tr><td class=\"cell\">WWW Refresh</td>";
-	response += "<td class=\"cell\" colspan=\"2\" style=\"border: 1px solid black; " + bg + "\">";
-	response += ((gwayConfig.refresh == 1) ? "ON" : "OFF");
-	response += "<td style=\"border: 1px solid black; width:40px;\"><a href=\"REFR=1\"><button>ON</button></a></td>";
-	response += "<td style=\"border: 1px solid black; width:40px;\"><a href=\"REFR=0\"><button>OFF</button></a></td>";
-	response += "</tr>";
+	wOnOffRow(o, F("WWW Refresh"), gwayConfig.refresh, F("REFR"));
 #endif
 
 	// Reset Accesspoint
 #if WIFIMANAGER == 1
-	response += "<tr><td><tr><td>";
-	response += "Click <a href=\"/NEWSSID\">here</a> to reset accesspoint<br>";
-	response += "</td><td></td></tr>";
+	wStr(o, F("<tr><td><tr><td>"
+			  "Click <a href=\"/NEWSSID\">here</a> to reset accesspoint<br>"
+			  "</td><td></td></tr>"));
 #endif
 
 	// Update Firmware all statistics
-	response += "<tr><td class=\"cell\">Update Firmware</td><td colspan=\"2\"></td>";
-	response += "<td class=\"cell\" colspan=\"2\" class=\"cell\"><a href=\"/UPDATE=1\"><button>UPDATE</button></a></td></tr>";
+	wStr(o, F("<tr><td class=\"cell\">Update Firmware</td><td colspan=\"2\"></td>"
+			  "<td class=\"cell\" colspan=\"2\" class=\"cell\"><a href=\"/UPDATE=1\"><button>UPDATE</button></a></td></tr>"));
 
 	// Format the Filesystem
-	response += "<tr><td class=\"cell\">Format SPIFFS</td>";
-	response += String() + "<td class=\"cell\" colspan=\"2\" >" + "" + "</td>";
-	response += "<td colspan=\"2\" class=\"cell\"><input type=\"button\" value=\"FORMAT\" onclick=\"ynDialog(\'Do you really want to format?\',\'FORMAT\')\" /></td></tr>";
+	wStr(o, F("<tr><td class=\"cell\">Format SPIFFS</td>"
+			  "<td class=\"cell\" colspan=\"2\" ></td>"
+			  "<td colspan=\"2\" class=\"cell\"><input type=\"button\" value=\"FORMAT\" onclick=\"ynDialog(\'Do you really want to format?\',\'FORMAT\')\" /></td></tr>"));
 
 	// Reset all statistics
 #if STATISTICS >= 2
-	response += "<tr><td class=\"cell\">Statistics</td>";
-	response += String() + "<td class=\"cell\" colspan=\"2\" >" + statc.resets + "</td>";
-	response += "<td colspan=\"2\" class=\"cell\"><input type=\"button\" value=\"RESET\" onclick=\"ynDialog(\'Do you really want to reset statistics?\',\'RESET\')\" /></td></tr>";
+	wStr(o, F("<tr><td class=\"cell\">Statistics</td><td class=\"cell\" colspan=\"2\" >"));
+	wUns(o, statc.resets);
+	wStr(o, F("</td><td colspan=\"2\" class=\"cell\"><input type=\"button\" value=\"RESET\" onclick=\"ynDialog(\'Do you really want to reset statistics?\',\'RESET\')\" /></td></tr>"));
 
 	// Reset
-	response += "<tr><td class=\"cell\">Boots and Resets</td>";
-	response += String() + "<td class=\"cell\" colspan=\"2\" >" + gwayConfig.boots + "</td>";
-	response += "<td colspan=\"2\" class=\"cell\"><input type=\"button\" value=\"RESET\" onclick=\"ynDialog(\'Do you want to reset boots?\',\'BOOT\')\" /></td></tr>";
+	wStr(o, F("<tr><td class=\"cell\">Boots and Resets</td><td class=\"cell\" colspan=\"2\" >"));
+	wUns(o, gwayConfig.boots);
+	wStr(o, F("</td><td colspan=\"2\" class=\"cell\"><input type=\"button\" value=\"RESET\" onclick=\"ynDialog(\'Do you want to reset boots?\',\'BOOT\')\" /></td></tr>"));
 #endif
 
-	response += "</table>";
+	wStr(o, F("</table>"));
+}
+
+// --------------------------------------------------------------------------------
+// One cell with a counter value
+// --------------------------------------------------------------------------------
+static void wCell(wwwOut &o, unsigned long v)
+{
+	wStr(o, F("<td class=\"cell\">"));
+	wUns(o, v);
+	wStr(o, F("</td>"));
+}
 
-	server.sendContent(response);
+#if STATISTICS >= 2
+// --------------------------------------------------------------------------------
+// One row of the SF table: label, (per channel counts), total and percentage
+// --------------------------------------------------------------------------------
+static void wSfRow(wwwOut &o, const __FlashStringHelper *label, unsigned long v
+#if STATISTICS == 3
+				   ,
+				   unsigned long v0, unsigned long v1, unsigned long v2
+#endif
+)
+{
+	wStr(o, F("<tr><td class=\"cell\">"));
+	wStr(o, label);
+	wStr(o, F("</td>"));
+#if STATISTICS == 3
+	wCell(o, v0);
+	wCell(o, v1);
+	wCell(o, v2);
+#endif
+	wCell(o, v);
+	wStr(o, F("<td class=\"cell\">"));
+	wUns(o, statc.msg_ttl > 0 ? 100 * v / statc.msg_ttl : 0);
+	wStr(o, F(" %</td></tr>"));
 }
+#endif
 
 // --------------------------------------------------------------------------------
 // H2 Package Statistics
@@ -711,174 +941,117 @@ static void gatewaySettings()
 // This section display a matrix on the screen where everay channel and spreading
 // factor is displayed.
 // --------------------------------------------------------------------------------
-static void statisticsData()
+static void statisticsData(wwwOut &o)
 {
-	String response = "";
-
 	// Header
-	response += "<h2>Package Statistics</h2>";
-	response += "<table class=\"config_table\">";
-	response += "<tr><th class=\"thead\">Counter</th>";
+	wStr(o, F("<h2>Package Statistics</h2>"
+			  "<table class=\"config_table\">"
+			  "<tr><th class=\"thead\">Counter</th>"));
 #if STATISTICS == 3
-	response += "<th class=\"thead\">C 0</th>";
-	response += "<th class=\"thead\">C 1</th>";
-	response += "<th class=\"thead\">C 2</th>";
+	wStr(o, F("<th class=\"thead\">C 0</th>"
+			  "<th class=\"thead\">C 1</th>"
+			  "<th class=\"thead\">C 2</th>"));
 #endif
-	response += "<th class=\"thead\">Pkgs</th>";
-	response += "<th class=\"thead\">Pkgs/hr</th>";
-	response += "</tr>";
+	wStr(o, F("<th class=\"thead\">Pkgs</th>"
+			  "<th class=\"thead\">Pkgs/hr</th>"
+			  "</tr>"));
 
 	//
 	// Table rows
 	//
-	response += "<tr><td class=\"cell\">Packages Downlink</td>";
+	wStr(o, F("<tr><td class=\"cell\">Packages Downlink</td>"));
+#if STATISTICS == 3
+	wCell(o, statc.msg_down_0);
+	wCell(o, statc.msg_down_1);
+	wCell(o, statc.msg_down_2);
+#endif
+	wCell(o, statc.msg_down);
+	wStr(o, F("<td class=\"cell\"></td></tr>"));
+
+	wStr(o, F("<tr><td class=\"cell\">Packages Uplink Total</td>"));
+#if STATISTICS == 3
+	wCell(o, statc.msg_ttl_0);
+	wCell(o, statc.msg_ttl_1);
+	wCell(o, statc.msg_ttl_2);
+#endif
+	wCell(o, statc.msg_ttl);
+	uint32_t upSecs = now() - startTime;
+	wCell(o, upSecs > 0 ? (statc.msg_ttl * 3600) / upSecs : 0);
+	wStr(o, F("</tr>"));
+
+	wStr(o, F("<tr><td class=\"cell\">Packages Uplink OK </td>"));
+#if STATISTICS == 3
+	wCell(o, statc.msg_ok_0);
+	wCell(o, statc.msg_ok_1);
+	wCell(o, statc.msg_ok_2);
+#endif
+	wCell(o, statc.msg_ok);
+	wStr(o, F("<td class=\"cell\"></td></tr>"));
+
+#if _TRUSTED_NODES >= 2
+	wStr(o, F("<tr><td class=\"cell\">Dropped by node lists</td>"));
+#if STATISTICS == 3
+	wStr(o, F("<td class=\"cell\"></td><td class=\"cell\"></td><td class=\"cell\"></td>"));
+#endif
+	wCell(o, statc.drop_list);
+	wStr(o, F("<td class=\"cell\"></td></tr>"));
+#endif
+
+#if _RATE_LIMIT >= 1
+	wStr(o, F("<tr><td class=\"cell\">Over rate dropped / sampled</td>"));
 #if STATISTICS == 3
-	response += "<td class=\"cell\">" + String(statc.msg_down_0) + "</td>";
-	response += "<td class=\"cell\">" + String(statc.msg_down_1) + "</td>";
-	response += "<td class=\"cell\">" + String(statc.msg_down_2) + "</td>";
+	wStr(o, F("<td class=\"cell\"></td><td class=\"cell\"></td><td class=\"cell\"></td>"));
+#endif
+	wStr(o, F("<td class=\"cell\">"));
+	wUns(o, statc.drop_rate);
+	wStr(o, F(" / "));
+	wUns(o, statc.rate_sampled);
+	wStr(o, F("</td><td class=\"cell\"></td></tr>"));
 #endif
-	response += "<td class=\"cell\">" + String(statc.msg_down) + "</td>";
-	response += "<td class=\"cell\"></td></tr>";
 
-	response += "<tr><td class=\"cell\">Packages Uplink Total</td>";
+#if _DEDUP >= 1
+	wStr(o, F("<tr><td class=\"cell\">Duplicates</td>"));
 #if STATISTICS == 3
-	response += "<td class=\"cell\">" + String(statc.msg_ttl_0) + "</td>";
-	response += "<td class=\"cell\">" + String(statc.msg_ttl_1) + "</td>";
-	response += "<td class=\"cell\">" + String(statc.msg_ttl_2) + "</td>";
+	wStr(o, F("<td class=\"cell\"></td><td class=\"cell\"></td><td class=\"cell\"></td>"));
+#endif
+	wCell(o, statc.msg_dup);
+	wStr(o, F("<td class=\"cell\"></td></tr>"));
 #endif
-	response += "<td class=\"cell\">" + String(statc.msg_ttl) + "</td>";
-	response += "<td class=\"cell\">" + String((statc.msg_ttl * 3600) / (now() - startTime)) + "</td></tr>";
 
-	response += "<tr><td class=\"cell\">Packages Uplink OK </td>";
+#if _CHECK_MIC == 1
+	// Frames that rxFilter() did not forward, no per channel numbers
+	wStr(o, F("<tr><td class=\"cell\">Dropped short / NetID / MIC</td>"));
 #if STATISTICS == 3
-	response += "<td class=\"cell\">" + String(statc.msg_ok_0) + "</td>";
-	response += "<td class=\"cell\">" + String(statc.msg_ok_1) + "</td>";
-	response += "<td class=\"cell\">" + String(statc.msg_ok_2) + "</td>";
+	wStr(o, F("<td class=\"cell\"></td><td class=\"cell\"></td><td class=\"cell\"></td>"));
+#endif
+	wStr(o, F("<td class=\"cell\">"));
+	wUns(o, statc.drop_short);
+	wStr(o, F(" / "));
+	wUns(o, statc.drop_netid);
+	wStr(o, F(" / "));
+	wUns(o, statc.drop_mic);
+	wStr(o, F("</td><td class=\"cell\"></td></tr>"));
 #endif
-	response += "<td class=\"cell\">" + String(statc.msg_ok) + "</td>";
-	response += "<td class=\"cell\"></td></tr>";
 
 	// Provide a table with all the SF data including percentage of messsages
 #if STATISTICS == 2
-	response += "<tr><td class=\"cell\">SF7 rcvd</td>";
-	response += "<td class=\"cell\">";
-	response += statc.sf7;
-	response += "<td class=\"cell\">";
-	response += String(statc.msg_ttl > 0 ? 100 * statc.sf7 / statc.msg_ttl : 0) + " %";
-	response += "</td></tr>";
-	response += "<tr><td class=\"cell\">SF8 rcvd</td>";
-	response += "<td class=\"cell\">";
-	response += statc.sf8;
-	response += "<td class=\"cell\">";
-	response += String(statc.msg_ttl > 0 ? 100 * statc.sf8 / statc.msg_ttl : 0) + " %";
-	response += "</td></tr>";
-	response += "<tr><td class=\"cell\">SF9 rcvd</td>";
-	response += "<td class=\"cell\">";
-	response += statc.sf9;
-	response += "<td class=\"cell\">";
-	response += String(statc.msg_ttl > 0 ? 100 * statc.sf9 / statc.msg_ttl : 0) + " %";
-	response += "</td></tr>";
-	response += "<tr><td class=\"cell\">SF10 rcvd</td>";
-	response += "<td class=\"cell\">";
-	response += statc.sf10;
-	response += "<td class=\"cell\">";
-	response += String(statc.msg_ttl > 0 ? 100 * statc.sf10 / statc.msg_ttl : 0) + " %";
-	response += "</td></tr>";
-	response += "<tr><td class=\"cell\">SF11 rcvd</td>";
-	response += "<td class=\"cell\">";
-	response += statc.sf11;
-	response += "<td class=\"cell\">";
-	response += String(statc.msg_ttl > 0 ? 100 * statc.sf11 / statc.msg_ttl : 0) + " %";
-	response += "</td></tr>";
-	response += "<tr><td class=\"cell\">SF12 rcvd</td>";
-	response += "<td class=\"cell\">";
-	response += statc.sf12;
-	response += "<td class=\"cell\">";
-	response += String(statc.msg_ttl > 0 ? 100 * statc.sf12 / statc.msg_ttl : 0) + " %";
-	response += "</td></tr>";
+	wSfRow(o, F("SF7 rcvd"), statc.sf7);
+	wSfRow(o, F("SF8 rcvd"), statc.sf8);
+	wSfRow(o, F("SF9 rcvd"), statc.sf9);
+	wSfRow(o, F("SF10 rcvd"), statc.sf10);
+	wSfRow(o, F("SF11 rcvd"), statc.sf11);
+	wSfRow(o, F("SF12 rcvd"), statc.sf12);
 #endif
 #if STATISTICS == 3
-	response += "<tr><td class=\"cell\">SF7 rcvd</td>";
-	response += "<td class=\"cell\">";
-	response += statc.sf7_0;
-	response += "<td class=\"cell\">";
-	response += statc.sf7_1;
-	response += "<td class=\"cell\">";
-	response += statc.sf7_2;
-	response += "<td class=\"cell\">";
-	response += statc.sf7;
-	response += "<td class=\"cell\">";
-	response += String(statc.msg_ttl > 0 ? 100 * statc.sf7 / statc.msg_ttl : 0) + " %";
-	response += "</td></tr>";
-
-	response += "<tr><td class=\"cell\">SF8 rcvd</td>";
-	response += "<td class=\"cell\">";
-	response += statc.sf8_0;
-	response += "<td class=\"cell\">";
-	response += statc.sf8_1;
-	response += "<td class=\"cell\">";
-	response += statc.sf8_2;
-	response += "<td class=\"cell\">";
-	response += statc.sf8;
-	response += "<td class=\"cell\">";
-	response += String(statc.msg_ttl > 0 ? 100 * statc.sf8 / statc.msg_ttl : 0) + " %";
-	response += "</td></tr>";
-
-	response += "<tr><td class=\"cell\">SF9 rcvd</td>";
-	response += "<td class=\"cell\">";
-	response += statc.sf9_0;
-	response += "<td class=\"cell\">";
-	response += statc.sf9_1;
-	response += "<td class=\"cell\">";
-	response += statc.sf9_2;
-	response += "<td class=\"cell\">";
-	response += statc.sf9;
-	response += "<td class=\"cell\">";
-	response += String(statc.msg_ttl > 0 ? 100 * statc.sf9 / statc.msg_ttl : 0) + " %";
-	response += "</td></tr>";
-
-	response += "<tr><td class=\"cell\">SF10 rcvd</td>";
-	response += "<td class=\"cell\">";
-	response += statc.sf10_0;
-	response += "<td class=\"cell\">";
-	response += statc.sf10_1;
-	response += "<td class=\"cell\">";
-	response += statc.sf10_2;
-	response += "<td class=\"cell\">";
-	response += statc.sf10;
-	response += "<td class=\"cell\">";
-	response += String(statc.msg_ttl > 0 ? 100 * statc.sf10 / statc.msg_ttl : 0) + " %";
-	response += "</td></tr>";
-
-	response += "<tr><td class=\"cell\">SF11 rcvd</td>";
-	response += "<td class=\"cell\">";
-	response += statc.sf11_0;
-	response += "<td class=\"cell\">";
-	response += statc.sf11_1;
-	response += "<td class=\"cell\">";
-	response += statc.sf11_2;
-	response += "<td class=\"cell\">";
-	response += statc.sf11;
-	response += "<td class=\"cell\">";
-	response += String(statc.msg_ttl > 0 ? 100 * statc.sf11 / statc.msg_ttl : 0) + " %";
-	response += "</td></tr>";
-
-	response += "<tr><td class=\"cell\">SF12 rcvd</td>";
-	response += "<td class=\"cell\">";
-	response += statc.sf12_0;
-	response += "<td class=\"cell\">";
-	response += statc.sf12_1;
-	response += "<td class=\"cell\">";
-	response += statc.sf12_1;
-	response += "<td class=\"cell\">";
-	response += statc.sf12;
-	response += "<td class=\"cell\">";
-	response += String(statc.msg_ttl > 0 ? 100 * statc.sf12 / statc.msg_ttl : 0) + " %";
-	response += "</td></tr>";
-#endif
-
-	response += "</table>";
-	server.sendContent(response);
+	wSfRow(o, F("SF7 rcvd"), statc.sf7, statc.sf7_0, statc.sf7_1, statc.sf7_2);
+	wSfRow(o, F("SF8 rcvd"), statc.sf8, statc.sf8_0, statc.sf8_1, statc.sf8_2);
+	wSfRow(o, F("SF9 rcvd"), statc.sf9, statc.sf9_0, statc.sf9_1, statc.sf9_2);
+	wSfRow(o, F("SF10 rcvd"), statc.sf10, statc.sf10_0, statc.sf10_1, statc.sf10_2);
+	wSfRow(o, F("SF11 rcvd"), statc.sf11, statc.sf11_0, statc.sf11_1, statc.sf11_2);
+	wSfRow(o, F("SF12 rcvd"), statc.sf12, statc.sf12_0, statc.sf12_1, statc.sf12_2);
+#endif
+
+	wStr(o, F("</table>"));
 }
 
 // --------------------------------------------------------------------------------
@@ -895,153 +1068,1237 @@ static void statisticsData()
 // pRSSI, Packet RSSI
 //
 // Parameters:
-//	- <none>
+//	- o; render buffer
 // Returns:
 //	- <none>
 // --------------------------------------------------------------------------------
-static void messageHistory()
+static void messageHistory(wwwOut &o)
 {
 #if STATISTICS >= 1
-	String response = "";
+	char tmp[40];
 
-	response += "<h2>Message History</h2>";
-	response += "<table class=\"config_table\">";
-	response += "<tr>";
-	response += "<th class=\"thead\">Time</th>";
-	response += "<th class=\"thead\">Node</th>";
+	wStr(o, F("<h2>Message History</h2>"
+			  "<table class=\"config_table\">"
+			  "<tr>"
+			  "<th class=\"thead\">Time</th>"
+			  "<th class=\"thead\">Node</th>"));
 #if _LOCALSERVER == 1
-	response += "<th class=\"thead\">Data</th>";
+	wStr(o, F("<th class=\"thead\">Data</th>"));
 #endif
-	response += "<th class=\"thead\" style=\"width: 20px;\">Ch</th>";
-	response += "<th class=\"thead\">Freq</th>";
-	response += "<th class=\"thead\" style=\"width: 40px;\">SF</th>";
-	response += "<th class=\"thead\" style=\"width: 50px;\">pRSSI</th>";
+	wStr(o, F("<th class=\"thead\" style=\"width: 20px;\">Ch</th>"
+			  "<th class=\"thead\">Freq</th>"
+			  "<th class=\"thead\" style=\"width: 40px;\">SF</th>"
+			  "<th class=\"thead\" style=\"width: 50px;\">pRSSI</th>"));
 #if RSSI == 1
 	if (debug > 1)
 	{
-		response += "<th class=\"thead\" style=\"width: 50px;\">RSSI</th>";
+		wStr(o, F("<th class=\"thead\" style=\"width: 50px;\">RSSI</th>"));
 	}
 #endif
-	response += "</tr>";
-	server.sendContent(response);
+	wStr(o, F("</tr>"));
 
 	for (int i = 0; i < MAX_STAT; i++)
 	{
 		if (statr[i].sf == 0)
 			break;
 
-		response = "";
+		wStr(o, F("<tr><td class=\"cell\">")); // Tmst
+		wTime(o, statr[i].tmst);			   // XXX Change tmst not to be millis() dependent
+		wStr(o, F("</td>"));
 
-		response += String() + "<tr><td class=\"cell\">"; // Tmst
-		stringTime((statr[i].tmst), response);			  // XXX Change tmst not to be millis() dependent
-		response += "</td>";
-
-		response += String() + "<td class=\"cell\">"; // Node
-		if (SerialName((char *)(&(statr[i].node)), response) < 0)
-		{														 // works with TRUSTED_NODES >= 1
-			printHEX((char *)(&(statr[i].node)), ' ', response); // else
+		wStr(o, F("<td class=\"cell\">")); // Node
+		if (SerialName((char *)(&(statr[i].node)), tmp, sizeof(tmp)) < 0)
+		{														  // works with TRUSTED_NODES >= 1
+			printHEX((char *)(&(statr[i].node)), ' ', tmp); // else
 		}
-		response += "</td>";
+		wStr(o, tmp);
+		wStr(o, F("</td>"));
 
 #if _LOCALSERVER == 1
-		response += String() + "<td class=\"cell\">"; // Data
+		wStr(o, F("<td class=\"cell\">")); // Data
 		for (int j = 0; j < statr[i].datal; j++)
 		{
-			if (statr[i].data[j] < 0x10)
-				response += "0";
-			response += String(statr[i].data[j], HEX) + " ";
+			wHex2(o, statr[i].data[j]);
+			wChr(o, ' ');
 		}
-		response += "</td>";
+		wStr(o, F("</td>"));
 #endif
 
-		response += String() + "<td class=\"cell\">" + statr[i].ch + "</td>";
-		response += String() + "<td class=\"cell\">" + freqs[statr[i].ch].upFreq + "</td>";
-		response += String() + "<td class=\"cell\">" + statr[i].sf + "</td>";
+		wCell(o, statr[i].ch);
+		wCell(o, freqs[statr[i].ch].upFreq);
+		wCell(o, statr[i].sf);
 
-		response += String() + "<td class=\"cell\">" + statr[i].prssi + "</td>";
+		wStr(o, F("<td class=\"cell\">"));
+		wNum(o, statr[i].prssi);
+		wStr(o, F("</td>"));
 #if RSSI == 1
 		if (debug >= 2)
 		{
-			response += String() + "<td class=\"cell\">" + statr[i].rssi + "</td>";
+			wStr(o, F("<td class=\"cell\">"));
+			wNum(o, statr[i].rssi);
+			wStr(o, F("</td>"));
 		}
 #endif
-		response += "</tr>";
-		server.sendContent(response);
+		wStr(o, F("</tr>"));
 	}
 
-	server.sendContent("</table>");
+	wStr(o, F("</table>"));
+
+#endif
+}
+
+#if _RATE_LIMIT >= 1
+// --------------------------------------------------------------------------------
+// Top Talkers
+// The devices that sent the most frames since boot, with the frames above
+// their rate and the tokens left in their bucket.
+// --------------------------------------------------------------------------------
+#define WWW_TOP 10
 
+static void topTalkers(wwwOut &o)
+{
+	struct rateNode *top[WWW_TOP];
+	int n = rateTop(top, WWW_TOP);
+
+	wStr(o, F("<h2>Top Talkers</h2>"
+			  "<table class=\"config_table\">"
+			  "<tr><th class=\"thead\">Node</th>"
+			  "<th class=\"thead\">Frames</th>"
+			  "<th class=\"thead\">Over rate</th>"
+			  "<th class=\"thead\">Tokens</th></tr>"));
+	for (int i = 0; i < n; i++)
+	{
+		wStr(o, F("<tr><td class=\"cell\">"));
+		wHex2(o, top[i]->addr >> 24);
+		wHex2(o, top[i]->addr >> 16);
+		wHex2(o, top[i]->addr >> 8);
+		wHex2(o, top[i]->addr);
+		wStr(o, F("</td>"));
+		wCell(o, top[i]->frames);
+		wCell(o, top[i]->excess);
+		wCell(o, top[i]->tokens / 1000);
+		wStr(o, F("</tr>"));
+	}
+	wStr(o, F("</table>"));
+}
 #endif
+
+#ifdef CFG_sx1262_radio
+// --------------------------------------------------------------------------------
+// CAD STATISTICS
+// Scans and detections per SF of the SX1262 CAD scanner, and how many
+// detections ended in a received packet.
+// --------------------------------------------------------------------------------
+static void cadStatistics(wwwOut &o)
+{
+	wStr(o, F("<h2>CAD Scanner</h2>"
+			  "<table class=\"config_table\">"
+			  "<tr><th class=\"thead\">SF</th>"
+			  "<th class=\"thead\">Scans</th>"
+			  "<th class=\"thead\">Detects</th>"
+			  "<th class=\"thead\">Received</th></tr>"));
+	for (int i = 0; i < 6; i++)
+	{
+		wStr(o, F("<tr><td class=\"cell\">SF"));
+		wNum(o, SF7 + i);
+		wStr(o, F("</td>"));
+		wCell(o, cadStats[i].scans);
+		wCell(o, cadStats[i].detects);
+		wCell(o, cadStats[i].rx);
+		wStr(o, F("</tr>"));
+	}
+	wStr(o, F("</table>"));
+}
+
+// --------------------------------------------------------------------------------
+// HOP STATISTICS
+// Time, detections and packets per channel while the SX1262 hops, and the
+// dwell the channel got on its last visit.
+// --------------------------------------------------------------------------------
+static void hopStatistics(wwwOut &o)
+{
+	uint32_t total = 0;
+	for (int i = 0; i < NUM_HOPS; i++)
+	{
+		total += hopStats[i].ms;
+	}
+	wStr(o, F("<h2>Channel Hopping</h2>"
+			  "<table class=\"config_table\">"
+			  "<tr><th class=\"thead\">Channel</th>"
+			  "<th class=\"thead\">Freq</th>"
+			  "<th class=\"thead\">Visits</th>"
+			  "<th class=\"thead\">Time %</th>"
+			  "<th class=\"thead\">Detects</th>"
+			  "<th class=\"thead\">Received</th>"
+			  "<th class=\"thead\">Dwell (ms)</th></tr>"));
+	for (int i = 0; i < NUM_HOPS; i++)
+	{
+		wStr(o, F("<tr><td class=\"cell\">"));
+		wNum(o, i);
+		wStr(o, F("</td>"));
+		wCell(o, freqs[i].upFreq);
+		wCell(o, hopStats[i].visits);
+		if (total > 0)
+		{
+			wCell(o, ((uint64_t)hopStats[i].ms * 100) / total);
+		}
+		else
+		{
+			wCell(o, 0);
+		}
+		wCell(o, hopStats[i].detects);
+		wCell(o, hopStats[i].rx);
+		wCell(o, hopStats[i].dwell);
+		wStr(o, F("</tr>"));
+	}
+	wStr(o, F("</table>"));
 }
+#endif
 
 // --------------------------------------------------------------------------------
 // SEND WEB PAGE()
 // Call the webserver and send the standard content and the content that is
 // passed by the parameter. Each time a variable is changed, this function is
 // called to display the webpage again/
+// All sections write into one render buffer on the stack which is sent in
+// chunks of WWW_CHUNK bytes. Render time, size and the lowest free heap are
+// kept in wwwLast and shown in the System Status table.
 //
 // NOTE: This is the only place where yield() or delay() calls are used.
 //
 // --------------------------------------------------------------------------------
 void sendWebPage(const char *cmd, const char *arg)
 {
-	openWebPage();
+	wwwOut o;
+	o.len = 0;
+	o.chunks = 0;
+	o.bytes = 0;
+
+	uint32_t start = micros();
+	wwwLast.heapPre = ESP.getFreeHeap();
+	wwwLast.heapLow = wwwLast.heapPre;
+
+	openWebPage(o);
 	yield(); // Do the initial website setup
 
-	wwwButtons(); // Display buttons such as Documentation, Mode, Logfiles
+	wwwButtons(o); // Display buttons such as Documentation, Mode, Logfiles
 
 	setVariables(cmd, arg);
 	yield(); // Read Webserver commands from line
 
-	statisticsData();
+	statisticsData(o);
 	yield(); // Node statistics
-	messageHistory();
+	messageHistory(o);
 	yield(); // Display the sensor history, message statistics
+#if _RATE_LIMIT >= 1
+	topTalkers(o);
+	yield(); // Busiest devices
+#endif
+#ifdef CFG_sx1262_radio
+	if (_cad)
+	{
+		cadStatistics(o);
+		yield(); // SF scanner
+	}
+	if (_hop)
+	{
+		hopStatistics(o);
+		yield(); // Channel hopping
+	}
+#endif
 
-	gatewaySettings();
+	gatewaySettings(o);
 	yield(); // Display web configuration
-	wifiConfig();
+	wifiConfig(o);
 	yield(); // WiFi specific parameters
 
-	systemStatus();
+	systemStatus(o);
 	yield(); // System statistics such as heap etc.
-	interruptData();
+	interruptData(o);
 	yield(); // Display interrupts only when debug >= 2
 
-	websiteFooter();
+	websiteFooter(o);
 	yield();
 
-	server.client().stop();
+	wwwLast.us = micros() - start;
+	wwwLast.bytes = o.bytes;
+	wwwLast.chunks = o.chunks;
+#if DUSB >= 1
+	if ((debug >= 1) && (pdebug & P_GUI))
+	{
+		Serial.print(F("G sendWebPage:: us="));
+		Serial.print(wwwLast.us);
+		Serial.print(F(", bytes="));
+		Serial.print(wwwLast.bytes);
+		Serial.print(F(", chunks="));
+		Serial.print(wwwLast.chunks);
+		Serial.print(F(", heap="));
+		Serial.print(wwwLast.heapPre);
+		Serial.print(F("/"));
+		Serial.println(wwwLast.heapLow);
+	}
+#endif
+	// The webserver closes the connection once the queued page is sent
 }
 
+// ================================================================================
+// REST API
+// The single page interface (www/index.html) is served gzip compressed from
+// flash and gets all its data from the small JSON documents below. Settings
+// are changed with POST /api/config?<CMD>=<value> which uses the same commands
+// as setVariables(), e.g. POST /api/config?SF=1 or /api/config?PDEBUG=RX
+// ================================================================================
+
 // --------------------------------------------------------------------------------
-// setupWWW is the main function for webserver functions/
-// SetupWWW function called by main setup() program to setup webserver
-// It does actually not much more than installing all the callback handlers
-// for messages sent to the webserver
-//
-// Implemented is an interface like:
-// http://<server>/<Variable>=<value>
-//
+// Write a JSON string value, escaping quotes, backslashes and control chars
 // --------------------------------------------------------------------------------
-void setupWWW()
+static void wJsonStr(wwwOut &o, const char *s)
 {
-	server.begin(); // Start the webserver
-
-	// -----------------
-	// BUTTONS, define what should happen with the buttons we press on the homepage
+	wChr(o, '"');
+	for (; *s; s++)
+	{
+		if ((*s == '"') || (*s == '\\'))
+		{
+			wChr(o, '\\');
+			wChr(o, *s);
+		}
+		else if ((uint8_t)*s < 0x20)
+		{
+			char tmp[7];
+			wPut(o, tmp, snprintf(tmp, sizeof(tmp), "\\u%04x", (uint8_t)*s));
+		}
+		else
+		{
+			wChr(o, *s);
+		}
+	}
+	wChr(o, '"');
+}
 
-	server.on("/", []() {
-		sendWebPage("", ""); // Send the webPage string
-		server.sendHeader("Location", String("/"), true);
-		server.send(302, "text/plain", "");
-	});
+// DevAddr as 8 hex digits in a JSON string
+static void wJsonAddr(wwwOut &o, uint32_t id)
+{
+	char tmp[11];
+	wPut(o, tmp, snprintf(tmp, sizeof(tmp), "\"%08X\"", id));
+}
 
-	server.on("/HELP", []() {
-		sendWebPage("HELP", ""); // Send the webPage string
-		server.sendHeader("Location", String("/"), true);
-		server.send(302, "text/plain", "");
-	});
+// --------------------------------------------------------------------------------
+// Start and end a chunked JSON response
+// --------------------------------------------------------------------------------
+static void apiBegin(wwwOut &o)
+{
+	o.len = 0;
+	o.chunks = 0;
+	o.bytes = 0;
+	server.sendHeader("Cache-Control", "no-store");
+	server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+	server.send(200, "application/json", "");
+}
+
+static void apiEnd(wwwOut &o)
+{
+	wFlush(o);
+	server.sendContent("");
+}
+
+// --------------------------------------------------------------------------------
+// GET /api/config
+// The settings that can be changed from the web interface
+// --------------------------------------------------------------------------------
+static void apiConfig()
+{
+	wwwOut o;
+	apiBegin(o);
+	wStr(o, F("{\"version\":\"" VERSION "\",\"uptime\":"));
+	wUns(o, millis() / 1000);
+	wStr(o, F(",\"sf\":"));
+	wNum(o, sf);
+	wStr(o, F(",\"ch\":"));
+	wNum(o, ifreq);
+	wStr(o, F(",\"freq\":"));
+	wUns(o, freqs[ifreq].upFreq);
+	wStr(o, F(",\"cad\":"));
+	wNum(o, _cad);
+	wStr(o, F(",\"hop\":"));
+	wNum(o, _hop);
+	wStr(o, F(",\"debug\":"));
+	wNum(o, debug);
+	wStr(o, F(",\"pdebug\":"));
+	wNum(o, pdebug);
+	wStr(o, F(",\"refresh\":"));
+	wNum(o, gwayConfig.refresh);
+	wStr(o, F(",\"interval\":"));
+	wNum(o, _WWW_INTERVAL);
+	wStr(o, F(",\"expert\":"));
+	wNum(o, gwayConfig.expert);
+	wStr(o, F(",\"node\":"));
+	wNum(o, gwayConfig.isNode);
+	wStr(o, F(",\"txDelay\":"));
+	wNum(o, txDelay);
+	wStr(o, F(",\"boots\":"));
+	wUns(o, gwayConfig.boots);
+	wStr(o, F(",\"ssid\":"));
+	wJsonStr(o, WiFi.SSID().c_str());
+	wStr(o, F(",\"heap\":"));
+	wUns(o, ESP.getFreeHeap());
+	wChr(o, '}');
+	apiEnd(o);
+}
+
+// --------------------------------------------------------------------------------
+// GET /api/stats
+// Package counters. The sf array holds SF7..SF12 when STATISTICS >= 2
+// --------------------------------------------------------------------------------
+static void apiStats()
+{
+	wwwOut o;
+	apiBegin(o);
+	wStr(o, F("{\"msg_ok\":"));
+	wUns(o, statc.msg_ok);
+	wStr(o, F(",\"msg_ttl\":"));
+	wUns(o, statc.msg_ttl);
+	wStr(o, F(",\"msg_down\":"));
+	wUns(o, statc.msg_down);
+	wStr(o, F(",\"since\":"));
+	wUns(o, startTime);
+#if _TRUSTED_NODES >= 2
+	wStr(o, F(",\"drop_list\":"));
+	wUns(o, statc.drop_list);
+#endif
+#if _RATE_LIMIT >= 1
+	wStr(o, F(",\"drop_rate\":"));
+	wUns(o, statc.drop_rate);
+	wStr(o, F(",\"rate_sampled\":"));
+	wUns(o, statc.rate_sampled);
+#endif
+#if _DEDUP >= 1
+	wStr(o, F(",\"msg_dup\":"));
+	wUns(o, statc.msg_dup);
+#endif
+#if _CHECK_MIC == 1
+	wStr(o, F(",\"drop\":{\"short\":"));
+	wUns(o, statc.drop_short);
+	wStr(o, F(",\"netid\":"));
+	wUns(o, statc.drop_netid);
+	wStr(o, F(",\"mic\":"));
+	wUns(o, statc.drop_mic);
+	wChr(o, '}');
+#endif
+#if STATISTICS >= 2
+	wStr(o, F(",\"sf\":["));
+	wUns(o, statc.sf7);
+	wChr(o, ',');
+	wUns(o, statc.sf8);
+	wChr(o, ',');
+	wUns(o, statc.sf9);
+	wChr(o, ',');
+	wUns(o, statc.sf10);
+	wChr(o, ',');
+	wUns(o, statc.sf11);
+	wChr(o, ',');
+	wUns(o, statc.sf12);
+	wChr(o, ']');
+#endif
+#ifdef CFG_sx1262_radio
+	// Radio event latency, tools/httpBench.py samples it under load
+	wStr(o, F(",\"loop\":{\"win\":"));
+	wUns(o, radioLoop.win);
+	wStr(o, F(",\"avg\":"));
+	wUns(o, radioLoop.avg);
+	wStr(o, F(",\"max\":"));
+	wUns(o, radioLoop.max);
+	wChr(o, '}');
+#endif
+	wChr(o, '}');
+	apiEnd(o);
+}
+
+// --------------------------------------------------------------------------------
+// GET /api/history
+// The last MAX_STAT received messages, newest first
+// --------------------------------------------------------------------------------
+static void apiHistory()
+{
+	wwwOut o;
+	apiBegin(o);
+	wChr(o, '[');
+#if STATISTICS >= 1
+	char tmp[40];
+	for (int i = 0; i < MAX_STAT; i++)
+	{
+		if (statr[i].sf == 0)
+			break;
+		if (i > 0)
+			wChr(o, ',');
+		wStr(o, F("{\"tmst\":"));
+		wUns(o, statr[i].tmst);
+		wStr(o, F(",\"node\":"));
+		wJsonAddr(o, __builtin_bswap32(statr[i].node)); // statr keeps the DevAddr LSB first
+		if (SerialName((char *)(&(statr[i].node)), tmp, sizeof(tmp)) >= 0)
+		{
+			wStr(o, F(",\"name\":"));
+			wJsonStr(o, tmp);
+		}
+#if _LOCALSERVER == 1
+		wStr(o, F(",\"data\":\""));
+		for (int j = 0; j < statr[i].datal; j++)
+		{
+			wHex2(o, statr[i].data[j]);
+		}
+		wChr(o, '"');
+#endif
+		wStr(o, F(",\"ch\":"));
+		wNum(o, statr[i].ch);
+		wStr(o, F(",\"freq\":"));
+		wUns(o, freqs[statr[i].ch].upFreq);
+		wStr(o, F(",\"sf\":"));
+		wNum(o, statr[i].sf);
+		wStr(o, F(",\"prssi\":"));
+		wNum(o, statr[i].prssi);
+		wChr(o, '}');
+	}
+#endif
+	wChr(o, ']');
+	apiEnd(o);
+}
+
+// --------------------------------------------------------------------------------
+// GET /api/nodes
+// The named (trusted) nodes and the nodes we decode. Keys are never sent.
+// --------------------------------------------------------------------------------
+static void apiNodes()
+{
+	wwwOut o;
+	bool first = true;
+	apiBegin(o);
+	wChr(o, '[');
+#if _TRUSTED_NODES >= 1
+	for (int i = 0; i < (int)(sizeof(nodes) / sizeof(nodex)); i++)
+	{
+		if (!first)
+			wChr(o, ',');
+		first = false;
+		wStr(o, F("{\"id\":"));
+		wJsonAddr(o, nodes[i].id);
+		wStr(o, F(",\"name\":"));
+		wJsonStr(o, nodes[i].nm);
+		wStr(o, F(",\"type\":\"trusted\"}"));
+	}
+#endif
+#if _LOCALSERVER == 1
+	struct session *node;
+	for (int i = 0; (node = sessionAt(i)) != NULL; i++)
+	{
+		if (!first)
+			wChr(o, ',');
+		first = false;
+		wStr(o, F("{\"id\":"));
+		wJsonAddr(o, node->addr);
+		wStr(o, F(",\"name\":"));
+		wJsonStr(o, node->nm);
+		wStr(o, F(",\"fcnt\":"));
+		wUns(o, node->fcnt);
+		wStr(o, F(",\"type\":\"decode\"}"));
+	}
+#endif
+	wChr(o, ']');
+	apiEnd(o);
+}
+
+#if _RATE_LIMIT >= 1
+// --------------------------------------------------------------------------------
+// GET /api/talkers
+// The Top Talkers list as JSON
+// --------------------------------------------------------------------------------
+static void apiTalkers()
+{
+	struct rateNode *top[WWW_TOP];
+	int n = rateTop(top, WWW_TOP);
+	wwwOut o;
+	apiBegin(o);
+	wChr(o, '[');
+	for (int i = 0; i < n; i++)
+	{
+		if (i > 0)
+			wChr(o, ',');
+		wStr(o, F("{\"id\":"));
+		wJsonAddr(o, top[i]->addr);
+		wStr(o, F(",\"frames\":"));
+		wUns(o, top[i]->frames);
+		wStr(o, F(",\"excess\":"));
+		wUns(o, top[i]->excess);
+		wStr(o, F(",\"tokens\":"));
+		wUns(o, top[i]->tokens / 1000);
+		wChr(o, '}');
+	}
+	wChr(o, ']');
+	apiEnd(o);
+}
+#endif
+
+#if (_LOCALSERVER == 1) || (_TRUSTED_NODES >= 2)
+// --------------------------------------------------------------------------------
+// Read exactly 2*n hex digits into n bytes. Returns false for anything else.
+// --------------------------------------------------------------------------------
+static bool wwwHexBytes(const char *s, uint8_t *buf, int n)
+{
+	if ((int)strlen(s) != 2 * n)
+		return (false);
+	for (int i = 0; i < 2 * n; i++)
+	{
+		char c = s[i];
+		uint8_t v;
+		if ((c >= '0') && (c <= '9'))
+			v = c - '0';
+		else if ((c >= 'a') && (c <= 'f'))
+			v = c - 'a' + 10;
+		else if ((c >= 'A') && (c <= 'F'))
+			v = c - 'A' + 10;
+		else
+			return (false);
+		buf[i / 2] = (i & 1) ? (buf[i / 2] | v) : (v << 4);
+	}
+	return (true);
+}
+
+// --------------------------------------------------------------------------------
+// DevAddr from 8 hex digits, MSB first. Returns false when s is no DevAddr.
+// --------------------------------------------------------------------------------
+static bool wwwAddr(const char *s, uint32_t *id)
+{
+	uint8_t addr[4];
+	if (!wwwHexBytes(s, addr, 4))
+		return (false);
+	*id = ((uint32_t)addr[0] << 24) | ((uint32_t)addr[1] << 16) | ((uint32_t)addr[2] << 8) | addr[3];
+	return (true);
+}
+#endif
+
+#if _LOCALSERVER == 1
+// --------------------------------------------------------------------------------
+// GET /api/sessions
+// Size of the device session table. The devices are listed by /api/nodes.
+// --------------------------------------------------------------------------------
+static void apiSessions()
+{
+	wwwOut o;
+	apiBegin(o);
+	wStr(o, F("{\"count\":"));
+	wNum(o, sessionCount);
+	wStr(o, F(",\"max\":"));
+	wNum(o, sessionMax);
+	wChr(o, '}');
+	apiEnd(o);
+}
+
+// --------------------------------------------------------------------------------
+// POST /api/sessions?addr=<8 hex>&name=<name>&nwkskey=<32 hex>&appskey=<32 hex>
+// Add a device, or replace name and keys of a known one, and save the table.
+// --------------------------------------------------------------------------------
+static void apiAddSession()
+{
+	uint32_t id;
+	uint8_t nwkKey[16], appKey[16];
+	if (!wwwAddr(server.argView("addr"), &id) ||
+		!wwwHexBytes(server.argView("nwkskey"), nwkKey, 16) ||
+		!wwwHexBytes(server.argView("appskey"), appKey, 16))
+	{
+		server.send(400, "text/plain", "addr, nwkskey or appskey missing or not hex");
+		return;
+	}
+	if (sessionAdd(id, server.argView("name"), nwkKey, appKey) < 0)
+	{
+		server.send(507, "text/plain", "Session table full");
+		return;
+	}
+	sessionSave();
+	apiSessions();
+}
+
+// --------------------------------------------------------------------------------
+// DELETE /api/sessions/<8 hex DevAddr>
+// --------------------------------------------------------------------------------
+static void apiDelSession()
+{
+	uint32_t id;
+	if (!wwwAddr(server.pathArg(0).c_str(), &id))
+	{
+		server.send(400, "text/plain", "DevAddr must be 8 hex digits");
+		return;
+	}
+	if (!sessionRemove(id))
+	{
+		server.send(404, "text/plain", "Unknown DevAddr");
+		return;
+	}
+	sessionSave();
+	apiSessions();
+}
+#endif // _LOCALSERVER
+
+#if _TRUSTED_NODES >= 2
+// --------------------------------------------------------------------------------
+// GET /api/lists/{allow|deny}
+// All addresses on the list
+// --------------------------------------------------------------------------------
+static void apiList()
+{
+	int which = server.pathArgIndex(0);
+	wwwOut o;
+	apiBegin(o);
+	wStr(o, F("{\"count\":"));
+	wNum(o, listCount(which));
+	wStr(o, F(",\"addr\":["));
+	for (int i = 0; i < listCount(which); i++)
+	{
+		if (i > 0)
+			wChr(o, ',');
+		wJsonAddr(o, listAt(which, i));
+	}
+	wStr(o, F("]}"));
+	apiEnd(o);
+}
+
+// --------------------------------------------------------------------------------
+// POST /api/lists/{allow|deny}?addr=26011234,260114FE,...
+// Add addresses to a list. Nothing is added when one of them is no DevAddr.
+// --------------------------------------------------------------------------------
+static void apiListAdd()
+{
+	int which = server.pathArgIndex(0);
+	const char *p = server.argView("addr");
+	char hex[9];
+	uint32_t id;
+
+	// Check all addresses first, then add them
+	for (int pass = 0; pass < 2; pass++)
+	{
+		for (const char *s = p; *s;)
+		{
+			size_t len = strcspn(s, ", ");
+			if (len > 0)
+			{
+				bool ok = (len == 8);
+				if (ok)
+				{
+					memcpy(hex, s, 8);
+					hex[8] = 0;
+					ok = wwwAddr(hex, &id);
+				}
+				if (!ok)
+				{
+					server.send(400, "text/plain", "addr must be DevAddrs of 8 hex digits");
+					return;
+				}
+				if ((pass == 1) && (listAdd(which, id) < 0))
+				{
+					server.send(507, "text/plain", "Out of memory");
+					return;
+				}
+			}
+			s += len;
+			if (*s)
+				s++;
+		}
+	}
+	listSave(which);
+	apiList();
+}
+
+// --------------------------------------------------------------------------------
+// DELETE /api/lists/{allow|deny}/<DevAddr>, remove one address
+// DELETE /api/lists/{allow|deny}, empty the list
+// --------------------------------------------------------------------------------
+static void apiListDel()
+{
+	int which = server.pathArgIndex(0);
+	if (server.pathArgs() > 1)
+	{
+		uint32_t id;
+		if (!wwwAddr(server.pathArg(1).c_str(), &id))
+		{
+			server.send(400, "text/plain", "DevAddr must be 8 hex digits");
+			return;
+		}
+		if (!listRemove(which, id))
+		{
+			server.send(404, "text/plain", "DevAddr not on the list");
+			return;
+		}
+	}
+	else
+	{
+		listClear(which);
+	}
+	listSave(which);
+	apiList();
+}
+#endif // _TRUSTED_NODES
+
+#ifdef CFG_sx1262_radio
+// --------------------------------------------------------------------------------
+// Spectrum bins as a hex string, two digits of -dBm per bin
+// Parameters:
+//		buf: At least 2 * SPEC_BINS + 1 bytes
+//		kind: 0 min, 1 average, 2 max
+// --------------------------------------------------------------------------------
+static int specHex(char *buf, int kind)
+{
+	static const char hex[] = "0123456789ABCDEF";
+	for (int i = 0; i < spec.bins; i++)
+	{
+		int v;
+		if (kind == 0)
+			v = -specLast[i].min;
+		else if (kind == 1)
+			v = -(specLast[i].sum / SPEC_SAMPLES);
+		else
+			v = -specLast[i].max;
+		buf[2 * i] = hex[(v >> 4) & 0x0F];
+		buf[2 * i + 1] = hex[v & 0x0F];
+	}
+	buf[2 * spec.bins] = 0;
+	return (2 * spec.bins);
+}
+
+// --------------------------------------------------------------------------------
+// GET /api/spectrum
+// Settings of the spectrum scanner, the frequency of every bin and the last
+// sweep as min, avg and max hex strings (two digits of -dBm per bin)
+// --------------------------------------------------------------------------------
+static void apiSpectrum()
+{
+	char hex[2 * SPEC_BINS + 1];
+	wwwOut o;
+	apiBegin(o);
+	wStr(o, F("{\"on\":"));
+	wNum(o, spec.on);
+	wStr(o, F(",\"start\":"));
+	wUns(o, spec.start);
+	wStr(o, F(",\"step\":"));
+	wUns(o, spec.step);
+	wStr(o, F(",\"n\":"));
+	wNum(o, spec.bins);
+	wStr(o, F(",\"sweeps\":"));
+	wUns(o, spec.sweeps);
+	wStr(o, F(",\"us\":"));
+	wUns(o, spec.us);
+	wStr(o, F(",\"freq\":["));
+	for (int i = 0; i < spec.bins; i++)
+	{
+		if (i > 0)
+			wChr(o, ',');
+		wUns(o, specFreq(i));
+	}
+	wStr(o, F("],\"min\":\""));
+	specHex(hex, 0);
+	wStr(o, hex);
+	wStr(o, F("\",\"avg\":\""));
+	specHex(hex, 1);
+	wStr(o, hex);
+	wStr(o, F("\",\"max\":\""));
+	specHex(hex, 2);
+	wStr(o, hex);
+	wStr(o, F("\"}"));
+	apiEnd(o);
+}
+
+// --------------------------------------------------------------------------------
+// POST /api/spectrum?start=<Hz>&stop=<Hz>&step=<Hz>	sweep a range
+// POST /api/spectrum?plan=1							sweep the channels of freqs[]
+// POST /api/spectrum?off=1								stop the scanner
+// --------------------------------------------------------------------------------
+static void apiSpectrumSet()
+{
+	if (server.hasArg("off"))
+	{
+		specStop();
+	}
+	else if (server.hasArg("plan"))
+	{
+		specStart(0, 0, 0);
+	}
+	else
+	{
+		uint32_t start = strtoul(server.argView("start"), NULL, 10);
+		uint32_t stop = strtoul(server.argView("stop"), NULL, 10);
+		uint32_t step = strtoul(server.argView("step"), NULL, 10);
+		if ((start == 0) || (step == 0) || (stop < start))
+		{
+			server.send(400, "text/plain", "start, stop and step in Hz, stop >= start");
+			return;
+		}
+		specStart(start, stop, step);
+	}
+	apiSpectrum();
+}
+#endif
+
+// --------------------------------------------------------------------------------
+// POST /api/config?<CMD>=<value>
+// Every argument is handed to setVariables() as a command, the reply is the
+// new configuration.
+// --------------------------------------------------------------------------------
+static void apiSetConfig()
+{
+	for (int i = 0; i < server.args(); i++)
+	{
+		setVariables(server.argNameView(i), server.argView(i));
+	}
+	apiConfig();
+}
+
+// --------------------------------------------------------------------------------
+// GET /
+// Send the compressed single page interface. The browser revalidates with
+// If-None-Match and gets a 304 as long as the firmware has the same page.
+// --------------------------------------------------------------------------------
+static void wwwIndex()
+{
+	if (strcmp(server.headerView("If-None-Match"), WWW_INDEX_ETAG) == 0)
+	{
+		server.send(304, "text/plain", "");
+		return;
+	}
+	server.sendHeader("ETag", WWW_INDEX_ETAG);
+	server.sendHeader("Cache-Control", "no-cache");
+	server.sendHeader("Content-Encoding", "gzip");
+	server.send_P(200, "text/html", (PGM_P)wwwIndexGz, sizeof(wwwIndexGz));
+}
+
+// ================================================================================
+// LIVE EVENTS
+// GET /api/events is a Server-Sent Events stream that replaces the page reloads
+// of A_REFRESH. Every received and transmitted frame is pushed as one small
+// JSON record, every WWW_SSE_STAT seconds the counters that changed since the
+// previous stat event are sent (which also keeps the connection alive).
+// Every browser has its own send queue which is emptied from loop() with non
+// blocking socket writes. An event that does not fit in the queue of a slow
+// browser is dropped for that browser and counted, the gateway never waits
+// for the web interface. Without listeners the event functions return at once.
+// ================================================================================
+
+#define WWW_SSE_MAX 2	 // Number of browsers that can follow the feed
+#define WWW_SSE_BUF 1024 // Send queue per browser
+#define WWW_SSE_STAT 10	 // Seconds between stat events
+
+struct sseClient
+{
+	WiFiClient c;
+	char buf[WWW_SSE_BUF]; // Events not yet accepted by the socket
+	uint16_t len;		   // Number of bytes in buf
+	uint32_t drops;		   // Events dropped for this browser
+	uint32_t ok;		   // Counters as sent in the last stat event
+	uint32_t ttl;
+	uint32_t down;
+	bool active;
+};
+
+static sseClient sse[WWW_SSE_MAX];
+static uint8_t sseCount = 0; // Number of active browsers
+static uint32_t sseDrops = 0; // Events dropped over all browsers
+static uint32_t sseTime = 0;  // millis() of the last stat event
+
+// --------------------------------------------------------------------------------
+// Queue one complete event for every browser that has room for it.
+// Parameters:
+//		ev: The event text, "event: <type>\ndata: <json>\n\n"
+//		len: Length of ev
+// --------------------------------------------------------------------------------
+static void sseQueue(sseClient &s, const char *ev, int len)
+{
+	if ((len <= 0) || (s.len + len > WWW_SSE_BUF))
+	{
+		s.drops++;
+		sseDrops++;
+		return;
+	}
+	memcpy(s.buf + s.len, ev, len);
+	s.len += len;
+}
+
+static void sseQueueAll(const char *ev, int len)
+{
+	for (int i = 0; i < WWW_SSE_MAX; i++)
+	{
+		if (sse[i].active)
+			sseQueue(sse[i], ev, len);
+	}
+}
+
+// --------------------------------------------------------------------------------
+// Close the event stream of a browser and free its slot
+// --------------------------------------------------------------------------------
+static void sseClose(sseClient &s)
+{
+	s.c.stop();
+	s.active = false;
+	s.len = 0;
+	sseCount--;
+#if DUSB >= 1
+	if ((debug >= 1) && (pdebug & P_GUI))
+	{
+		Serial.print(F("G sseClose:: drops="));
+		Serial.println(s.drops);
+	}
+#endif
+}
+
+// --------------------------------------------------------------------------------
+// GET /api/events
+// Take the connection over from the webserver and keep it as an event stream.
+// When all slots are in use the request is refused with 503 and the browser
+// falls back to polling the REST API.
+// --------------------------------------------------------------------------------
+static void apiEvents()
+{
+	int i;
+	for (i = 0; i < WWW_SSE_MAX; i++)
+	{
+		if (!sse[i].active)
+			break;
+	}
+	if (i == WWW_SSE_MAX)
+	{
+		server.send(503, "text/plain", "");
+		return;
+	}
+
+	sseClient &s = sse[i];
+	s.c = server.client();
+	s.c.setNoDelay(true);
+	s.len = 0;
+	s.drops = 0;
+	// Sent by wwwEventLoop() like the events, never blocks
+	static const char head[] = "HTTP/1.1 200 OK\r\n"
+							   "Content-Type: text/event-stream\r\n"
+							   "Cache-Control: no-cache\r\n"
+							   "Connection: keep-alive\r\n\r\n"
+							   "retry: 5000\n\n";
+	sseQueue(s, head, sizeof(head) - 1);
+	s.ok = statc.msg_ok; // The browser fetched /api/stats before it subscribed
+	s.ttl = statc.msg_ttl;
+	s.down = statc.msg_down;
+	s.active = true;
+	sseCount++;
+#if DUSB >= 1
+	if ((debug >= 1) && (pdebug & P_GUI))
+	{
+		Serial.print(F("G apiEvents:: slot="));
+		Serial.println(i);
+	}
+#endif
+}
+
+// --------------------------------------------------------------------------------
+// Push a received frame to the browsers.
+// Parameters:
+//		payLoad, payLength: The LoRa frame as received
+//		sf: Spreading factor of the frame
+//		prssi: Packet RSSI
+//		snr: Packet SNR
+// --------------------------------------------------------------------------------
+void wwwEventRx(uint8_t *payLoad, uint8_t payLength, uint8_t sf, int prssi, long snr)
+{
+	if (sseCount == 0)
+		return;
+
+	char ev[192];
+	uint8_t mtype = payLoad[0] >> 5;
+	int n = snprintf(ev, sizeof(ev), "event: rx\ndata: {\"tmst\":%u,\"mtype\":%u",
+					 (unsigned)now(), mtype);
+	if ((mtype >= 2) && (mtype <= 5) && (payLength >= 8)) // Data frames carry DevAddr and FCnt
+	{
+		n += snprintf(ev + n, sizeof(ev) - n, ",\"node\":\"%02X%02X%02X%02X\",\"fcnt\":%u",
+					  payLoad[4], payLoad[3], payLoad[2], payLoad[1],
+					  (unsigned)(payLoad[6] | (payLoad[7] << 8)));
+	}
+	n += snprintf(ev + n, sizeof(ev) - n,
+				  ",\"ch\":%d,\"freq\":%u,\"sf\":%u,\"prssi\":%d,\"snr\":%ld,\"len\":%u}\n\n",
+				  ifreq, (unsigned)freqs[ifreq].upFreq, sf, prssi, snr, payLength);
+	sseQueueAll(ev, n);
+}
+
+// --------------------------------------------------------------------------------
+// Push a transmitted (downlink) frame to the browsers.
+// Parameters:
+//		freq: Frequency in Hz
+//		sf: Spreading factor
+//		len: Length of the frame
+// --------------------------------------------------------------------------------
+void wwwEventTx(uint32_t freq, uint8_t sf, uint8_t len)
+{
+	if (sseCount == 0)
+		return;
+
+	char ev[96];
+	int n = snprintf(ev, sizeof(ev), "event: tx\ndata: {\"tmst\":%u,\"freq\":%u,\"sf\":%u,\"len\":%u}\n\n",
+					 (unsigned)now(), (unsigned)freq, sf, len);
+	sseQueueAll(ev, n);
+}
+
+#ifdef CFG_sx1262_radio
+// --------------------------------------------------------------------------------
+// Push a completed spectrum sweep to the browsers, one line of the waterfall.
+// The frequencies of the bins are in GET /api/spectrum.
+// --------------------------------------------------------------------------------
+void wwwEventSpec()
+{
+	if (sseCount == 0)
+		return;
+
+	char ev[6 * SPEC_BINS + 96];
+	int n = snprintf(ev, sizeof(ev), "event: spec\ndata: {\"sweeps\":%u,\"n\":%u,\"min\":\"",
+					 (unsigned)spec.sweeps, spec.bins);
+	n += specHex(ev + n, 0);
+	n += snprintf(ev + n, sizeof(ev) - n, "\",\"avg\":\"");
+	n += specHex(ev + n, 1);
+	n += snprintf(ev + n, sizeof(ev) - n, "\",\"max\":\"");
+	n += specHex(ev + n, 2);
+	n += snprintf(ev + n, sizeof(ev) - n, "\"}\n\n");
+	sseQueueAll(ev, n);
+}
+#endif
+
+// --------------------------------------------------------------------------------
+// Called from loop(). Queue the stat events when they are due and hand as much
+// of every queue to the socket as it accepts without blocking.
+// --------------------------------------------------------------------------------
+void wwwEventLoop()
+{
+	if (sseCount == 0)
+		return;
+
+	bool stat = (millis() - sseTime) >= (WWW_SSE_STAT * 1000UL);
+	if (stat)
+		sseTime = millis();
+
+	for (int i = 0; i < WWW_SSE_MAX; i++)
+	{
+		sseClient &s = sse[i];
+		if (!s.active)
+			continue;
+
+		if (!s.c.connected())
+		{
+			sseClose(s);
+			continue;
+		}
+
+		if (stat)
+		{
+			// Deltas against what this browser was told, a dropped stat
+			// event is included in the next one
+			char ev[128];
+			int n = snprintf(ev, sizeof(ev),
+							 "event: stat\ndata: {\"msg_ok\":%u,\"msg_ttl\":%u,\"msg_down\":%u,\"drops\":%u}\n\n",
+							 (unsigned)(statc.msg_ok - s.ok), (unsigned)(statc.msg_ttl - s.ttl),
+							 (unsigned)(statc.msg_down - s.down), (unsigned)s.drops);
+			if (s.len + n <= WWW_SSE_BUF)
+			{
+				sseQueue(s, ev, n);
+				s.ok = statc.msg_ok;
+				s.ttl = statc.msg_ttl;
+				s.down = statc.msg_down;
+			}
+		}
+
+		if (s.len == 0)
+			continue;
+
+		int sent = send(s.c.fd(), s.buf, s.len, MSG_DONTWAIT);
+		if (sent > 0)
+		{
+			s.len -= sent;
+			memmove(s.buf, s.buf + sent, s.len);
+		}
+		else if ((sent < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK))
+		{
+			sseClose(s);
+		}
+	}
+}
+
+// --------------------------------------------------------------------------------
+// Send the browser back to the classic page after one of its buttons
+// --------------------------------------------------------------------------------
+static void wwwRedirect()
+{
+	server.sendHeader("Location", String("/HTML"), true);
+	server.send(302, "text/plain", "");
+}
+
+// --------------------------------------------------------------------------------
+// setupWWW is the main function for webserver functions/
+// SetupWWW function called by main setup() program to setup webserver
+// It does actually not much more than installing all the callback handlers
+// for messages sent to the webserver
+//
+// Implemented is an interface like:
+// http://<server>/<Variable>=<value>
+//
+// --------------------------------------------------------------------------------
+void setupWWW()
+{
+	server.begin(); // Start the webserver
+
+	// -----------------
+	// BUTTONS, define what should happen with the buttons we press on the homepage
+
+	// Collect the header needed for the ETag check of the page
+	static const char *hdrs[] = {"If-None-Match"};
+	server.collectHeaders(hdrs, 1);
+
+#if (ESP32_ARCH == 1) && defined(CFG_sx1262_radio)
+	// Keep receiving while a page waits for a slow client
+	server.onIdle(radioIdle);
+#endif
+
+	// The single page interface and its JSON API
+	server.on("/", HTTP_GET, wwwIndex);
+	server.on("/api/config", HTTP_GET, apiConfig);
+	server.on("/api/config", HTTP_POST, apiSetConfig);
+	server.on("/api/stats", HTTP_GET, apiStats);
+	server.on("/api/history", HTTP_GET, apiHistory);
+	server.on("/api/nodes", HTTP_GET, apiNodes);
+	server.on("/api/events", HTTP_GET, apiEvents);
+#ifdef CFG_sx1262_radio
+	server.on("/api/spectrum", HTTP_GET, apiSpectrum);
+	server.on("/api/spectrum", HTTP_POST, apiSpectrumSet);
+#endif
+#if _RATE_LIMIT >= 1
+	server.on("/api/talkers", HTTP_GET, apiTalkers);
+#endif
+#if _LOCALSERVER == 1
+	server.on("/api/sessions", HTTP_GET, apiSessions);
+	server.on("/api/sessions", HTTP_POST, apiAddSession);
+	server.on("/api/sessions/{str}", HTTP_DELETE, apiDelSession);
+#endif
+#if _TRUSTED_NODES >= 2
+	server.on("/api/lists/{allow|deny}", HTTP_GET, apiList);
+	server.on("/api/lists/{allow|deny}", HTTP_POST, apiListAdd);
+	server.on("/api/lists/{allow|deny}", HTTP_DELETE, apiListDel);
+	server.on("/api/lists/{allow|deny}/{str}", HTTP_DELETE, apiListDel);
+#endif
+	server.on("/api/reset", HTTP_POST, []() {
+		resetStats();
+		apiStats();
+	});
+	server.on("/api/boot", HTTP_POST, []() {
+		gwayConfig.boots = 0;
+		writeGwayCfg(CONFIGFILE);
+		apiConfig();
+	});
+
+	// The classic page, rendered on the gateway
+	server.on("/HTML", []() {
+		sendWebPage("", ""); // Send the webPage string
+	});
+
+	server.on("/HELP", []() {
+		sendWebPage("HELP", ""); // Send the webPage string
+		wwwRedirect();
+	});
 
 	// Format the filesystem
 	server.on("/FORMAT", []() {
@@ -1053,70 +2310,13 @@ void setupWWW()
 #if DUSB >= 1
 		Serial.println(F("DONE"));
 #endif
-		server.sendHeader("Location", String("/"), true);
-		server.send(302, "text/plain", "");
+		wwwRedirect();
 	});
 
 	// Reset the statistics
 	server.on("/RESET", []() {
-		Serial.println(F("RESET"));
-		startTime = now() - 1; // Reset all timers too
-
-		statc.msg_ttl = 0; // Reset package statistics
-		statc.msg_ok = 0;
-		statc.msg_down = 0;
-
-#if STATISTICS >= 3
-		statc.msg_ttl_0 = 0;
-		statc.msg_ttl_1 = 0;
-		statc.msg_ttl_2 = 0;
-		statc.msg_ok_0 = 0;
-		statc.msg_ok_1 = 0;
-		statc.msg_ok_2 = 0;
-		statc.msg_down_0 = 0;
-		statc.msg_down_1 = 0;
-		statc.msg_down_2 = 0;
-#endif
-
-#if STATISTICS >= 1
-		for (int i = 0; i < MAX_STAT; i++)
-		{
-			statr[i].sf = 0;
-		}
-#if STATISTICS >= 2
-		statc.sf7 = 0;
-		statc.sf8 = 0;
-		statc.sf9 = 0;
-		statc.sf10 = 0;
-		statc.sf11 = 0;
-		statc.sf12 = 0;
-
-		statc.resets = 0;
-		writeGwayCfg(CONFIGFILE);
-#if STATISTICS >= 3
-		statc.sf7_0 = 0;
-		statc.sf7_1 = 0;
-		statc.sf7_2 = 0;
-		statc.sf8_0 = 0;
-		statc.sf8_1 = 0;
-		statc.sf8_2 = 0;
-		statc.sf9_0 = 0;
-		statc.sf9_1 = 0;
-		statc.sf9_2 = 0;
-		statc.sf10_0 = 0;
-		statc.sf10_1 = 0;
-		statc.sf10_2 = 0;
-		statc.sf11_0 = 0;
-		statc.sf11_1 = 0;
-		statc.sf11_2 = 0;
-		statc.sf12_0 = 0;
-		statc.sf12_1 = 0;
-		statc.sf12_2 = 0;
-#endif
-#endif
-#endif
-		server.sendHeader("Location", String("/"), true);
-		server.send(302, "text/plain", "");
+		resetStats();
+		wwwRedirect();
 	});
 
 	// Reset the boot counter
@@ -1133,166 +2333,103 @@ void setupWWW()
 		gwayConfig.reents = 0; // Re-entrance
 
 		writeGwayCfg(CONFIGFILE);
-		server.sendHeader("Location", String("/"), true);
-		server.send(302, "text/plain", "");
+		wwwRedirect();
 	});
 
 	server.on("/NEWSSID", []() {
 		sendWebPage("NEWSSID", ""); // Send the webPage string
-		server.sendHeader("Location", String("/"), true);
-		server.send(302, "text/plain", "");
+		wwwRedirect();
 	});
 
-	// Set debug parameter
-	server.on("/DEBUG=-1", []() { // Set debug level 0-2
-		debug = (debug + 3) % 4;
+	// The buttons of the classic page. The values are typed parameters of
+	// the route, anything else gets a 404.
+	server.on("/DEBUG={-1|1}", []() { // Set debug level 0-3
+		debug = (debug + (server.pathArgInt(0) == 1 ? 1 : 3)) % 4;
 		writeGwayCfg(CONFIGFILE); // Save configuration to file
-		server.sendHeader("Location", String("/"), true);
-		server.send(302, "text/plain", "");
-	});
-	server.on("/DEBUG=1", []() {
-		debug = (debug + 1) % 4;
-		writeGwayCfg(CONFIGFILE); // Save configuration to file
-		server.sendHeader("Location", String("/"), true);
-		server.send(302, "text/plain", "");
+		wwwRedirect();
 	});
 
-	// Set PDEBUG parameter
-	//
-	server.on("/PDEBUG=SCAN", []() { // Set debug level 0-2
-		pdebug ^= P_SCAN;
-		writeGwayCfg(CONFIGFILE); // Save configuration to file
-		server.sendHeader("Location", String("/"), true);
-		server.send(302, "text/plain", "");
-	});
-	server.on("/PDEBUG=CAD", []() { // Set debug level 0-2
-		pdebug ^= P_CAD;
-		writeGwayCfg(CONFIGFILE); // Save configuration to file
-		server.sendHeader("Location", String("/"), true);
-		server.send(302, "text/plain", "");
-	});
-	server.on("/PDEBUG=RX", []() { // Set debug level 0-2
-		pdebug ^= P_RX;
-		writeGwayCfg(CONFIGFILE); // Save configuration to file
-		server.sendHeader("Location", String("/"), true);
-		server.send(302, "text/plain", "");
-	});
-	server.on("/PDEBUG=TX", []() { // Set debug level 0-2
-		pdebug ^= P_TX;
-		writeGwayCfg(CONFIGFILE); // Save configuration to file
-		server.sendHeader("Location", String("/"), true);
-		server.send(302, "text/plain", "");
-	});
-	server.on("/PDEBUG=PRE", []() { // Set debug level 0-2
-		pdebug ^= P_PRE;
-		writeGwayCfg(CONFIGFILE); // Save configuration to file
-		server.sendHeader("Location", String("/"), true);
-		server.send(302, "text/plain", "");
-	});
-	server.on("/PDEBUG=MAIN", []() { // Set debug level 0-2
-		pdebug ^= P_MAIN;
-		writeGwayCfg(CONFIGFILE); // Save configuration to file
-		server.sendHeader("Location", String("/"), true);
-		server.send(302, "text/plain", "");
-	});
-	server.on("/PDEBUG=GUI", []() { // Set debug level 0-2
-		pdebug ^= P_GUI;
-		writeGwayCfg(CONFIGFILE); // Save configuration to file
-		server.sendHeader("Location", String("/"), true);
-		server.send(302, "text/plain", "");
-	});
-	server.on("/PDEBUG=RADIO", []() { // Set debug level 0-2
-		pdebug ^= P_RADIO;
+	// Toggle one bit of the PDEBUG pattern, the names are in bit order
+	server.on("/PDEBUG={SCAN|CAD|RX|TX|PRE|MAIN|GUI|RADIO}", []() {
+		pdebug ^= (1 << server.pathArgIndex(0));
 		writeGwayCfg(CONFIGFILE); // Save configuration to file
-		server.sendHeader("Location", String("/"), true);
-		server.send(302, "text/plain", "");
+		wwwRedirect();
 	});
 
 	// Set delay in microseconds
-	server.on("/DELAY=1", []() {
-		txDelay += 5000;
-		server.sendHeader("Location", String("/"), true);
-		server.send(302, "text/plain", "");
-	});
-	server.on("/DELAY=-1", []() {
-		txDelay -= 5000;
-		server.sendHeader("Location", String("/"), true);
-		server.send(302, "text/plain", "");
+	server.on("/DELAY={-1|1}", []() {
+		txDelay += server.pathArgInt(0) * 5000;
+		wwwRedirect();
 	});
 
 	// Spreading Factor setting
-	server.on("/SF=1", []() {
-		if (sf >= SF12)
-			sf = SF7;
-		else
-			sf = (sf_t)((int)sf + 1);
-		server.sendHeader("Location", String("/"), true);
-		server.send(302, "text/plain", "");
-	});
-	server.on("/SF=-1", []() {
-		if (sf <= SF7)
-			sf = SF12;
+	server.on("/SF={-1|1}", []() {
+		if (server.pathArgInt(0) == 1)
+			sf = (sf >= SF12) ? SF7 : (sf_t)((int)sf + 1);
 		else
-			sf = (sf_t)((int)sf - 1);
-		server.sendHeader("Location", String("/"), true);
-		server.send(302, "text/plain", "");
+			sf = (sf <= SF7) ? SF12 : (sf_t)((int)sf - 1);
+		wwwRestartRx();			  // Receive on the new spreading factor
+		writeGwayCfg(CONFIGFILE); // Save configuration to file
+		wwwRedirect();
 	});
 
 	// Set Frequency of the GateWay node
-	server.on("/FREQ=1", []() {
+	server.on("/FREQ={-1|1}", []() {
 		uint8_t nf = sizeof(freqs) / sizeof(freqs[0]); // Number of elements in array
-#if DUSB == 2
-		Serial.print("FREQ==1:: For freq[0] sizeof vector=");
-		Serial.print(sizeof(freqs[0]));
-		Serial.println();
-#endif
-		if (ifreq == (nf - 1))
-			ifreq = 0;
+		if (server.pathArgInt(0) == 1)
+			ifreq = (ifreq == (nf - 1)) ? 0 : ifreq + 1;
 		else
-			ifreq++;
-		server.sendHeader("Location", String("/"), true);
-		server.send(302, "text/plain", "");
-	});
-	server.on("/FREQ=-1", []() {
-		uint8_t nf = sizeof(freqs) / sizeof(freqs[0]); // Number of elements in array
-		if (ifreq == 0)
-			ifreq = (nf - 1);
+			ifreq = (ifreq == 0) ? (nf - 1) : ifreq - 1;
+#ifdef CFG_sx1262_radio
+		setFreq(freqs[ifreq].upFreq);
+		if ((_cad) || (_hop))
+		{
+			cadScanner();
+		}
 		else
-			ifreq--;
-		server.sendHeader("Location", String("/"), true);
-		server.send(302, "text/plain", "");
+		{
+			rxLoraModem();
+		}
+#endif
+		wwwRedirect();
 	});
 
 	// Set CAD function off/on
-	server.on("/CAD=1", []() {
-		_cad = (bool)1;
+	server.on("/CAD={0|1}", []() {
+		_cad = (bool)server.pathArgIndex(0);
+#ifdef CFG_sx1262_radio
+		if (_cad)
+		{
+			cadScanner();
+		}
+		else
+		{
+			rxLoraModem();
+		}
+#endif
 		writeGwayCfg(CONFIGFILE); // Save configuration to file
-		server.sendHeader("Location", String("/"), true);
-		server.send(302, "text/plain", "");
+		wwwRedirect();
 	});
-	server.on("/CAD=0", []() {
-		_cad = (bool)0;
-		writeGwayCfg(CONFIGFILE); // Save configuration to file
-		server.sendHeader("Location", String("/"), true);
-		server.send(302, "text/plain", "");
+
+#ifdef CFG_sx1262_radio
+	// Switch the SX1262 RX duty cycle off/on, only used without CAD and HOP
+	server.on("/SNIFF={0|1}", []() {
+		_sniff = (bool)server.pathArgIndex(0);
+		if ((!_cad) && (!_hop))
+		{
+			rxLoraModem();
+		}
+		wwwRedirect();
 	});
+#endif
 
 	// GatewayNode
-	server.on("/NODE=1", []() {
+	server.on("/NODE={0|1}", []() {
 #if GATEWAYNODE == 1
-		gwayConfig.isNode = (bool)1;
+		gwayConfig.isNode = (bool)server.pathArgIndex(0);
 		writeGwayCfg(CONFIGFILE); // Save configuration to file
 #endif
-		server.sendHeader("Location", String("/"), true);
-		server.send(302, "text/plain", "");
-	});
-	server.on("/NODE=0", []() {
-#if GATEWAYNODE == 1
-		gwayConfig.isNode = (bool)0;
-		writeGwayCfg(CONFIGFILE); // Save configuration to file
-#endif
-		server.sendHeader("Location", String("/"), true);
-		server.send(302, "text/plain", "");
+		wwwRedirect();
 	});
 
 #if GATEWAYNODE == 1
@@ -1303,54 +2440,51 @@ void setupWWW()
 		writeGwayCfg(CONFIGFILE);
 
 		//sendWebPage("","");						// Send the webPage string
-		server.sendHeader("Location", String("/"), true);
-		server.send(302, "text/plain", "");
+		wwwRedirect();
 	});
 #endif
 	// WWW Page refresh function
-	server.on("/REFR=1", []() { // WWW page auto refresh ON
+	server.on("/REFR={0|1}", []() { // WWW page auto refresh ON/OFF
 #if A_REFRESH == 1
-		gwayConfig.refresh = 1;
+		gwayConfig.refresh = server.pathArgIndex(0);
 		writeGwayCfg(CONFIGFILE); // Save configuration to file
 #endif
-		server.sendHeader("Location", String("/"), true);
-		server.send(302, "text/plain", "");
-	});
-	server.on("/REFR=0", []() { // WWW page auto refresh OFF
-#if A_REFRESH == 1
-		gwayConfig.refresh = 0;
-		writeGwayCfg(CONFIGFILE); // Save configuration to file
-#endif
-		server.sendHeader("Location", String("/"), true);
-		server.send(302, "text/plain", "");
+		wwwRedirect();
 	});
 
 	// Switch off/on the HOP functions
-	server.on("/HOP=1", []() {
-		_hop = true;
-		server.sendHeader("Location", String("/"), true);
-		server.send(302, "text/plain", "");
-	});
-	server.on("/HOP=0", []() {
-		_hop = false;
-		ifreq = 0;
+	server.on("/HOP={0|1}", []() {
+		_hop = (bool)server.pathArgIndex(0);
+#ifdef CFG_sx1262_radio
+		if (!_hop)
+		{
+			ifreq = 0;
+		}
 		setFreq(freqs[ifreq].upFreq);
-		rxLoraModem();
-		server.sendHeader("Location", String("/"), true);
-		server.send(302, "text/plain", "");
+		if ((_cad) || (_hop))
+		{
+			cadScanner();
+		}
+		else
+		{
+			rxLoraModem();
+		}
+#else
+		if (!_hop)
+		{
+			ifreq = 0;
+			setFreq(freqs[ifreq].upFreq);
+			rxLoraModem();
+		}
+#endif
+		wwwRedirect();
 	});
 
 #if !defined ESP32_ARCH
-	// Change speed to 160 MHz
-	server.on("/SPEED=80", []() {
-		system_update_cpu_freq(80);
-		server.sendHeader("Location", String("/"), true);
-		server.send(302, "text/plain", "");
-	});
-	server.on("/SPEED=160", []() {
-		system_update_cpu_freq(160);
-		server.sendHeader("Location", String("/"), true);
-		server.send(302, "text/plain", "");
+	// Change speed to 80 or 160 MHz
+	server.on("/SPEED={80|160}", []() {
+		system_update_cpu_freq(server.pathArgInt(0));
+		wwwRedirect();
 	});
 #endif
 	// Display Documentation pages
@@ -1385,8 +2519,7 @@ void setupWWW()
 #if A_OTA == 1
 		updateOtaa();
 #endif
-		server.sendHeader("Location", String("/"), true);
-		server.send(302, "text/plain", "");
+		wwwRedirect();
 	});
 
 	// -----------
@@ -1406,130 +2539,157 @@ void setupWWW()
 // wifiConfig() displays the most important Wifi parameters gathered
 //
 // --------------------------------------------------------------------------------
-void wifiConfig()
+static void wifiConfig(wwwOut &o)
 {
 	if (gwayConfig.expert)
 	{
-		String response = "";
-		response += "<h2>WiFi Config</h2>";
-
-		response += "<table class=\"config_table\">";
-
-		response += "<tr><th class=\"thead\">Parameter</th><th class=\"thead\">Value</th></tr>";
-
-		response += "<tr><td class=\"cell\">WiFi host</td><td class=\"cell\">";
+		wStr(o, F("<h2>WiFi Config</h2>"
+				  "<table class=\"config_table\">"
+				  "<tr><th class=\"thead\">Parameter</th><th class=\"thead\">Value</th></tr>"
+				  "<tr><td class=\"cell\">WiFi host</td><td class=\"cell\">"));
 #if ESP32_ARCH == 1
-		response += WiFi.getHostname();
-		response += "</tr>";
+		wStr(o, WiFi.getHostname());
 #else
-		response += wifi_station_get_hostname();
-		response += "</tr>";
-#endif
-
-		response += "<tr><td class=\"cell\">WiFi SSID</td><td class=\"cell\">";
-		response += WiFi.SSID();
-		response += "</tr>";
-
-		response += "<tr><td class=\"cell\">IP Address</td><td class=\"cell\">";
-		printIP((IPAddress)WiFi.localIP(), '.', response);
-		response += "</tr>";
-		response += "<tr><td class=\"cell\">IP Gateway</td><td class=\"cell\">";
-		printIP((IPAddress)WiFi.gatewayIP(), '.', response);
-		response += "</tr>";
-		response += "<tr><td class=\"cell\">NTP Server</td><td class=\"cell\">";
-		response += NTP_TIMESERVER;
-		response += "</tr>";
-		response += "<tr><td class=\"cell\">LoRa Router</td><td class=\"cell\">";
-		response += _TTNSERVER;
-		response += "</tr>";
-		response += "<tr><td class=\"cell\">LoRa Router IP</td><td class=\"cell\">";
-		printIP((IPAddress)ttnServer, '.', response);
-		response += "</tr>";
+		wStr(o, wifi_station_get_hostname());
+#endif
+		wStr(o, F("</tr>"));
+
+		wStr(o, F("<tr><td class=\"cell\">WiFi SSID</td><td class=\"cell\">"));
+		wStr(o, WiFi.SSID().c_str());
+		wStr(o, F("</tr>"));
+
+		wStr(o, F("<tr><td class=\"cell\">IP Address</td><td class=\"cell\">"));
+		wIP(o, WiFi.localIP());
+		wStr(o, F("</tr>"));
+		wStr(o, F("<tr><td class=\"cell\">IP Gateway</td><td class=\"cell\">"));
+		wIP(o, WiFi.gatewayIP());
+		wStr(o, F("</tr>"));
+		wStr(o, F("<tr><td class=\"cell\">NTP Server</td><td class=\"cell\">" NTP_TIMESERVER "</tr>"
+				  "<tr><td class=\"cell\">LoRa Router</td><td class=\"cell\">" _TTNSERVER "</tr>"
+				  "<tr><td class=\"cell\">LoRa Router IP</td><td class=\"cell\">"));
+		wIP(o, ttnServer);
+		wStr(o, F("</tr>"));
 #ifdef _THINGSERVER
-		response += "<tr><td class=\"cell\">LoRa Router 2</td><td class=\"cell\">";
-		response += _THINGSERVER;
-		response += String() + ":" + _THINGPORT + "</tr>";
-		response += "<tr><td class=\"cell\">LoRa Router 2 IP</td><td class=\"cell\">";
-		printIP((IPAddress)thingServer, '.', response);
-		response += "</tr>";
+		wStr(o, F("<tr><td class=\"cell\">LoRa Router 2</td><td class=\"cell\">" _THINGSERVER ":"));
+		wNum(o, _THINGPORT);
+		wStr(o, F("</tr><tr><td class=\"cell\">LoRa Router 2 IP</td><td class=\"cell\">"));
+		wIP(o, thingServer);
+		wStr(o, F("</tr>"));
 #endif
-		response += "</table>";
-
-		server.sendContent(response);
+		wStr(o, F("</table>"));
 	} // gwayConfig.expert
 } // wifiConfig
 
+// --------------------------------------------------------------------------------
+// One "Parameter / Value" row with a numeric value
+// --------------------------------------------------------------------------------
+static void wValRow(wwwOut &o, const __FlashStringHelper *label, unsigned long v)
+{
+	wStr(o, F("<tr><td class=\"cell\">"));
+	wStr(o, label);
+	wStr(o, F("</td>"));
+	wCell(o, v);
+	wStr(o, F("</tr>"));
+}
+
 // --------------------------------------------------------------------------------
 // H2 systemStatus
 // systemStatus is additional and only available in the expert mode.
 // It provides a number of system specific data such as heap size etc.
 // --------------------------------------------------------------------------------
-void systemStatus()
+static void systemStatus(wwwOut &o)
 {
 	if (gwayConfig.expert)
 	{
-		String response = "";
-		response += "<h2>System Status</h2>";
-
-		response += "<table class=\"config_table\">";
-		response += "<tr>";
-		response += "<th class=\"thead\">Parameter</th>";
-		response += "<th class=\"thead\">Value</th>";
-		response += "<th colspan=\"2\" class=\"thead\">Set</th>";
-		response += "</tr>";
-
-		response += "<tr><td style=\"border: 1px solid black; width:120px;\">Gateway ID</td>";
-		response += "<td class=\"cell\">";
-		if (MAC_array[0] < 0x10)
-			response += '0';
-		response += String(MAC_array[0], HEX); // The MAC array is always returned in lowercase
-		if (MAC_array[1] < 0x10)
-			response += '0';
-		response += String(MAC_array[1], HEX);
-		if (MAC_array[2] < 0x10)
-			response += '0';
-		response += String(MAC_array[2], HEX);
-		response += "FFFF";
-		if (MAC_array[3] < 0x10)
-			response += '0';
-		response += String(MAC_array[3], HEX);
-		if (MAC_array[4] < 0x10)
-			response += '0';
-		response += String(MAC_array[4], HEX);
-		if (MAC_array[5] < 0x10)
-			response += '0';
-		response += String(MAC_array[5], HEX);
-		response += "</tr>";
-
-		response += "<tr><td class=\"cell\">Free heap</td><td class=\"cell\">";
-		response += ESP.getFreeHeap();
-		response += "</tr>";
+		wStr(o, F("<h2>System Status</h2>"
+				  "<table class=\"config_table\">"
+				  "<tr>"
+				  "<th class=\"thead\">Parameter</th>"
+				  "<th class=\"thead\">Value</th>"
+				  "<th colspan=\"2\" class=\"thead\">Set</th>"
+				  "</tr>"
+				  "<tr><td style=\"border: 1px solid black; width:120px;\">Gateway ID</td>"
+				  "<td class=\"cell\">"));
+		wHex2(o, MAC_array[0]); // The MAC array is always returned in lowercase
+		wHex2(o, MAC_array[1]);
+		wHex2(o, MAC_array[2]);
+		wStr(o, F("FFFF"));
+		wHex2(o, MAC_array[3]);
+		wHex2(o, MAC_array[4]);
+		wHex2(o, MAC_array[5]);
+		wStr(o, F("</tr>"));
+
+		wValRow(o, F("Free heap"), ESP.getFreeHeap());
 // XXX We Shoudl find an ESP32 alternative
 #if !defined ESP32_ARCH
-		response += "<tr><td class=\"cell\">ESP speed</td><td class=\"cell\">";
-		response += ESP.getCpuFreqMHz();
-		response += "<td style=\"border: 1px solid black; width:40px;\"><a href=\"SPEED=80\"><button>80</button></a></td>";
-		response += "<td style=\"border: 1px solid black; width:40px;\"><a href=\"SPEED=160\"><button>160</button></a></td>";
-		response += "</tr>";
-		response += "<tr><td class=\"cell\">ESP Chip ID</td><td class=\"cell\">";
-		response += ESP.getChipId();
-		response += "</tr>";
-#endif
-		response += "<tr><td class=\"cell\">OLED</td><td class=\"cell\">";
-		response += OLED;
-		response += "</tr>";
+		wStr(o, F("<tr><td class=\"cell\">ESP speed</td><td class=\"cell\">"));
+		wUns(o, ESP.getCpuFreqMHz());
+		wStr(o, F("<td style=\"border: 1px solid black; width:40px;\"><a href=\"SPEED=80\"><button>80</button></a></td>"
+				  "<td style=\"border: 1px solid black; width:40px;\"><a href=\"SPEED=160\"><button>160</button></a></td>"
+				  "</tr>"));
+		wValRow(o, F("ESP Chip ID"), ESP.getChipId());
+#endif
+#ifdef CFG_sx1262_radio
+		wValRow(o, F("SPI per RX (us)"), spiRx.us);
+		wValRow(o, F("SPI per RX (calls)"), spiRx.calls);
+		wValRow(o, F("BUSY per RX (us)"), spiRx.busy);
+		wValRow(o, F("BUSY per RX (waits)"), spiRx.waits);
+		wValRow(o, F("BUSY timeouts"), spiMark.timeouts);
+		{
+			uint32_t cmds, regs;
+			SX126xGetShadowStats(&cmds, &regs);
+			wValRow(o, F("SPI saved, commands"), cmds);
+			wValRow(o, F("SPI saved, registers"), regs);
+		}
+		wValRow(o, F("Radio loop gap, last second (us)"), radioLoop.win);
+		wValRow(o, F("Radio loop gap, max (us)"), radioLoop.max);
+		wValRow(o, F("Radio checks"), radioHealth.checks);
+		wValRow(o, F("Radio re-arms"), radioHealth.rearms);
+		wValRow(o, F("Radio missed IRQs"), radioHealth.irqs);
+		wValRow(o, F("Radio resets"), radioHealth.resets);
+		wValRow(o, F("Radio recovery (us)"), radioHealth.us);
+		wValRow(o, F("Sniff RX (us)"), sniff.rx);
+		wValRow(o, F("Sniff sleep (us)"), sniff.sleep);
+		wValRow(o, F("Radio current (uA, est.)"), sniff.ua);
+		{
+			TimerStats_t ts;
+			TimerGetStats(&ts);
+			wValRow(o, F("Radio timers running"), ts.active);
+			wValRow(o, F("Radio timer expiries"), ts.count);
+			wValRow(o, F("Radio timer latency, avg (us)"), ts.avg);
+			wValRow(o, F("Radio timer latency, max (us)"), ts.max);
+		}
+#endif
+		wValRow(o, F("OLED"), OLED);
+#if OLED >= 1
+		wValRow(o, F("OLED frame bytes"), display.getFrameBytes());
+		wValRow(o, F("OLED frame (us)"), display.getFrameMicros());
+#endif
 
 #if STATISTICS >= 1
-		response += "<tr><td class=\"cell\">WiFi Setups</td><td class=\"cell\">";
-		response += gwayConfig.wifis;
-		response += "</tr>";
-		response += "<tr><td class=\"cell\">WWW Views</td><td class=\"cell\">";
-		response += gwayConfig.views;
-		response += "</tr>";
+		wValRow(o, F("WiFi Setups"), gwayConfig.wifis);
+		wValRow(o, F("WWW Views"), gwayConfig.views);
+#endif
+		// Numbers of the previous page, this one is not finished yet
+		wValRow(o, F("Page render (us)"), wwwLast.us);
+		wValRow(o, F("Page size (bytes)"), wwwLast.bytes);
+		wValRow(o, F("Page chunks"), wwwLast.chunks);
+		wValRow(o, F("Page heap used"), wwwLast.heapPre - wwwLast.heapLow);
+		wValRow(o, F("Live feed clients"), sseCount);
+		wValRow(o, F("Live feed drops"), sseDrops);
+#if ESP32_ARCH == 1
+		const HTTPStats &hs = server.stats();
+		wValRow(o, F("HTTP connections"), server.activeClients());
+		wValRow(o, F("HTTP requests served"), hs.served);
+		wValRow(o, F("HTTP rejected (busy)"), hs.rejected);
+		wValRow(o, F("HTTP timeouts / errors"), hs.timeouts + hs.errors);
+		wValRow(o, F("HTTP longest poll (us)"), hs.maxUs);
+		wValRow(o, F("HTTP parse+route (us)"), hs.parseUs);
+		wValRow(o, F("HTTP most queued (bytes)"), hs.outMax);
+		wValRow(o, F("HTTP waits for slow clients"), hs.waits);
 #endif
 
-		response += "</table>";
-		server.sendContent(response);
+		wStr(o, F("</table>"));
 	} // gwayConfig.expert
 } // systemStatus
 
@@ -1538,96 +2698,71 @@ void systemStatus()
 // Display interrupt data, but only for debug >= 2
 //
 // --------------------------------------------------------------------------------
-void interruptData()
+static void interruptData(wwwOut &o)
 {
 	if (gwayConfig.expert)
 	{
 		uint8_t flags = readRegister(REG_IRQ_FLAGS);
 		uint8_t mask = readRegister(REG_IRQ_FLAGS_MASK);
-		String response = "";
-
-		response += "<h2>System State and Interrupt</h2>";
 
-		response += "<table class=\"config_table\">";
-		response += "<tr>";
-		response += "<th class=\"thead\">Parameter</th>";
-		response += "<th class=\"thead\">Value</th>";
-		response += "<th colspan=\"2\"  class=\"thead\">Set</th>";
-		response += "</tr>";
-
-		response += "<tr><td class=\"cell\">_state</td>";
-		response += "<td class=\"cell\">";
+		wStr(o, F("<h2>System State and Interrupt</h2>"
+				  "<table class=\"config_table\">"
+				  "<tr>"
+				  "<th class=\"thead\">Parameter</th>"
+				  "<th class=\"thead\">Value</th>"
+				  "<th colspan=\"2\"  class=\"thead\">Set</th>"
+				  "</tr>"
+				  "<tr><td class=\"cell\">_state</td>"
+				  "<td class=\"cell\">"));
 		switch (_state)
 		{ // See loraModem.h
 		case S_INIT:
-			response += "INIT";
+			wStr(o, F("INIT"));
 			break;
 		case S_SCAN:
-			response += "SCAN";
+			wStr(o, F("SCAN"));
 			break;
 		case S_CAD:
-			response += "CAD";
+			wStr(o, F("CAD"));
 			break;
 		case S_RX:
-			response += "RX";
+			wStr(o, F("RX"));
 			break;
 		case S_TX:
-			response += "TX";
+			wStr(o, F("TX"));
 			break;
 		default:
-			response += "unknown";
+			wStr(o, F("unknown"));
 			break;
 		}
-		response += "</td></tr>";
-
-		response += "<tr><td class=\"cell\">_STRICT_1CH</td>";
-		response += "<td class=\"cell\">";
-		response += String() + _STRICT_1CH;
-		response += "</td></tr>";
-
-		response += "<tr><td class=\"cell\">flags (8 bits)</td>";
-		response += "<td class=\"cell\">0x";
-		if (flags < 16)
-			response += "0";
-		response += String(flags, HEX);
-		response += "</td></tr>";
-
-		response += "<tr><td class=\"cell\">mask (8 bits)</td>";
-		response += "<td class=\"cell\">0x";
-		if (mask < 16)
-			response += "0";
-		response += String(mask, HEX);
-		response += "</td></tr>";
-
-		response += "<tr><td class=\"cell\">Re-entrant cntr</td>";
-		response += "<td class=\"cell\">";
-		response += String() + gwayConfig.reents;
-		response += "</td></tr>";
-
-		response += "<tr><td class=\"cell\">ntp call cntr</td>";
-		response += "<td class=\"cell\">";
-		response += String() + gwayConfig.ntps;
-		response += "</td></tr>";
-
-		response += "<tr><td class=\"cell\">ntpErr cntr</td>";
-		response += "<td class=\"cell\">";
-		response += String() + gwayConfig.ntpErr;
-		response += "</td>";
-		response += "<td colspan=\"2\" style=\"border: 1px solid black;\">";
-		stringTime(gwayConfig.ntpErrTime, response);
-		response += "</td>";
-		response += "</tr>";
-
-		response += "<tr><td class=\"cell\">Time Correction (uSec)</td><td class=\"cell\">";
-		response += txDelay;
-		response += "</td>";
-		response += "<td class=\"cell\"><a href=\"DELAY=-1\"><button>-</button></a></td>";
-		response += "<td class=\"cell\"><a href=\"DELAY=1\"><button>+</button></a></td>";
-		response += "</tr>";
-
-		response += "</table>";
-
-		server.sendContent(response);
+		wStr(o, F("</td></tr>"));
+
+		wValRow(o, F("_STRICT_1CH"), _STRICT_1CH);
+
+		wStr(o, F("<tr><td class=\"cell\">flags (8 bits)</td><td class=\"cell\">0x"));
+		wHex2(o, flags);
+		wStr(o, F("</td></tr>"));
+
+		wStr(o, F("<tr><td class=\"cell\">mask (8 bits)</td><td class=\"cell\">0x"));
+		wHex2(o, mask);
+		wStr(o, F("</td></tr>"));
+
+		wValRow(o, F("Re-entrant cntr"), gwayConfig.reents);
+		wValRow(o, F("ntp call cntr"), gwayConfig.ntps);
+
+		wStr(o, F("<tr><td class=\"cell\">ntpErr cntr</td>"));
+		wCell(o, gwayConfig.ntpErr);
+		wStr(o, F("<td colspan=\"2\" style=\"border: 1px solid black;\">"));
+		wTime(o, gwayConfig.ntpErrTime);
+		wStr(o, F("</td></tr>"));
+
+		wStr(o, F("<tr><td class=\"cell\">Time Correction (uSec)</td><td class=\"cell\">"));
+		wNum(o, txDelay);
+		wStr(o, F("</td>"
+				  "<td class=\"cell\"><a href=\"DELAY=-1\"><button>-</button></a></td>"
+				  "<td class=\"cell\"><a href=\"DELAY=1\"><button>+</button></a></td>"
+				  "</tr>"
+				  "</table>"));
 	} // if gwayConfig.expert
 } // interruptData
 
@@ -1637,12 +2772,13 @@ void interruptData()
 // Thi function displays the last messages without header on the webpage and then
 // closes the webpage.
 // --------------------------------------------------------------------------------
-void websiteFooter()
+static void websiteFooter(wwwOut &o)
 {
-	// Close the client connection to server
-	server.sendContent(String() + "<br><br /><p style='font-size:10px'>Click <a href=\"/HELP\">here</a> to explain Help and REST options</p><br>");
-	server.sendContent(String() + "</BODY></HTML>");
+	wStr(o, F("<br><br /><p style='font-size:10px'>Click <a href=\"/HELP\">here</a> to explain Help and REST options</p><br>"
+			  "</BODY></HTML>"));
+	wFlush(o);
 
+	// Close the client connection to server
 	server.sendContent("");
 	yield();
 }
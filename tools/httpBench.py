@@ -0,0 +1,156 @@
+# Load test of the gateway web server
+# Runs concurrent HTTP clients against the gateway and reports requests per
+# second and response times. Optional slow clients request a page and then
+# read it one small piece per second, like a browser on a bad link. Once a
+# second /api/stats is read to follow the radio loop gap ("loop" object,
+# the time between two Radio.IrqProcess() calls), first without load and
+# then under load.
+#
+# Run by hand: python tools/httpBench.py <gateway ip> [options]
+#	-c N	concurrent clients (default 4)
+#	-s N	slow clients (default 1)
+#	-t S	seconds of load (default 20)
+#	-p PATH	path the clients request (default /api/history)
+#	-P PATH	path the slow clients request (default /HTML)
+#	-i S	seconds without load first (default 5)
+
+import argparse
+import json
+import socket
+import threading
+import time
+
+def request(host, port, path, timeout=10.0):
+	s = socket.create_connection((host, port), timeout=timeout)
+	try:
+		s.sendall(("GET %s HTTP/1.1\r\nHost: %s\r\nConnection: close\r\n\r\n" % (path, host)).encode())
+		data = b""
+		while True:
+			b = s.recv(4096)
+			if not b:
+				break
+			data += b
+	finally:
+		s.close()
+	status = int(data.split(b" ", 2)[1]) if data.startswith(b"HTTP/") else 0
+	return status, data
+
+def body(data):
+	head, _, rest = data.partition(b"\r\n\r\n")
+	if b"chunked" not in head.lower():
+		return rest
+	out = b""
+	while rest:
+		size, _, rest = rest.partition(b"\r\n")
+		n = int(size, 16)
+		if n == 0:
+			break
+		out += rest[:n]
+		rest = rest[n + 2:]
+	return out
+
+class Bench:
+	def __init__(self, args):
+		self.args = args
+		self.lock = threading.Lock()
+		self.times = []
+		self.errors = 0
+		self.busy = 0 # 503, all connections of the gateway in use
+		self.slowBytes = 0
+		self.loop = [] # (phase, win, avg)
+		self.phase = "idle"
+		self.stop = False
+
+	def client(self):
+		while not self.stop:
+			t = time.time()
+			try:
+				status, _ = request(self.args.host, self.args.port, self.args.path)
+			except (OSError, ValueError, IndexError):
+				status = 0
+			with self.lock:
+				if status == 200:
+					self.times.append(time.time() - t)
+				elif status == 503:
+					self.busy += 1
+				else:
+					self.errors += 1
+
+	def slow(self):
+		while not self.stop:
+			try:
+				s = socket.socket()
+				s.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 1024)
+				s.settimeout(30)
+				s.connect((self.args.host, self.args.port))
+				s.sendall(("GET %s HTTP/1.1\r\nHost: %s\r\n\r\n" % (self.args.slowpath, self.args.host)).encode())
+				while not self.stop:
+					b = s.recv(64)
+					if not b:
+						break
+					with self.lock:
+						self.slowBytes += len(b)
+					time.sleep(1.0)
+				s.close()
+			except OSError:
+				time.sleep(1.0)
+
+	def sampler(self):
+		while not self.stop:
+			try:
+				status, data = request(self.args.host, self.args.port, "/api/stats")
+				loop = json.loads(body(data)).get("loop")
+				if loop:
+					with self.lock:
+						self.loop.append((self.phase, loop["win"], loop["avg"]))
+			except (OSError, ValueError, IndexError):
+				pass
+			time.sleep(1.0)
+
+	def run(self):
+		a = self.args
+		sampler = threading.Thread(target=self.sampler, daemon=True)
+		sampler.start()
+		time.sleep(a.idle)
+
+		self.phase = "load"
+		threads = [threading.Thread(target=self.client, daemon=True) for _ in range(a.clients)]
+		threads += [threading.Thread(target=self.slow, daemon=True) for _ in range(a.slow)]
+		start = time.time()
+		for t in threads:
+			t.start()
+		time.sleep(a.time)
+		self.stop = True
+		elapsed = time.time() - start
+		for t in threads:
+			t.join(35)
+
+		t = sorted(self.times)
+		print("clients %d, slow clients %d, %.1f s" % (a.clients, a.slow, elapsed))
+		if t:
+			print("requests %d ok, %d busy (503), %d failed, %.1f req/s" %
+				  (len(t), self.busy, self.errors, len(t) / elapsed))
+			print("response ms: p50 %.0f, p95 %.0f, max %.0f" %
+				  (1000 * t[len(t) // 2], 1000 * t[int(len(t) * 0.95)], 1000 * t[-1]))
+		else:
+			print("no request succeeded, %d busy (503), %d failed" % (self.busy, self.errors))
+		print("slow clients read %d bytes" % self.slowBytes)
+		for phase in ("idle", "load"):
+			win = [w for p, w, _ in self.loop if p == phase]
+			avg = [v for p, _, v in self.loop if p == phase]
+			if win:
+				print("radio loop gap %s: longest %d us, median second %d us, average %d us" %
+					  (phase, max(win), sorted(win)[len(win) // 2], sum(avg) // len(avg)))
+			else:
+				print("radio loop gap %s: no samples (no loop in /api/stats)" % phase)
+
+parser = argparse.ArgumentParser(description="Load test of the gateway web server")
+parser.add_argument("host")
+parser.add_argument("--port", type=int, default=80)
+parser.add_argument("-c", dest="clients", type=int, default=4)
+parser.add_argument("-s", dest="slow", type=int, default=1)
+parser.add_argument("-t", dest="time", type=float, default=20)
+parser.add_argument("-i", dest="idle", type=float, default=5)
+parser.add_argument("-p", dest="path", default="/api/history")
+parser.add_argument("-P", dest="slowpath", default="/HTML")
+Bench(parser.parse_args()).run()
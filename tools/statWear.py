@@ -0,0 +1,109 @@
+# Flash wear estimate of the statistics journal, see loraFiles.cpp
+# Takes struct stat_c and struct stat_t from src/loraModem.h, keeps the
+# fields that the #if lines select with the flags of src/defines.h and lays
+# them out as the ESP32 compiler does (4-byte long, natural alignment).
+# With STATJRNLMAX from src/loraFiles.h it prints the bytes written and the
+# SPIFFS block erases per day for a given uplink rate.
+#
+# Run by hand: python tools/statWear.py [uplinks per hour] [changed counters]
+
+import os
+import re
+import sys
+
+root = os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+
+def define(name, file):
+	with open(os.path.join(root, "src", file)) as f:
+		m = re.search(r"^#define\s+%s\s+(\d+)" % name, f.read(), re.M)
+	return int(m.group(1)) if m else 0
+
+# Value of an #if expression, names that are not defined count as 0
+def cond(expr):
+	expr = re.sub(r"defined\s*\(?\s*(\w+)\s*\)?",
+		lambda m: "1" if re.search(r"^#define\s+%s\b" % m.group(1), defines, re.M) else "0", expr)
+	expr = re.sub(r"[A-Za-z_]\w*", lambda m: str(define(m.group(0), "defines.h")), expr)
+	expr = expr.replace("&&", " and ").replace("||", " or ")
+	expr = re.sub(r"!(?!=)", " not ", expr)
+	return bool(eval(expr))
+
+# Type sizes of the ESP32 (ILP32), alignment is the size
+TYPES = {"uint8_t": 1, "int8_t": 1, "char": 1, "uint16_t": 2, "int16_t": 2,
+	"uint32_t": 4, "int32_t": 4, "int": 4, "long": 4, "unsigned long": 4, "float": 4}
+
+# sizeof(struct name) as declared in src/loraModem.h
+def sizeof(name):
+	with open(os.path.join(root, "src", "loraModem.h")) as f:
+		text = f.read()
+	text = re.sub(r"/\*.*?\*/", "", text, flags=re.S)
+	body = re.search(r"^struct\s+%s\s*\{(.*?)^\};" % name, text, re.M | re.S).group(1)
+	stack = [] # (this branch is on, a branch was taken) per nesting level
+	size = 0
+	align = 1
+	for line in body.splitlines():
+		line = line.split("//")[0].strip()
+		on = all(s[0] for s in stack)
+		m = re.match(r"#\s*(if|ifdef|ifndef|elif|else|endif)\b(.*)", line)
+		if m:
+			d, e = m.group(1), m.group(2)
+			if d == "if":
+				c = cond(e)
+				stack.append([c, c])
+			elif d == "ifdef" or d == "ifndef":
+				c = cond("defined(%s)" % e.strip()) == (d == "ifdef")
+				stack.append([c, c])
+			elif d == "elif":
+				c = (not stack[-1][1]) and cond(e)
+				stack[-1] = [c, stack[-1][1] or c]
+			elif d == "else":
+				stack[-1] = [not stack[-1][1], True]
+			else:
+				stack.pop()
+			continue
+		if not on or not line:
+			continue
+		m = re.match(r"((?:unsigned\s+|signed\s+)?\w+)\s+(.*);$", line)
+		t = re.sub(r"^signed\s+", "", re.sub(r"\s+", " ", m.group(1)))
+		for v in m.group(2).split(","):
+			n = 1
+			for a in re.findall(r"\[(\w+)\]", v):
+				n *= int(a) if a.isdigit() else define(a, "defines.h")
+			size = (size + TYPES[t] - 1) // TYPES[t] * TYPES[t] + n * TYPES[t]
+			align = max(align, TYPES[t])
+	return (size + align - 1) // align * align
+
+with open(os.path.join(root, "src", "defines.h")) as f:
+	defines = f.read()
+checkpoint = define("_STAT_CHECKPOINT", "defines.h")
+maxStat = define("MAX_STAT", "defines.h")
+jrnlMax = define("STATJRNLMAX", "loraFiles.h")
+
+uplinks = float(sys.argv[1]) if len(sys.argv) > 1 else 60.0 # per hour
+changed = int(sys.argv[2]) if len(sys.argv) > 2 else 3 # msg_ok, msg_ttl, msg_down
+
+BLOCK = 4096 # SPIFFS erase block on the ESP32
+HDR = 8 # struct statHdr
+STAT_C = sizeof("stat_c")
+STAT_T = sizeof("stat_t")
+
+if checkpoint == 0:
+	print("statWear: _STAT_CHECKPOINT is 0, nothing is written")
+	sys.exit(0)
+
+perDay = 86400 // checkpoint
+perCheckpoint = uplinks * checkpoint / 3600.0
+busy = perCheckpoint > 0
+
+# A checkpoint writes one counter record and one record per new statr entry
+cntRec = (2 + 5 * changed + 1) if busy else 0
+histRec = (1 + STAT_T + 1) * min(perCheckpoint, maxStat)
+jrnlDay = perDay * (cntRec + histRec)
+compactions = jrnlDay / (jrnlMax - HDR)
+snap = HDR + 4 + STAT_C + maxStat * STAT_T + 1
+total = jrnlDay + compactions * (snap + HDR)
+
+print("checkpoint %ds, %d per day, %.1f uplinks per checkpoint" % (checkpoint, perDay, perCheckpoint))
+print("stat_c %d bytes, stat_t %d bytes, snapshot %d bytes, STATJRNLMAX %d" % (STAT_C, STAT_T, snap, jrnlMax))
+print("journal %.0f bytes/day, %.1f compactions/day" % (jrnlDay, compactions))
+print("total %.0f bytes/day, ~%.1f block erases/day" % (total, total / BLOCK))
+print("writeConfig() every checkpoint instead: %d block erases/day" % perDay)
@@ -0,0 +1,173 @@
+// Host driver of the SX126x timer service, see
+// lib/SX126x-Arduino/src/boards/mcu/espressif/timer.cpp
+// Built with SX126X_TIMER_HOST the timer service runs on a simulated clock
+// that TimerHostAdvance() moves forward. This program starts, stops and
+// restarts timers from the main program and from callbacks and checks that
+// every callback runs at its deadline and in deadline order.
+//
+// Build and run by hand from the repository root:
+//	g++ -DSX126X_TIMER_HOST -Ilib/SX126x-Arduino/src -o timerHost tools/timerHost.cpp lib/SX126x-Arduino/src/boards/mcu/espressif/timer.cpp
+//	./timerHost
+// Prints one line per check and exits with 1 when one of them failed.
+
+#include <stdio.h>
+#include "boards/mcu/timer.h"
+
+#define TIMERS 100
+
+static TimerEvent_t timers[TIMERS];
+static TimerEvent_t periodic;
+static TimerEvent_t restart;
+static TimerEvent_t early;
+static TimerEvent_t late;
+
+static int fired[TIMERS + 1];
+static uint64_t firedAt[TIMERS + 1];
+static int nFired = 0;
+static int periodicCount = 0;
+static int restartCount = 0;
+static int failed = 0;
+
+static void check(const char *what, bool ok)
+{
+	printf("%s %s\n", ok ? "ok  " : "FAIL", what);
+	if (!ok)
+	{
+		failed++;
+	}
+}
+
+static void fire(int n)
+{
+	if (nFired < TIMERS + 1)
+	{
+		fired[nFired] = n;
+		firedAt[nFired] = TimerGetCurrentTimeUs();
+		nFired++;
+	}
+}
+
+static void timerCb(void)
+{
+	fire(0);
+}
+
+static void periodicCb(void)
+{
+	if (++periodicCount == 3)
+	{
+		TimerStop(&periodic);
+	}
+}
+
+static void restartCb(void)
+{
+	if (++restartCount < 5)
+	{
+		TimerStart(&restart);
+	}
+}
+
+static void earlyCb(void)
+{
+	// Stop the timer that is next in the list from a callback
+	fire(1);
+	TimerStop(&late);
+}
+
+static void lateCb(void)
+{
+	fire(2);
+}
+
+int main()
+{
+	TimerStats_t st;
+	uint64_t t0;
+
+	// Many timers started in reverse deadline order
+	t0 = TimerGetCurrentTimeUs();
+	for (int i = 0; i < TIMERS; i++)
+	{
+		timers[i].oneShot = true;
+		TimerInit(&timers[i], timerCb);
+		TimerSetValueUs(&timers[i], 10000 + (TIMERS - 1 - i) * 10);
+		TimerStart(&timers[i]);
+	}
+	TimerGetStats(&st);
+	check("100 timers active", st.active == TIMERS);
+	TimerHostAdvance(5000);
+	check("nothing fires before the first deadline", nFired == 0);
+	TimerHostAdvance(10000);
+	check("all timers fired", nFired == TIMERS);
+	bool ordered = true;
+	for (int i = 0; i < nFired; i++)
+	{
+		if (firedAt[i] != t0 + 10000 + i * 10)
+		{
+			ordered = false;
+		}
+	}
+	check("each timer fired at its deadline, in order", ordered);
+	TimerGetStats(&st);
+	check("no timer late, none left", (st.active == 0) && (st.max == 0) && (st.count == TIMERS));
+
+	// Stop the head of the list, the alarm must move on
+	nFired = 0;
+	TimerSetValueUs(&timers[0], 100);
+	TimerSetValueUs(&timers[1], 200);
+	TimerStart(&timers[0]);
+	TimerStart(&timers[1]);
+	TimerStop(&timers[0]);
+	TimerHostAdvance(1000);
+	check("stopped head does not fire, next one does", nFired == 1);
+
+	// Periodic timer that stops itself from its callback
+	periodic.oneShot = false;
+	TimerInit(&periodic, periodicCb);
+	TimerSetValue(&periodic, 10);
+	TimerStart(&periodic);
+	TimerHostAdvance(100000);
+	check("periodic timer stops itself after 3 ticks", periodicCount == 3);
+
+	// One shot timer that starts itself again from its callback
+	restart.oneShot = true;
+	TimerInit(&restart, restartCb);
+	TimerSetValueUs(&restart, 7);
+	TimerStart(&restart);
+	TimerHostAdvance(1000);
+	check("one shot timer restarts itself 4 times", restartCount == 5);
+
+	// A callback stops the timer due right after it
+	nFired = 0;
+	early.oneShot = true;
+	late.oneShot = true;
+	TimerInit(&early, earlyCb);
+	TimerInit(&late, lateCb);
+	TimerSetValueUs(&early, 100);
+	TimerSetValueUs(&late, 100);
+	TimerStart(&early);
+	TimerStart(&late);
+	TimerHostAdvance(1000);
+	check("timer stopped by an earlier callback does not fire", (nFired == 1) && (fired[0] == 1));
+
+	// A restart moves the deadline out
+	nFired = 0;
+	TimerSetValue(&timers[2], 5);
+	TimerStart(&timers[2]);
+	TimerHostAdvance(4000);
+	TimerReset(&timers[2]);
+	TimerHostAdvance(4000);
+	check("restarted timer has not fired yet", nFired == 0);
+	TimerHostAdvance(1000);
+	check("restarted timer fired 5 ms after the restart", nFired == 1);
+
+	TimerGetStats(&st);
+	printf("count=%u max=%u avg=%u active=%u now=%u ms\n",
+		   st.count, st.max, st.avg, st.active, TimerGetCurrentTime());
+	TimerResetStats();
+	TimerGetStats(&st);
+	check("statistics cleared", st.count == 0);
+
+	return (failed ? 1 : 0);
+}
@@ -0,0 +1,36 @@
+# PlatformIO pre build script
+# Compresses www/index.html with gzip and writes it as a byte array to
+# src/wwwIndex.h, so the single page web interface is stored in flash
+# already compressed. The ETag is the CRC32 of the compressed data, so
+# browsers only download the page again after it was changed.
+#
+# Can also be run by hand: python tools/wwwGzip.py
+
+import gzip
+import os
+import zlib
+
+try:
+	Import("env")
+	root = env.subst("$PROJECT_DIR")
+except NameError:
+	root = os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+
+src = os.path.join(root, "www", "index.html")
+dst = os.path.join(root, "src", "wwwIndex.h")
+
+if not os.path.exists(dst) or os.path.getmtime(src) > os.path.getmtime(dst):
+	with open(src, "rb") as f:
+		data = gzip.compress(f.read(), 9, mtime=0)
+	etag = "%08x" % (zlib.crc32(data) & 0xffffffff)
+	with open(dst, "w") as f:
+		f.write("// Generated by tools/wwwGzip.py from www/index.html, do not edit\n")
+		f.write("#ifndef WWWINDEX_H\n#define WWWINDEX_H\n\n")
+		f.write("#define WWW_INDEX_ETAG \"\\\"%s\\\"\"\n\n" % etag)
+		f.write("static const uint8_t wwwIndexGz[%d] PROGMEM = {" % len(data))
+		for i, b in enumerate(data):
+			if i % 16 == 0:
+				f.write("\n\t")
+			f.write("0x%02x," % b)
+		f.write("\n};\n\n#endif // WWWINDEX_H\n")
+	print("wwwGzip: %s %d bytes, ETag %s" % (dst, len(data), etag))